@@ -0,0 +1,352 @@
+#include "BenchmarkTools.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <numeric>
+
+#if JUCE_LINUX
+ #include <fstream>
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/resource.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+#if JUCE_LINUX && defined (__GLIBC__)
+ #define SOFAR_BENCHMARKS_COUNT_MALLOC 1
+#else
+ #define SOFAR_BENCHMARKS_COUNT_MALLOC 0
+#endif
+
+//==============================================================================
+namespace
+{
+    // Plain zero-initialised thread_local: reading it never allocates, which
+    // matters inside malloc itself
+    thread_local int countingDepth = 0;
+
+    std::atomic<juce::int64> allocationCount { 0 };
+    std::atomic<juce::int64> allocationBytes { 0 };
+
+    inline void noteAllocation (size_t size) noexcept
+    {
+        if (countingDepth > 0)
+        {
+            allocationCount.fetch_add (1, std::memory_order_relaxed);
+            allocationBytes.fetch_add ((juce::int64) size, std::memory_order_relaxed);
+        }
+    }
+}
+
+#if SOFAR_BENCHMARKS_COUNT_MALLOC
+// glibc's own entry points; defining malloc here interposes it for the whole
+// process, including libstdc++'s operator new and juce::HeapBlock
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+
+    void* malloc (size_t size)                  { noteAllocation (size); return __libc_malloc (size); }
+    void* calloc (size_t count, size_t size)    { noteAllocation (count * size); return __libc_calloc (count, size); }
+    void* realloc (void* block, size_t size)    { noteAllocation (size); return __libc_realloc (block, size); }
+}
+#else
+void* operator new (std::size_t size)
+{
+    noteAllocation (size);
+
+    if (auto* block = std::malloc (size > 0 ? size : 1))
+        return block;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                                 { return operator new (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept   { noteAllocation (size); return std::malloc (size > 0 ? size : 1); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { noteAllocation (size); return std::malloc (size > 0 ? size : 1); }
+
+void operator delete (void* block) noexcept                             { std::free (block); }
+void operator delete[] (void* block) noexcept                           { std::free (block); }
+void operator delete (void* block, std::size_t) noexcept                { std::free (block); }
+void operator delete[] (void* block, std::size_t) noexcept              { std::free (block); }
+void operator delete (void* block, const std::nothrow_t&) noexcept      { std::free (block); }
+void operator delete[] (void* block, const std::nothrow_t&) noexcept    { std::free (block); }
+#endif
+
+AllocationCounter::ScopedCount::ScopedCount() noexcept   { ++countingDepth; }
+AllocationCounter::ScopedCount::~ScopedCount() noexcept  { --countingDepth; }
+
+juce::int64 AllocationCounter::getCount() noexcept  { return allocationCount.load(); }
+juce::int64 AllocationCounter::getBytes() noexcept  { return allocationBytes.load(); }
+bool AllocationCounter::countsMalloc() noexcept     { return SOFAR_BENCHMARKS_COUNT_MALLOC != 0; }
+
+//==============================================================================
+TimingHistogram::TimingHistogram (size_t capacity)
+{
+    samples.reserve (capacity);
+    sorted.reserve (capacity);
+}
+
+void TimingHistogram::add (double micros) noexcept
+{
+    // Never grows: a full histogram drops the sample rather than allocate mid-run
+    if (samples.size() < samples.capacity())
+        samples.push_back (micros);
+}
+
+double TimingHistogram::getPercentile (double fraction) const
+{
+    if (samples.empty())
+        return 0.0;
+
+    sorted.assign (samples.begin(), samples.end());
+    const auto index = juce::jlimit ((size_t) 0, sorted.size() - 1, (size_t) (fraction * (double) sorted.size()));
+    std::nth_element (sorted.begin(), sorted.begin() + (std::ptrdiff_t) index, sorted.end());
+    return sorted[index];
+}
+
+double TimingHistogram::getMax() const
+{
+    return samples.empty() ? 0.0 : *std::max_element (samples.begin(), samples.end());
+}
+
+double TimingHistogram::getMean() const
+{
+    return samples.empty() ? 0.0 : std::accumulate (samples.begin(), samples.end(), 0.0) / (double) samples.size();
+}
+
+juce::String TimingHistogram::describe() const
+{
+    return "p50 " + juce::String (getPercentile (0.5), 1)
+         + "  p99 " + juce::String (getPercentile (0.99), 1)
+         + "  p99.9 " + juce::String (getPercentile (0.999), 1)
+         + "  max " + juce::String (getMax(), 1) + " us";
+}
+
+//==============================================================================
+#if JUCE_LINUX
+namespace
+{
+    int openPerfCounter (juce::uint32 type, juce::uint64 config) noexcept
+    {
+        perf_event_attr attributes {};
+        attributes.size = sizeof (attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        return (int) syscall (SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+}
+#endif
+
+PerfCounters::PerfCounters()
+{
+   #if JUCE_LINUX
+    descriptors[0] = openPerfCounter (PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    descriptors[1] = openPerfCounter (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+    descriptors[2] = openPerfCounter (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    descriptors[3] = openPerfCounter (PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                                                          | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+    available = std::all_of (std::begin (descriptors), std::end (descriptors), [] (int fd) { return fd >= 0; });
+   #endif
+}
+
+PerfCounters::~PerfCounters()
+{
+   #if JUCE_LINUX
+    for (auto fd : descriptors)
+        if (fd >= 0)
+            close (fd);
+   #endif
+}
+
+void PerfCounters::start() noexcept
+{
+   #if JUCE_LINUX
+    if (! available)
+        return;
+
+    for (auto fd : descriptors)
+    {
+        ioctl (fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl (fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+   #endif
+}
+
+PerfCounters::Reading PerfCounters::stop() noexcept
+{
+    Reading reading;
+
+   #if JUCE_LINUX
+    if (! available)
+        return reading;
+
+    juce::int64 values[numCounters] = {};
+
+    for (int i = 0; i < numCounters; ++i)
+    {
+        ioctl (descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+
+        if (read (descriptors[i], &values[i], sizeof (values[i])) != (ssize_t) sizeof (values[i]))
+            values[i] = 0;
+    }
+
+    reading.instructions    = values[0];
+    reading.cacheReferences = values[1];
+    reading.cacheMisses     = values[2];
+    reading.l1dReadMisses   = values[3];
+   #endif
+
+    return reading;
+}
+
+//==============================================================================
+#if JUCE_LINUX
+namespace
+{
+    juce::int64 readProcStatus (const char* field)
+    {
+        std::ifstream status ("/proc/self/status");
+        std::string line;
+        const std::string prefix (field);
+
+        while (std::getline (status, line))
+            if (line.compare (0, prefix.size(), prefix) == 0)
+                return std::atoll (line.c_str() + prefix.size());
+
+        return 0;
+    }
+}
+#endif
+
+juce::int64 ProcessStats::getResidentBytes()
+{
+   #if JUCE_LINUX
+    return readProcStatus ("VmRSS:") * 1024;
+   #elif JUCE_MAC
+    mach_task_basic_info info {};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info (mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS)
+        return (juce::int64) info.resident_size;
+
+    return 0;
+   #else
+    return 0;
+   #endif
+}
+
+int ProcessStats::getThreadCount()
+{
+   #if JUCE_LINUX
+    return (int) readProcStatus ("Threads:");
+   #elif JUCE_MAC
+    thread_act_array_t threads = nullptr;
+    mach_msg_type_number_t count = 0;
+
+    if (task_threads (mach_task_self(), &threads, &count) != KERN_SUCCESS)
+        return 0;
+
+    for (mach_msg_type_number_t i = 0; i < count; ++i)
+        mach_port_deallocate (mach_task_self(), threads[i]);
+
+    vm_deallocate (mach_task_self(), (vm_address_t) threads, count * sizeof (thread_act_t));
+    return (int) count;
+   #else
+    return 0;
+   #endif
+}
+
+juce::int64 ProcessStats::getVoluntarySwitches()
+{
+   #if JUCE_LINUX
+    rusage usage {};
+
+    if (getrusage (RUSAGE_THREAD, &usage) == 0)
+        return (juce::int64) usage.ru_nvcsw;
+   #endif
+
+    return 0;
+}
+
+//==============================================================================
+double BenchmarkHelpers::ticksToMicros (juce::int64 ticks) noexcept
+{
+    return (double) ticks * 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+}
+
+int BenchmarkHelpers::getIntOption (const juce::ArgumentList& args, juce::StringRef option, int defaultValue)
+{
+    const auto value = args.getValueForOption (option);
+    return value.isNotEmpty() ? value.getIntValue() : defaultValue;
+}
+
+double BenchmarkHelpers::getDoubleOption (const juce::ArgumentList& args, juce::StringRef option, double defaultValue)
+{
+    const auto value = args.getValueForOption (option);
+    return value.isNotEmpty() ? value.getDoubleValue() : defaultValue;
+}
+
+void BenchmarkHelpers::prepareLikeHost (juce::AudioProcessor& processor, const juce::AudioProcessor::BusesLayout& layout,
+                                        double sampleRate, int blockSize)
+{
+    if (! processor.setBusesLayout (layout))
+        juce::ConsoleApplication::fail ("Bus layout refused: " + layout.getMainInputChannelSet().getDescription()
+                                        + " -> " + layout.getMainOutputChannelSet().getDescription());
+
+    processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    processor.setNonRealtime (false);
+    processor.prepareToPlay (sampleRate, blockSize);
+}
+
+juce::RangedAudioParameter& BenchmarkHelpers::getParameter (juce::AudioProcessor& processor, const juce::String& parameterID)
+{
+    juce::RangedAudioParameter* found = nullptr;
+
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+            if (ranged->getParameterID() == parameterID)
+                found = ranged;
+
+    if (found == nullptr)
+        juce::ConsoleApplication::fail ("No parameter " + parameterID);
+
+    return *found;
+}
+
+void BenchmarkHelpers::setPlainValue (juce::RangedAudioParameter& parameter, float plainValue)
+{
+    // What the plugin wrappers do for host automation; the value tree state
+    // only sees the change through the listener call
+    const auto value = parameter.convertTo0to1 (plainValue);
+    parameter.setValue (value);
+    parameter.sendValueChangedMessageToListeners (value);
+}
+
+void BenchmarkHelpers::fillWithNoise (juce::AudioBuffer<float>& buffer, int numSamples, juce::Random& random) noexcept
+{
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        auto* samples = buffer.getWritePointer (ch);
+
+        for (int n = 0; n < numSamples; ++n)
+            samples[n] = (random.nextFloat() - 0.5f) * 0.2f;
+    }
+}
+
+void BenchmarkHelpers::print (const juce::String& line)
+{
+    std::cout << line << std::endl;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Per-block timings, in microseconds
+    Storage is reserved up front, so recording a block never allocates and
+    never disturbs the measurement it is part of.
+*/
+class TimingHistogram
+{
+public:
+    //==============================================================================
+    explicit TimingHistogram (size_t capacity);
+
+    void add (double micros) noexcept;
+    void clear() noexcept                   { samples.clear(); }
+    size_t size() const noexcept            { return samples.size(); }
+
+    /** fraction 0..1, e.g. 0.999 for p99.9 */
+    double getPercentile (double fraction) const;
+    double getMax() const;
+    double getMean() const;
+
+    /** "p50 ... p99 ... p99.9 ... max ... us" */
+    juce::String describe() const;
+
+private:
+    std::vector<double> samples;
+    mutable std::vector<double> sorted;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimingHistogram)
+};
+
+//==============================================================================
+/**
+    Counts heap allocations made on the calling thread while a scope is open
+    On Linux with glibc every malloc, calloc and realloc is seen, which covers
+    operator new and juce::HeapBlock alike; elsewhere only operator new is.
+*/
+class AllocationCounter
+{
+public:
+    //==============================================================================
+    class ScopedCount
+    {
+    public:
+        ScopedCount() noexcept;
+        ~ScopedCount() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCount)
+    };
+
+    /** Allocations counted so far, over all threads. */
+    static juce::int64 getCount() noexcept;
+
+    /** Bytes requested by them. */
+    static juce::int64 getBytes() noexcept;
+
+    /** True when malloc itself is counted, not just operator new. */
+    static bool countsMalloc() noexcept;
+};
+
+//==============================================================================
+/**
+    Hardware counters for the calling thread
+    Uses perf_event_open on Linux. Where it is missing or not permitted
+    (other systems, containers, kernel.perf_event_paranoid) isAvailable()
+    is false and every reading is zero, so reports can say so.
+*/
+class PerfCounters
+{
+public:
+    //==============================================================================
+    struct Reading
+    {
+        juce::int64 instructions = 0;
+        juce::int64 cacheReferences = 0;
+        juce::int64 cacheMisses = 0;
+        juce::int64 l1dReadMisses = 0;
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    bool isAvailable() const noexcept       { return available; }
+
+    void start() noexcept;
+    Reading stop() noexcept;
+
+private:
+    enum { numCounters = 4 };
+
+    int descriptors[numCounters] = { -1, -1, -1, -1 };
+    bool available = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerfCounters)
+};
+
+//==============================================================================
+/** Process-wide figures for the scaling reports. */
+struct ProcessStats
+{
+    /** Resident set size in bytes, or 0 where it cannot be read. */
+    static juce::int64 getResidentBytes();
+
+    /** Threads in this process, or 0 where they cannot be counted. */
+    static int getThreadCount();
+
+    /** Times the calling thread gave up the CPU by itself - blocked on a lock,
+        slept or waited - or 0 where it cannot be read. */
+    static juce::int64 getVoluntarySwitches();
+};
+
+//==============================================================================
+/** Helpers shared by the benchmarks. */
+struct BenchmarkHelpers
+{
+    static double ticksToMicros (juce::int64 ticks) noexcept;
+
+    /** Reads "--name=value", falling back to the default when absent or empty. */
+    static int getIntOption (const juce::ArgumentList& args, juce::StringRef option, int defaultValue);
+    static double getDoubleOption (const juce::ArgumentList& args, juce::StringRef option, double defaultValue);
+
+    /** Brings a processor up the way a DAW does: bus layout, rate and block
+        size, real-time mode, then prepareToPlay. Fails the run if the layout
+        is refused. */
+    static void prepareLikeHost (juce::AudioProcessor& processor, const juce::AudioProcessor::BusesLayout& layout,
+                                 double sampleRate, int blockSize);
+
+    /** Looks a parameter up once, so automation can set it every block. Fails the run if it is missing. */
+    static juce::RangedAudioParameter& getParameter (juce::AudioProcessor& processor, const juce::String& parameterID);
+
+    /** Sets a parameter from the audio thread, as host automation does. */
+    static void setPlainValue (juce::RangedAudioParameter& parameter, float plainValue);
+
+    /** Fills every channel with low-level noise. */
+    static void fillWithNoise (juce::AudioBuffer<float>& buffer, int numSamples, juce::Random& random) noexcept;
+
+    /** Writes one line of the report. */
+    static void print (const juce::String& line);
+};
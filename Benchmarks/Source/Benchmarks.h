@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// One entry point per command. Each prints its report and fails the run,
+// with a non-zero exit code, when a check it makes does not hold.
+
+/** 8, 32 and 64 objects through the multi-object renderer, Direct and Ambisonic. */
+void runMultiObjectBenchmark (const juce::ArgumentList& args);
+
+/** DistanceProcessor fed 1, 17, 480 and 4096 samples per call; fails if processBlock allocates. */
+void runBlockSizeBenchmark (const juce::ArgumentList& args);
+
+/** DistanceProcessor under adversarial automation; fails when the block-time tail exceeds the budget. */
+void runStressBenchmark (const juce::ArgumentList& args);
+
+/** 1-256 plugin instances prepared like a DAW and rendered from several audio threads against the block deadline. */
+void runHostSimulationBenchmark (const juce::ArgumentList& args);
+
+/** Constructor, prepareToPlay and first-block latency over a session of instances; fails if the first blocks allocate. */
+void runStartupBenchmark (const juce::ArgumentList& args);
+
+/** DistanceProcessor's size, what prepare allocates, and perf counters per block for one instance against many interleaved. */
+void runFootprintBenchmark (const juce::ArgumentList& args);
+
+/** PropagationDelay per block in each interpolation mode for static integer, static fractional and ramping delays. */
+void runDelayInterpolationBenchmark (const juce::ArgumentList& args);
+
+/** A measured response surface, built and blended per block, against the live source stages it would replace. */
+void runResponseSurfaceBenchmark (const juce::ArgumentList& args);
+
+/** Static scenes rendered by the live chain and by convolution with their measured response. */
+void runSceneBakingBenchmark (const juce::ArgumentList& args);
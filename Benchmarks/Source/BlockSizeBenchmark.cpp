@@ -0,0 +1,110 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/DistanceProcessor.h"
+
+//==============================================================================
+namespace
+{
+    struct BlockSizeResult
+    {
+        double microsPerCall = 0.0;
+        double nanosPerSample = 0.0;
+        juce::int64 allocations = 0;
+        juce::int64 allocatedBytes = 0;
+    };
+
+    BlockSizeResult runBlockSize (int blockSize, int preparedBlockSize, double sampleRate, double seconds)
+    {
+        // The host announces one size and then sends another, as offline renders do
+        DistanceProcessor processor;
+        processor.prepare (sampleRate, preparedBlockSize);
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::Random random (blockSize);
+
+        const auto numCalls = juce::jmax (1, (int) (seconds * sampleRate / blockSize));
+        const auto warmUpCalls = juce::jmax (1, (int) (sampleRate / blockSize));
+        juce::int64 elapsedTicks = 0, allocationsBefore = 0, bytesBefore = 0;
+
+        for (int call = -warmUpCalls; call < numCalls; ++call)
+        {
+            if (call == 0)
+            {
+                allocationsBefore = AllocationCounter::getCount();
+                bytesBefore = AllocationCounter::getBytes();
+            }
+
+            // Slow automation, so the smoothers and the delay stay in motion
+            const auto time = (float) ((double) call * blockSize / sampleRate);
+            const auto distance = 10.0f + 8.0f * std::sin (0.7f * time);
+            const auto pan = 90.0f * std::sin (0.3f * time);
+
+            processor.setDistance (distance);
+            processor.setMaxDistance (20.0f);
+
+            BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            {
+                AllocationCounter::ScopedCount counting;
+                processor.processBlock (buffer, distance, pan, DistanceProcessor::Room);
+            }
+
+            if (call >= 0)
+                elapsedTicks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        BlockSizeResult result;
+        result.microsPerCall  = BenchmarkHelpers::ticksToMicros (elapsedTicks) / numCalls;
+        result.nanosPerSample = 1000.0 * result.microsPerCall / blockSize;
+        result.allocations    = AllocationCounter::getCount() - allocationsBefore;
+        result.allocatedBytes = AllocationCounter::getBytes() - bytesBefore;
+        return result;
+    }
+}
+
+//==============================================================================
+void runBlockSizeBenchmark (const juce::ArgumentList& args)
+{
+    const auto sampleRate        = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto preparedBlockSize = BenchmarkHelpers::getIntOption (args, "--prepared-block", 480);
+    const auto seconds           = BenchmarkHelpers::getDoubleOption (args, "--seconds", 10.0);
+
+    auto blockSizes = juce::StringArray::fromTokens (args.getValueForOption ("--sizes"), ",", {});
+    blockSizes.removeEmptyStrings();
+
+    if (blockSizes.isEmpty())
+        blockSizes = { "1", "17", "480", "4096" };
+
+    if (sampleRate <= 0.0 || preparedBlockSize <= 0 || seconds <= 0.0)
+        juce::ConsoleApplication::fail ("--rate, --prepared-block and --seconds have to be positive");
+
+    BenchmarkHelpers::print ("DistanceProcessor prepared for " + juce::String (preparedBlockSize) + " samples at "
+                             + juce::String (sampleRate, 0) + " Hz, " + juce::String (seconds, 1) + " s per size");
+
+    if (! AllocationCounter::countsMalloc())
+        BenchmarkHelpers::print ("(only operator new is counted on this platform)");
+
+    juce::int64 totalAllocations = 0;
+
+    for (const auto& size : blockSizes)
+    {
+        const auto blockSize = size.getIntValue();
+
+        if (blockSize < 1)
+            juce::ConsoleApplication::fail ("Block sizes have to be positive");
+
+        const auto result = runBlockSize (blockSize, preparedBlockSize, sampleRate, seconds);
+        totalAllocations += result.allocations;
+
+        BenchmarkHelpers::print (juce::String (blockSize).paddedLeft (' ', 5) + " samples  "
+                                 + juce::String (result.microsPerCall, 2) + " us/call  "
+                                 + juce::String (result.nanosPerSample, 1) + " ns/sample  "
+                                 + juce::String (result.allocations) + " allocations ("
+                                 + juce::String (result.allocatedBytes) + " bytes)");
+    }
+
+    if (totalAllocations > 0)
+        juce::ConsoleApplication::fail ("processBlock allocated " + juce::String (totalAllocations) + " times");
+}
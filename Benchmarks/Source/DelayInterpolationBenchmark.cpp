@@ -0,0 +1,162 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/PropagationDelay.h"
+
+//==============================================================================
+namespace
+{
+    enum class Motion { StaticInteger, StaticFractional, Ramping };
+
+    constexpr float baseDelay = 480.0f;     // 10 ms at 48 kHz
+    constexpr float fractionalPart = 0.37f;
+    constexpr float rampDepth = 400.0f;     // samples either side of the base delay
+
+    const char* getInterpolationName (PropagationDelay::Interpolation interpolation)
+    {
+        switch (interpolation)
+        {
+            case PropagationDelay::Lagrange3:     return "Lagrange-3";
+            case PropagationDelay::Thiran:        return "Thiran";
+            case PropagationDelay::WindowedSinc:  return "Windowed sinc";
+        }
+
+        return "";
+    }
+
+    // The delay the block at this index should end on
+    float getTargetDelay (Motion motion, int block, int blockSize, double sampleRate) noexcept
+    {
+        switch (motion)
+        {
+            case Motion::StaticInteger:     return baseDelay;
+            case Motion::StaticFractional:  return baseDelay + fractionalPart;
+            case Motion::Ramping:           break;
+        }
+
+        // A source sweeping +-4 m at 0.5 Hz stays well inside the slew cap, so
+        // every block reads along a ramp
+        const auto seconds = (double) (block + 1) * blockSize / sampleRate;
+        return baseDelay + rampDepth * (float) std::sin (juce::MathConstants<double>::twoPi * 0.5 * seconds);
+    }
+
+    struct InterpolationResult
+    {
+        double microsPerBlock = 0.0;
+        juce::int64 allocations = 0;
+    };
+
+    InterpolationResult runInterpolation (PropagationDelay::Interpolation interpolation, Motion motion,
+                                          double sampleRate, int blockSize, int numBlocks)
+    {
+        PropagationDelay delay;
+        delay.prepare (sampleRate, blockSize, 2, 0.1);
+        delay.setInterpolation (interpolation);
+        delay.setDelayImmediate (getTargetDelay (motion, -1, blockSize, sampleRate));
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::Random random (blockSize);
+
+        const auto warmUpBlocks = juce::jmax (1, (int) (sampleRate / blockSize));
+        juce::int64 elapsedTicks = 0, allocationsBefore = 0;
+
+        for (int block = -warmUpBlocks; block < numBlocks; ++block)
+        {
+            if (block == 0)
+                allocationsBefore = AllocationCounter::getCount();
+
+            BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+            delay.setDelay (getTargetDelay (motion, block, blockSize, sampleRate));
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            {
+                AllocationCounter::ScopedCount counting;
+                delay.process (buffer, 2, blockSize);
+            }
+
+            if (block >= 0)
+                elapsedTicks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        InterpolationResult result;
+        result.microsPerBlock = BenchmarkHelpers::ticksToMicros (elapsedTicks) / numBlocks;
+        result.allocations = AllocationCounter::getCount() - allocationsBefore;
+        return result;
+    }
+
+    // Largest deviation from an exactly delayed 1 kHz sine at the static fractional delay
+    double measureError (PropagationDelay::Interpolation interpolation, double sampleRate, int blockSize)
+    {
+        const auto delaySamples = (double) (baseDelay + fractionalPart);
+        const auto omega = juce::MathConstants<double>::twoPi * 1000.0 / sampleRate;
+
+        PropagationDelay delay;
+        delay.prepare (sampleRate, blockSize, 1, 0.1);
+        delay.setInterpolation (interpolation);
+        delay.setDelayImmediate ((float) delaySamples);
+
+        juce::AudioBuffer<float> buffer (1, blockSize);
+        const auto numBlocks = juce::jmax (4, (int) (sampleRate / blockSize));
+        double maxError = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto first = (juce::int64) block * blockSize;
+
+            for (int n = 0; n < blockSize; ++n)
+                buffer.setSample (0, n, (float) std::sin (omega * (double) (first + n)));
+
+            delay.process (buffer, 1, blockSize);
+
+            // Skip the first half second, while the line fills and the allpass settles
+            if (block < numBlocks / 2)
+                continue;
+
+            for (int n = 0; n < blockSize; ++n)
+            {
+                const auto expected = std::sin (omega * ((double) (first + n) - delaySamples));
+                maxError = juce::jmax (maxError, std::abs ((double) buffer.getSample (0, n) - expected));
+            }
+        }
+
+        return maxError;
+    }
+}
+
+//==============================================================================
+void runDelayInterpolationBenchmark (const juce::ArgumentList& args)
+{
+    const auto sampleRate = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto blockSize  = BenchmarkHelpers::getIntOption (args, "--block", 256);
+    const auto seconds    = BenchmarkHelpers::getDoubleOption (args, "--seconds", 10.0);
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || seconds <= 0.0)
+        juce::ConsoleApplication::fail ("--rate, --block and --seconds have to be positive");
+
+    const auto numBlocks = juce::jmax (1, (int) (seconds * sampleRate / blockSize));
+
+    BenchmarkHelpers::print ("PropagationDelay, 2 x " + juce::String (blockSize) + " samples at "
+                             + juce::String (sampleRate, 0) + " Hz, " + juce::String (seconds, 1)
+                             + " s per case, us per block");
+    BenchmarkHelpers::print ("interpolator   static int  static frac  ramping   max error");
+
+    juce::int64 totalAllocations = 0;
+
+    for (auto interpolation : { PropagationDelay::Lagrange3, PropagationDelay::Thiran, PropagationDelay::WindowedSinc })
+    {
+        auto line = juce::String (getInterpolationName (interpolation)).paddedRight (' ', 15);
+
+        for (auto motion : { Motion::StaticInteger, Motion::StaticFractional, Motion::Ramping })
+        {
+            const auto result = runInterpolation (interpolation, motion, sampleRate, blockSize, numBlocks);
+            totalAllocations += result.allocations;
+            line << juce::String (result.microsPerBlock, 2).paddedRight (' ', motion == Motion::Ramping ? 10 : 12);
+        }
+
+        const auto error = measureError (interpolation, sampleRate, blockSize);
+        BenchmarkHelpers::print (line + juce::String (error, 7));
+    }
+
+    if (totalAllocations > 0)
+        juce::ConsoleApplication::fail ("PropagationDelay::process allocated " + juce::String (totalAllocations) + " times");
+}
@@ -0,0 +1,135 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/DistanceProcessor.h"
+
+//==============================================================================
+namespace
+{
+    struct Totals
+    {
+        PerfCounters::Reading counters;
+        double micros = 0.0;
+        juce::int64 blocks = 0;
+
+        void add (const PerfCounters::Reading& reading, double elapsed) noexcept
+        {
+            counters.instructions    += reading.instructions;
+            counters.cacheReferences += reading.cacheReferences;
+            counters.cacheMisses     += reading.cacheMisses;
+            counters.l1dReadMisses   += reading.l1dReadMisses;
+            micros += elapsed;
+            ++blocks;
+        }
+    };
+
+    // Renders numBlocks blocks on every instance, round robin, so with more than
+    // one instance each block starts with the others' state in the caches
+    Totals renderInterleaved (std::vector<std::unique_ptr<DistanceProcessor>>& processors, PerfCounters& counters,
+                              double sampleRate, int blockSize, int numBlocks)
+    {
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::Random random (5);
+        Totals totals;
+
+        const auto warmUpBlocks = juce::jmin (numBlocks, 50);
+
+        for (int block = -warmUpBlocks; block < numBlocks; ++block)
+        {
+            const auto seconds = (float) ((double) block * blockSize / sampleRate);
+
+            for (size_t i = 0; i < processors.size(); ++i)
+            {
+                auto& processor = *processors[i];
+                const auto offset = 0.37f * (float) i;
+
+                // A moving source keeps the head-shadow and tilt shelves live
+                const auto pan = std::fmod (seconds * 90.0f + 40.0f * offset, 360.0f) - 180.0f;
+                const auto distance = 3.0f + 2.0f * std::sin (0.5f * seconds + offset);
+                processor.setSourceHeight (0.5f + 0.4f * std::sin (0.3f * seconds + offset));
+
+                BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+
+                const auto start = juce::Time::getHighResolutionTicks();
+                counters.start();
+                processor.processBlock (buffer, distance, pan, DistanceProcessor::Room);
+                const auto reading = counters.stop();
+                const auto elapsed = BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start);
+
+                if (block >= 0)
+                    totals.add (reading, elapsed);
+            }
+        }
+
+        return totals;
+    }
+
+    juce::String describe (const Totals& totals, bool countersAvailable)
+    {
+        const auto blocks = (double) juce::jmax ((juce::int64) 1, totals.blocks);
+        auto line = juce::String (totals.micros / blocks, 2) + " us";
+
+        if (! countersAvailable)
+            return line + ", perf counters unavailable";
+
+        auto perBlock = [blocks] (juce::int64 value) { return juce::String (juce::roundToInt ((double) value / blocks)); };
+
+        return line + ", " + perBlock (totals.counters.instructions) + " instructions, "
+                    + perBlock (totals.counters.cacheReferences) + " cache references, "
+                    + perBlock (totals.counters.cacheMisses) + " cache misses, "
+                    + perBlock (totals.counters.l1dReadMisses) + " L1D read misses";
+    }
+}
+
+//==============================================================================
+void runFootprintBenchmark (const juce::ArgumentList& args)
+{
+    const auto sampleRate   = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto blockSize    = BenchmarkHelpers::getIntOption (args, "--block", 128);
+    const auto numInstances = BenchmarkHelpers::getIntOption (args, "--instances", 64);
+    const auto numBlocks    = BenchmarkHelpers::getIntOption (args, "--blocks", 2000);
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || numInstances <= 0 || numBlocks <= 0)
+        juce::ConsoleApplication::fail ("--rate, --block, --instances and --blocks have to be positive");
+
+    BenchmarkHelpers::print ("DistanceProcessor footprint, " + juce::String (blockSize) + " samples at "
+                             + juce::String (juce::roundToInt (sampleRate)) + " Hz");
+    BenchmarkHelpers::print ("object        " + juce::String ((int) sizeof (DistanceProcessor)) + " bytes");
+
+    // What prepare() puts on the heap for one instance, on top of the object
+    std::vector<std::unique_ptr<DistanceProcessor>> processors;
+
+    for (int i = 0; i < numInstances; ++i)
+        processors.push_back (std::make_unique<DistanceProcessor>());
+
+    const auto allocationsBefore = AllocationCounter::getCount();
+    const auto bytesBefore = AllocationCounter::getBytes();
+
+    {
+        AllocationCounter::ScopedCount counting;
+        processors.front()->prepare (sampleRate, blockSize);
+    }
+
+    BenchmarkHelpers::print ("prepare       " + juce::String (AllocationCounter::getCount() - allocationsBefore) + " allocations, "
+                             + juce::String ((AllocationCounter::getBytes() - bytesBefore) / 1024) + " KB"
+                             + (AllocationCounter::countsMalloc() ? "" : " (operator new only)"));
+
+    for (size_t i = 1; i < processors.size(); ++i)
+        processors[i]->prepare (sampleRate, blockSize);
+
+    PerfCounters counters;
+    const auto available = counters.isAvailable();
+
+    // One instance keeps its state hot; many interleaved show what a block
+    // costs when it has to bring its state back in
+    std::vector<std::unique_ptr<DistanceProcessor>> single;
+    single.push_back (std::move (processors.front()));
+    const auto hot = renderInterleaved (single, counters, sampleRate, blockSize, numBlocks);
+    processors.front() = std::move (single.front());
+
+    const auto blocksPerInstance = juce::jmax (1, numBlocks / numInstances);
+    const auto cold = renderInterleaved (processors, counters, sampleRate, blockSize, blocksPerInstance);
+
+    BenchmarkHelpers::print ("per block, 1 instance      " + describe (hot, available));
+    BenchmarkHelpers::print ("per block, " + juce::String (numInstances).paddedRight (' ', 3)
+                             + (numInstances == 1 ? " instance     " : " interleaved  ") + describe (cold, available));
+}
@@ -0,0 +1,335 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/BackgroundWorkerPool.h"
+#include <numeric>
+#include <thread>
+
+//==============================================================================
+namespace
+{
+    struct Instance
+    {
+        std::unique_ptr<SOFARAudioProcessor> processor;
+        juce::RangedAudioParameter* distance = nullptr;
+        juce::RangedAudioParameter* panning = nullptr;
+        juce::RangedAudioParameter* height = nullptr;
+        juce::RangedAudioParameter* roomLength = nullptr;
+        juce::AudioBuffer<float> source, buffer;   // the track's audio, and the block handed to the plugin
+        juce::MidiBuffer midi;
+    };
+
+    struct HostSettings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 128;
+        int numThreads = 1;
+        int numCycles = 2000;
+        bool paced = true;
+        bool sharedRooms = false;
+    };
+
+    // Host automation, written from the audio thread before each block
+    void renderInstance (Instance& instance, int index, int cycle, const HostSettings& settings)
+    {
+        const auto time = (float) ((double) cycle * settings.blockSize / settings.sampleRate);
+        const auto offset = 0.37f * (float) index;
+
+        BenchmarkHelpers::setPlainValue (*instance.distance, 0.5f + 0.4f * std::sin (0.5f * time + offset));
+        BenchmarkHelpers::setPlainValue (*instance.panning, std::fmod (20.0f * time + 40.0f * offset, 360.0f));
+        BenchmarkHelpers::setPlainValue (*instance.height, 0.5f + 0.3f * std::sin (0.2f * time + offset));
+
+        // Now and then a room edit, staggered across the instances, so the
+        // background pool sees trigger traffic from every audio thread
+        if ((cycle + 7 * index) % 400 == 0)
+            BenchmarkHelpers::setPlainValue (*instance.roomLength, 6.0f + 2.0f * (float) ((cycle / 400) % 5));
+
+        for (int ch = 0; ch < instance.buffer.getNumChannels(); ++ch)
+            instance.buffer.copyFrom (ch, 0, instance.source, ch, 0, settings.blockSize);
+
+        instance.processor->processBlock (instance.buffer, instance.midi);
+    }
+
+    //==============================================================================
+    /*
+        The host's audio threads. Each cycle the driver releases every thread,
+        each renders its share of the instances, and the cycle ends when the
+        last one is done - the way a DAW spreads tracks over its cores.
+    */
+    class AudioThreads
+    {
+    public:
+        AudioThreads (std::vector<Instance>& instancesToRender, const HostSettings& hostSettings)
+            : instances (instancesToRender), settings (hostSettings),
+              blockedSwitches ((size_t) hostSettings.numThreads, 0)
+        {
+            for (int i = 0; i < settings.numThreads; ++i)
+                startEvents.push_back (std::make_unique<juce::WaitableEvent>());
+
+            for (int i = 0; i < settings.numThreads; ++i)
+                threads.emplace_back ([this, i] { run (i); });
+        }
+
+        ~AudioThreads()
+        {
+            quit = true;
+
+            for (auto& event : startEvents)
+                event->signal();
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        /** Renders one cycle on every thread and returns once all are done. */
+        void renderCycle (int cycle)
+        {
+            currentCycle = cycle;
+            remaining = settings.numThreads;
+
+            for (auto& event : startEvents)
+                event->signal();
+
+            finished.wait (-1);
+        }
+
+        /** Voluntary context switches inside the render loops: a thread that
+            blocks on a lock or waits while rendering shows up here. */
+        juce::int64 getBlockedSwitches() const noexcept
+        {
+            return std::accumulate (blockedSwitches.begin(), blockedSwitches.end(), (juce::int64) 0);
+        }
+
+    private:
+        void run (int threadIndex)
+        {
+            for (;;)
+            {
+                startEvents[(size_t) threadIndex]->wait (-1);
+
+                if (quit)
+                    return;
+
+                const auto switchesBefore = ProcessStats::getVoluntarySwitches();
+
+                for (auto i = (size_t) threadIndex; i < instances.size(); i += (size_t) settings.numThreads)
+                    renderInstance (instances[i], (int) i, currentCycle, settings);
+
+                blockedSwitches[(size_t) threadIndex] += ProcessStats::getVoluntarySwitches() - switchesBefore;
+
+                if (remaining.fetch_sub (1) == 1)
+                    finished.signal();
+            }
+        }
+
+        std::vector<Instance>& instances;
+        const HostSettings& settings;
+
+        std::vector<std::unique_ptr<juce::WaitableEvent>> startEvents;
+        juce::WaitableEvent finished;
+        std::atomic<int> remaining { 0 };
+        std::atomic<int> currentCycle { 0 };
+        std::atomic<bool> quit { false };
+        std::vector<juce::int64> blockedSwitches;   // one per thread, written by that thread only
+        std::vector<std::thread> threads;
+
+        JUCE_DECLARE_NON_COPYABLE (AudioThreads)
+    };
+
+    //==============================================================================
+    // Between cycles the driver runs the message loop, so timers and async
+    // updates are serviced as they would be in a host
+    void waitUntil (juce::int64 targetTicks)
+    {
+        for (;;)
+        {
+            const auto remainingMs = BenchmarkHelpers::ticksToMicros (targetTicks - juce::Time::getHighResolutionTicks()) / 1000.0;
+
+            if (remainingMs <= 0.0)
+                return;
+
+            if (remainingMs >= 2.0)
+                juce::MessageManager::getInstance()->runDispatchLoopUntil ((int) remainingMs - 1);
+            else
+                juce::Thread::yield();
+        }
+    }
+
+    void runSession (int numInstances, const HostSettings& settings, double maxMissPercent)
+    {
+        juce::SharedResourcePointer<BackgroundWorkerPool> pool;
+
+        const auto threadsBefore = ProcessStats::getThreadCount();
+        const auto residentBefore = ProcessStats::getResidentBytes();
+
+        // Construct and prepare on the message thread, one instance after another, as a session load does
+        std::vector<Instance> instances ((size_t) numInstances);
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (auto& instance : instances)
+            instance.processor = std::make_unique<SOFARAudioProcessor>();
+
+        const auto constructMicros = BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (juce::AudioChannelSet::stereo());
+        layout.outputBuses.add (juce::AudioChannelSet::stereo());
+
+        start = juce::Time::getHighResolutionTicks();
+
+        for (size_t i = 0; i < instances.size(); ++i)
+        {
+            auto& instance = instances[i];
+
+            // Fill one shared room after another, the first member of each as its return
+            if (settings.sharedRooms)
+            {
+                const auto roomIndex = (int) i / SharedRoomBus::maxMembers;
+                BenchmarkHelpers::setPlainValue (BenchmarkHelpers::getParameter (*instance.processor, "sharedRoom"),
+                                                 (float) (juce::jmin (roomIndex, SharedRoomBus::maxRooms - 1) + 1));
+                BenchmarkHelpers::setPlainValue (BenchmarkHelpers::getParameter (*instance.processor, "roomRole"),
+                                                 (int) i % SharedRoomBus::maxMembers == 0 ? 1.0f : 0.0f);
+            }
+
+            BenchmarkHelpers::prepareLikeHost (*instance.processor, layout, settings.sampleRate, settings.blockSize);
+
+            instance.distance = &BenchmarkHelpers::getParameter (*instance.processor, "distance");
+            instance.panning  = &BenchmarkHelpers::getParameter (*instance.processor, "panning");
+            instance.height   = &BenchmarkHelpers::getParameter (*instance.processor, "height");
+            instance.roomLength = &BenchmarkHelpers::getParameter (*instance.processor, "roomLength");
+
+            juce::Random random ((juce::int64) i + 1);
+            instance.source.setSize (2, settings.blockSize);
+            instance.buffer.setSize (2, settings.blockSize);
+            BenchmarkHelpers::fillWithNoise (instance.source, settings.blockSize, random);
+        }
+
+        const auto prepareMicros = BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start);
+        const auto residentPrepared = ProcessStats::getResidentBytes();
+        const auto threadsPrepared = ProcessStats::getThreadCount();
+
+        // Let the background work queued by prepare settle before the clock starts
+        waitUntil (juce::Time::getHighResolutionTicks() + juce::Time::getHighResolutionTicksPerSecond() / 4);
+
+        const auto deadlineMicros = settings.blockSize * 1.0e6 / settings.sampleRate;
+        const auto periodTicks = (juce::int64) ((double) settings.blockSize / settings.sampleRate
+                                                * (double) juce::Time::getHighResolutionTicksPerSecond());
+        const auto warmUpCycles = juce::jmax (1, settings.numCycles / 10);
+
+        TimingHistogram cycles ((size_t) settings.numCycles);
+        int misses = 0;
+        juce::int64 switchesAtStart = 0, blockingWaits = 0;
+
+        {
+            AudioThreads audioThreads (instances, settings);
+            auto nextCycle = juce::Time::getHighResolutionTicks();
+
+            for (int cycle = -warmUpCycles; cycle < settings.numCycles; ++cycle)
+            {
+                if (cycle == 0)
+                {
+                    pool->resetMetrics();
+                    switchesAtStart = audioThreads.getBlockedSwitches();
+                }
+
+                if (settings.paced)
+                    waitUntil (nextCycle);
+
+                const auto cycleStart = juce::Time::getHighResolutionTicks();
+                audioThreads.renderCycle (cycle);
+                const auto elapsed = BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - cycleStart);
+
+                if (cycle >= 0)
+                {
+                    cycles.add (elapsed);
+
+                    if (elapsed > deadlineMicros)
+                        ++misses;
+                }
+
+                // A late cycle starts the next one straight away rather than trying to catch up
+                nextCycle = juce::jmax (nextCycle + periodTicks, juce::Time::getHighResolutionTicks());
+            }
+
+            blockingWaits = audioThreads.getBlockedSwitches() - switchesAtStart;
+        }
+
+        const auto metrics = pool->getMetrics();
+        const auto missPercent = 100.0 * misses / settings.numCycles;
+
+        BenchmarkHelpers::print (juce::String (numInstances).paddedLeft (' ', 4) + (numInstances == 1 ? " instance on " : " instances on ")
+                                 + juce::String (settings.numThreads) + (settings.numThreads == 1 ? " audio thread" : " audio threads"));
+        BenchmarkHelpers::print ("    load      construct " + juce::String (constructMicros / 1000.0 / numInstances, 3)
+                                 + " ms/instance, prepare " + juce::String (prepareMicros / 1000.0 / numInstances, 3)
+                                 + " ms/instance, RSS " + juce::String (juce::roundToInt ((residentPrepared - residentBefore) / 1024.0 / numInstances))
+                                 + " KB/instance, threads +" + juce::String (threadsPrepared - threadsBefore)
+                                 + " (" + juce::String (threadsPrepared) + " in the process)");
+        BenchmarkHelpers::print ("    cycle     " + cycles.describe() + " (deadline " + juce::String (juce::roundToInt (deadlineMicros)) + " us), "
+                                 + juce::String (misses) + " of " + juce::String (settings.numCycles) + " missed ("
+                                 + juce::String (missPercent, 2) + "%)");
+        BenchmarkHelpers::print ("    throughput " + juce::String (numInstances * deadlineMicros / juce::jmax (1.0e-3, cycles.getMean()), 1)
+                                 + " real-time instances, " + juce::String (cycles.getMean() / numInstances, 2) + " us per instance-block");
+        BenchmarkHelpers::print ("    contention " + juce::String (blockingWaits) + " blocking waits on the audio threads, "
+                                 + juce::String (metrics.lockWaits) + " waits for the pool's task lock");
+        BenchmarkHelpers::print ("    pool      " + juce::String (metrics.numThreads) + " workers, "
+                                 + juce::String (metrics.runs) + " runs, " + juce::String (metrics.coalesced) + " coalesced, latency avg "
+                                 + juce::String (metrics.averageLatencyMs, 3) + " ms max " + juce::String (metrics.maxLatencyMs, 3)
+                                 + " ms, queue depth max " + juce::String (metrics.maxQueueDepth));
+
+        if (settings.sharedRooms)
+        {
+            int droppedSends = 0;
+
+            for (auto& instance : instances)
+                droppedSends += instance.processor->getDroppedRoomSends();
+
+            BenchmarkHelpers::print ("    room bus  " + juce::String (droppedSends) + " sends dropped on a full FIFO over "
+                                     + juce::String (warmUpCycles + settings.numCycles) + " cycles");
+        }
+
+        for (auto& instance : instances)
+            instance.processor->releaseResources();
+
+        if (maxMissPercent >= 0.0 && missPercent > maxMissPercent)
+            juce::ConsoleApplication::fail (juce::String (missPercent, 2) + "% of the cycles missed the deadline at "
+                                            + juce::String (numInstances) + " instances, more than "
+                                            + juce::String (maxMissPercent, 2) + "%");
+    }
+}
+
+//==============================================================================
+void runHostSimulationBenchmark (const juce::ArgumentList& args)
+{
+    HostSettings settings;
+    settings.sampleRate = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    settings.blockSize  = BenchmarkHelpers::getIntOption (args, "--block", 128);
+    settings.numThreads = BenchmarkHelpers::getIntOption (args, "--threads", juce::SystemStats::getNumCpus());
+    settings.numCycles  = BenchmarkHelpers::getIntOption (args, "--cycles", 2000);
+    settings.paced      = ! args.containsOption ("--unpaced");
+    settings.sharedRooms = args.containsOption ("--shared-room");
+
+    const auto maxMissPercent = BenchmarkHelpers::getDoubleOption (args, "--max-miss-rate", -1.0);
+
+    auto instanceCounts = juce::StringArray::fromTokens (args.getValueForOption ("--instances"), ",", {});
+    instanceCounts.removeEmptyStrings();
+
+    if (instanceCounts.isEmpty())
+        instanceCounts = { "1", "16", "64", "128", "256" };
+
+    if (settings.sampleRate <= 0.0 || settings.blockSize <= 0 || settings.numThreads <= 0 || settings.numCycles <= 0)
+        juce::ConsoleApplication::fail ("--rate, --block, --threads and --cycles have to be positive");
+
+    BenchmarkHelpers::print ("Host simulation, " + juce::String (settings.blockSize) + " samples at "
+                             + juce::String (juce::roundToInt (settings.sampleRate)) + " Hz, " + juce::String (settings.numCycles)
+                             + (settings.paced ? " cycles paced to the audio clock" : " cycles back to back"));
+
+    for (const auto& count : instanceCounts)
+    {
+        const auto numInstances = count.getIntValue();
+
+        if (numInstances < 1 || numInstances > 256)
+            juce::ConsoleApplication::fail ("Instance counts have to be 1..256");
+
+        runSession (numInstances, settings, maxMissPercent);
+    }
+}
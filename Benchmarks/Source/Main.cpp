@@ -0,0 +1,115 @@
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+
+//==============================================================================
+namespace
+{
+    // The processors log from their constructors; keep that out of the reports
+    struct SilentLogger  : public juce::Logger
+    {
+        void logMessage (const juce::String&) override {}
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processors start timers and check for the message thread, so this
+    // thread has to be one
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    SilentLogger logger;
+    juce::Logger::setCurrentLogger (&logger);
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "SOFAR benchmarks", true);
+
+    app.addCommand ({ "--multi-object",
+                      "--multi-object [--objects=8,32,64] [--block=256] [--rate=48000] [--seconds=10]",
+                      "Per-block cost of the multi-object renderer",
+                      "Renders 8, 32 and 64 moving objects to stereo, Direct and Ambisonic,\n"
+                      "and prints the block time histogram, the load and the cost per object.",
+                      runMultiObjectBenchmark });
+
+    app.addCommand ({ "--block-size",
+                      "--block-size [--sizes=1,17,480,4096] [--prepared-block=480] [--rate=48000] [--seconds=10]",
+                      "Per-sample cost and allocations at odd block sizes",
+                      "Prepares DistanceProcessor for one block size and feeds it others, larger\n"
+                      "ones included, then prints the cost per call and per sample. Fails if\n"
+                      "processBlock allocates.",
+                      runBlockSizeBenchmark });
+
+    app.addCommand ({ "--stress",
+                      "--stress [--block=128] [--rate=48000] [--phase-seconds=5] [--rounds=1] [--mono]\n"
+                      "         [--budget-p99=50] [--budget-p999=75] [--budget-max=100]",
+                      "Worst-case block times under adversarial automation",
+                      "Drives DistanceProcessor through fast 0-360 degree pan sweeps, rear flips,\n"
+                      "room-size jumps, environment switches, distance crossing 30 m and height\n"
+                      "flips, and prints p50/p99/p99.9/max per phase. Budgets are percentages of\n"
+                      "the block deadline; the run fails if one is exceeded or processBlock allocates.",
+                      runStressBenchmark });
+
+    app.addCommand ({ "--host-sim",
+                      "--host-sim [--instances=1,16,64,128,256] [--threads=<cores>] [--cycles=2000]\n"
+                      "           [--block=128] [--rate=48000] [--unpaced] [--shared-room] [--max-miss-rate=<percent>]",
+                      "Many plugin instances driven like a DAW session",
+                      "Constructs and prepares up to 256 SOFARAudioProcessors on the message thread,\n"
+                      "then renders them from a pool of audio threads, one cycle per block period,\n"
+                      "with automation on every instance. Prints throughput, deadline misses, RSS\n"
+                      "per instance, thread count, blocking waits on the audio threads and the\n"
+                      "background pool's figures. With --shared-room the instances join shared rooms\n"
+                      "of up to 64 members, the first of each as its return, and the room sends\n"
+                      "dropped on a full FIFO are printed. Fails if --max-miss-rate is given and exceeded.",
+                      runHostSimulationBenchmark });
+
+    app.addCommand ({ "--startup",
+                      "--startup [--instances=100] [--block=128] [--rate=48000]",
+                      "Session-load latency: constructor, prepareToPlay and first block",
+                      "Constructs and prepares a session of SOFARAudioProcessors on the message\n"
+                      "thread, renders the first block of each before the background work queued\n"
+                      "by prepare has run and one after, then re-prepares them all. Prints the\n"
+                      "time and allocations per instance for each step. Fails if a block allocates.",
+                      runStartupBenchmark });
+
+    app.addCommand ({ "--footprint",
+                      "--footprint [--instances=64] [--blocks=2000] [--block=128] [--rate=48000]",
+                      "Memory footprint and cache behaviour of DistanceProcessor",
+                      "Prints sizeof(DistanceProcessor) and the allocations and bytes of one prepare,\n"
+                      "then the time, instructions, cache references, cache misses and L1D read misses\n"
+                      "per block for one instance and for many rendered round robin. The counters\n"
+                      "need perf_event_open; where it is missing they are reported as unavailable.",
+                      runFootprintBenchmark });
+
+    app.addCommand ({ "--delay-interpolation",
+                      "--delay-interpolation [--block=256] [--rate=48000] [--seconds=10]",
+                      "Cost of each propagation-delay interpolator",
+                      "Runs PropagationDelay in Lagrange-3, Thiran and windowed-sinc mode on a\n"
+                      "static integer delay, a static fractional delay and a ramping delay, and\n"
+                      "prints the time per stereo block, plus each mode's largest error against\n"
+                      "an exactly delayed 1 kHz sine. Fails if process() allocates.",
+                      runDelayInterpolationBenchmark });
+
+    app.addCommand ({ "--response-surface",
+                      "--response-surface [--block=256] [--rate=48000] [--seconds=10]",
+                      "The declined response-surface renderer against the live source stages",
+                      "Builds a 12 x 25 x 5 grid of 64-tap minimum-phase ear responses measured\n"
+                      "through DistanceProcessor, then renders a moving mono source with it and\n"
+                      "with the live height, gain, air, width and panning stages. Prints the\n"
+                      "build time, the memory the grid and its measuring processor take, and the\n"
+                      "time per block of each renderer. Fails if the surface filter allocates.",
+                      runResponseSurfaceBenchmark });
+
+    app.addCommand ({ "--scene-baking",
+                      "--scene-baking [--block=128] [--rate=48000] [--seconds=5] [--head=128]",
+                      "The removed static-scene bake against the live chain",
+                      "Measures the impulse response of DistanceProcessor for a few static scenes,\n"
+                      "then renders each scene with the live chain and by convolution with that\n"
+                      "response: a direct-form head of --head taps and a tail in uniform FFT\n"
+                      "partitions. Prints the response length and the mean time per block of both.",
+                      runSceneBakingBenchmark });
+
+    const auto result = app.findAndRunCommand (argc, argv);
+
+    juce::Logger::setCurrentLogger (nullptr);
+    return result;
+}
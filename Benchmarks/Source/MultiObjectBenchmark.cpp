@@ -0,0 +1,117 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+namespace
+{
+    struct ObjectAutomation
+    {
+        juce::RangedAudioParameter* distance = nullptr;
+        juce::RangedAudioParameter* azimuth = nullptr;
+        juce::RangedAudioParameter* height = nullptr;
+    };
+
+    void runScene (int numObjects, int renderMode, double sampleRate, int blockSize, double seconds)
+    {
+        SOFARAudioProcessor processor;
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (juce::AudioChannelSet::discreteChannels (numObjects));
+        layout.outputBuses.add (juce::AudioChannelSet::stereo());
+
+        BenchmarkHelpers::setPlainValue (BenchmarkHelpers::getParameter (processor, "objectRenderMode"), (float) renderMode);
+        BenchmarkHelpers::prepareLikeHost (processor, layout, sampleRate, blockSize);
+
+        if (processor.getNumObjects() != numObjects)
+            juce::ConsoleApplication::fail ("Expected " + juce::String (numObjects) + " objects, the processor renders "
+                                            + juce::String (processor.getNumObjects()));
+
+        std::vector<ObjectAutomation> objects ((size_t) numObjects);
+
+        for (int i = 0; i < numObjects; ++i)
+        {
+            const juce::String index (i + 1);
+            objects[(size_t) i] = { &BenchmarkHelpers::getParameter (processor, "objDistance" + index),
+                                    &BenchmarkHelpers::getParameter (processor, "objAzimuth" + index),
+                                    &BenchmarkHelpers::getParameter (processor, "objHeight" + index) };
+        }
+
+        juce::AudioBuffer<float> buffer (juce::jmax (numObjects, 2), blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random (numObjects);
+
+        const auto numBlocks = juce::jmax (1, (int) (seconds * sampleRate / blockSize));
+        const auto warmUpBlocks = juce::jmin (numBlocks, (int) (sampleRate / blockSize));
+        TimingHistogram histogram ((size_t) numBlocks);
+
+        for (int block = -warmUpBlocks; block < numBlocks; ++block)
+        {
+            // Every object circles at its own rate and breathes in and out, so
+            // the per-object smoothing and delay changes are always live
+            const auto time = (float) ((double) block * blockSize / sampleRate);
+
+            for (int i = 0; i < numObjects; ++i)
+            {
+                const auto phase = (float) i / (float) numObjects;
+                const auto& object = objects[(size_t) i];
+
+                BenchmarkHelpers::setPlainValue (*object.azimuth, std::fmod (360.0f * phase + time * (20.0f + 5.0f * (float) i), 360.0f));
+                BenchmarkHelpers::setPlainValue (*object.distance, 0.5f + 0.45f * std::sin (time + 6.0f * phase));
+                BenchmarkHelpers::setPlainValue (*object.height, 0.5f + 0.5f * std::sin (0.3f * time + 3.0f * phase));
+            }
+
+            BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            const auto elapsed = BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start);
+
+            if (block >= 0)
+                histogram.add (elapsed);
+        }
+
+        processor.releaseResources();
+
+        const auto deadline = blockSize * 1.0e6 / sampleRate;
+
+        BenchmarkHelpers::print (juce::String (numObjects).paddedLeft (' ', 3) + " objects  "
+                                 + (renderMode == MultiObjectRenderer::Ambisonic ? "Ambisonic" : "Direct   ")
+                                 + "  " + histogram.describe()
+                                 + "  load " + juce::String (100.0 * histogram.getMean() / deadline, 1) + "%"
+                                 + "  " + juce::String (histogram.getMean() / numObjects, 2) + " us/object");
+    }
+}
+
+//==============================================================================
+void runMultiObjectBenchmark (const juce::ArgumentList& args)
+{
+    const auto sampleRate = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto blockSize  = BenchmarkHelpers::getIntOption (args, "--block", 256);
+    const auto seconds    = BenchmarkHelpers::getDoubleOption (args, "--seconds", 10.0);
+
+    auto objectCounts = juce::StringArray::fromTokens (args.getValueForOption ("--objects"), ",", {});
+    objectCounts.removeEmptyStrings();
+
+    if (objectCounts.isEmpty())
+        objectCounts = { "8", "32", "64" };
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || seconds <= 0.0)
+        juce::ConsoleApplication::fail ("--rate, --block and --seconds have to be positive");
+
+    BenchmarkHelpers::print ("Multi-object renderer, " + juce::String (juce::roundToInt (sampleRate)) + " Hz, "
+                             + juce::String (blockSize) + " samples per block (deadline "
+                             + juce::String (juce::roundToInt (blockSize * 1.0e6 / sampleRate)) + " us), "
+                             + juce::String (seconds, 1) + " s per scene");
+
+    for (const auto& count : objectCounts)
+    {
+        const auto numObjects = count.getIntValue();
+
+        if (numObjects < 1 || numObjects > MultiObjectRenderer::maxObjects)
+            juce::ConsoleApplication::fail ("Object counts have to be 1.." + juce::String (MultiObjectRenderer::maxObjects));
+
+        for (auto mode : { MultiObjectRenderer::Direct, MultiObjectRenderer::Ambisonic })
+            runScene (numObjects, mode, sampleRate, blockSize, seconds);
+    }
+}
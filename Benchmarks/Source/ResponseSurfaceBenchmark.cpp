@@ -0,0 +1,415 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/DistanceProcessor.h"
+#include <array>
+#include <cstring>
+#include <vector>
+
+//==============================================================================
+// The response surface that was measured against the live source stages and
+// declined: a (distance, azimuth, height) grid of 64-tap minimum-phase FIRs
+// per ear, blended trilinearly per block. It only lives here, so the decision
+// can be rerun; the plugin renders every source with the live stages.
+namespace
+{
+    constexpr int numDistances = 12;   // uniform in sqrt(distance / max distance)
+    constexpr int numAzimuths = 25;    // -180..180 degrees, both ends included
+    constexpr int numHeights = 5;      // 0..100 %
+    constexpr int numPoints = numDistances * numAzimuths * numHeights;
+    constexpr int numEars = 2;
+    constexpr int firLength = 64;
+    constexpr int cepstrumOrder = 11;
+    constexpr int measureLength = 1024;         // samples of each measured response
+    constexpr float nearestDistanceRoot = 0.1f; // sqrt of the nearest distance factor
+    constexpr float maxDistance = 20.0f;
+
+    float getGridDistance (int index) noexcept
+    {
+        const float root = nearestDistanceRoot + (1.0f - nearestDistanceRoot) * (float) index / (float) (numDistances - 1);
+        return root * root;
+    }
+
+    float getGridAzimuth (int index) noexcept   { return -180.0f + 360.0f * (float) index / (float) (numAzimuths - 1); }
+    float getGridHeight (int index) noexcept    { return (float) index / (float) (numHeights - 1); }
+
+    int pointIndex (int d, int a, int h) noexcept { return (d * numAzimuths + a) * numHeights + h; }
+
+    //==============================================================================
+    class ResponseSurface
+    {
+    public:
+        ResponseSurface()
+            : fft (cepstrumOrder),
+              firs ((size_t) (numPoints * numEars * firLength), 0.0f),
+              spectrum ((size_t) 1 << cepstrumOrder),
+              cepstrum ((size_t) 1 << cepstrumOrder)
+        {
+        }
+
+        size_t getAllocatedBytes() const noexcept { return firs.size() * sizeof (float); }
+
+        void setPoint (int point, const float* leftResponse, const float* rightResponse, int length)
+        {
+            makeMinimumPhase (leftResponse,  length, firs.data() + (size_t) (point * numEars) * firLength);
+            makeMinimumPhase (rightResponse, length, firs.data() + (size_t) (point * numEars + 1) * firLength);
+        }
+
+        void interpolate (float distanceFactor, float azimuthDeg, float heightPercent, float* leftFir, float* rightFir) const noexcept
+        {
+            const auto cell = [] (float position, int count, int& index, float& weight)
+            {
+                position = juce::jlimit (0.0f, (float) (count - 1), position);
+                index = juce::jmin ((int) position, count - 2);
+                weight = position - (float) index;
+            };
+
+            const float root = std::sqrt (juce::jlimit (0.0f, 1.0f, distanceFactor));
+
+            int d, a, h;
+            float wd, wa, wh;
+            cell ((root - nearestDistanceRoot) / (1.0f - nearestDistanceRoot) * (numDistances - 1), numDistances, d, wd);
+            cell ((azimuthDeg + 180.0f) / 360.0f * (numAzimuths - 1), numAzimuths, a, wa);
+            cell (heightPercent * (numHeights - 1), numHeights, h, wh);
+
+            juce::FloatVectorOperations::clear (leftFir, firLength);
+            juce::FloatVectorOperations::clear (rightFir, firLength);
+
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                const int dd = corner & 1, aa = (corner >> 1) & 1, hh = corner >> 2;
+                const float weight = (dd ? wd : 1.0f - wd) * (aa ? wa : 1.0f - wa) * (hh ? wh : 1.0f - wh);
+
+                if (weight <= 0.0f)
+                    continue;
+
+                const float* fir = firs.data() + (size_t) (pointIndex (d + dd, a + aa, h + hh) * numEars) * firLength;
+                juce::FloatVectorOperations::addWithMultiply (leftFir, fir, weight, firLength);
+                juce::FloatVectorOperations::addWithMultiply (rightFir, fir + firLength, weight, firLength);
+            }
+        }
+
+    private:
+        // Homomorphic method: fold the real cepstrum of the magnitude onto
+        // positive quefrencies, so neighbouring points blend without combing
+        void makeMinimumPhase (const float* response, int length, float* destination)
+        {
+            const int size = 1 << cepstrumOrder;
+            length = juce::jmin (length, size / 2);
+
+            for (int n = 0; n < size; ++n)
+                spectrum[(size_t) n] = { n < length ? response[n] : 0.0f, 0.0f };
+
+            fft.perform (spectrum.data(), cepstrum.data(), false);
+
+            for (auto& bin : cepstrum)
+                bin = { std::log (juce::jmax (std::abs (bin), 1.0e-9f)), 0.0f };
+
+            fft.perform (cepstrum.data(), spectrum.data(), true);
+
+            for (int n = 0; n < size; ++n)
+            {
+                const float fold = (n == 0 || n == size / 2) ? 1.0f : (n < size / 2 ? 2.0f : 0.0f);
+                spectrum[(size_t) n] = { spectrum[(size_t) n].real() * fold, 0.0f };
+            }
+
+            fft.perform (spectrum.data(), cepstrum.data(), false);
+
+            for (auto& bin : cepstrum)
+                bin = std::exp (bin);
+
+            fft.perform (cepstrum.data(), spectrum.data(), true);
+
+            for (int n = 0; n < firLength; ++n)
+                destination[n] = spectrum[(size_t) n].real();
+        }
+
+        juce::dsp::FFT fft;
+        std::vector<float> firs;    // [point][ear], firLength taps each
+        std::vector<juce::dsp::Complex<float>> spectrum, cepstrum;
+
+        JUCE_DECLARE_NON_COPYABLE (ResponseSurface)
+    };
+
+    //==============================================================================
+    // Filters a mono source into two ears with the FIR pair blended for the
+    // current position, crossfading from the previous pair across the block
+    class ResponseSurfaceFilter
+    {
+    public:
+        explicit ResponseSurfaceFilter (int blockSize)
+            : maxBlockSize (blockSize), history (1, historyOffset + blockSize), fadeBuffer (1, blockSize)
+        {
+            history.clear();
+        }
+
+        void process (const ResponseSurface& surface, const float* input, float* left, float* right, int numSamples,
+                      float distanceFactor, float azimuthDeg, float heightPercent) noexcept
+        {
+            surface.interpolate (distanceFactor, azimuthDeg, heightPercent, current[0].data(), current[1].data());
+
+            const bool crossfade = hasPrevious && previous != current;
+            float* hist = history.getWritePointer (0);
+
+            for (int start = 0; start < numSamples; start += maxBlockSize)
+            {
+                const int chunk = juce::jmin (maxBlockSize, numSamples - start);
+                juce::FloatVectorOperations::copy (hist + historyOffset, input + start, chunk);
+
+                for (int ear = 0; ear < numEars; ++ear)
+                {
+                    float* out = (ear == 0 ? left : right) + start;
+                    juce::FloatVectorOperations::clear (out, chunk);
+                    runFir (current[(size_t) ear].data(), out, chunk);
+
+                    if (crossfade)
+                    {
+                        float* faded = fadeBuffer.getWritePointer (0);
+                        juce::FloatVectorOperations::clear (faded, chunk);
+                        runFir (previous[(size_t) ear].data(), faded, chunk);
+
+                        const float rampStep = 1.0f / (float) numSamples;
+                        for (int n = 0; n < chunk; ++n)
+                            out[n] = faded[n] + (out[n] - faded[n]) * (float) (start + n) * rampStep;
+                    }
+                }
+
+                std::memmove (hist, hist + chunk, sizeof (float) * (size_t) historyOffset);
+            }
+
+            previous = current;
+            hasPrevious = true;
+        }
+
+    private:
+        void runFir (const float* fir, float* out, int numSamples) const noexcept
+        {
+            const float* hist = history.getReadPointer (0);
+
+            for (int k = 0; k < firLength; ++k)
+                juce::FloatVectorOperations::addWithMultiply (out, hist + historyOffset - k, fir[k], numSamples);
+        }
+
+        static constexpr int historyOffset = firLength - 1;
+
+        int maxBlockSize;
+        juce::AudioBuffer<float> history;    // firLength - 1 past samples, then the current block
+        juce::AudioBuffer<float> fadeBuffer;
+        std::array<std::array<float, firLength>, numEars> current {}, previous {};
+        bool hasPrevious = false;
+
+        JUCE_DECLARE_NON_COPYABLE (ResponseSurfaceFilter)
+    };
+
+    //==============================================================================
+    // The plugin built the grid from the private source stages; here it goes
+    // through processBlock with the distance delay off, so each response also
+    // carries the ITD, the reflections and the HRTF stage. Those only change
+    // what the taps hold, not what the grid costs to build, store or render
+    struct BuildResult
+    {
+        double measureSeconds = 0.0;
+        double minimumPhaseSeconds = 0.0;
+        juce::int64 measuringProcessorBytes = 0;
+    };
+
+    BuildResult buildSurface (ResponseSurface& surface, double sampleRate, int blockSize)
+    {
+        BuildResult result;
+
+        const auto bytesBefore = AllocationCounter::getBytes();
+        std::unique_ptr<DistanceProcessor> chain;
+
+        {
+            AllocationCounter::ScopedCount counting;
+            chain = std::make_unique<DistanceProcessor>();
+            chain->setMonoInput (true);
+            chain->trueDelayEnabled = false;
+            chain->setMaxDistance (maxDistance);
+            chain->prepare (sampleRate, blockSize);
+        }
+
+        result.measuringProcessorBytes = AllocationCounter::getBytes() - bytesBefore;
+
+        juce::AudioBuffer<float> block (2, blockSize);
+        juce::AudioBuffer<float> response (numEars, measureLength);
+
+        // Long enough for the slowest smoother (50 ms) and the previous point's tail
+        const auto settleBlocks = juce::jmax (1, (int) std::ceil (0.1 * sampleRate / blockSize));
+        juce::int64 measureTicks = 0, minimumPhaseTicks = 0;
+
+        for (int d = 0; d < numDistances; ++d)
+            for (int a = 0; a < numAzimuths; ++a)
+                for (int h = 0; h < numHeights; ++h)
+                {
+                    const auto distance = getGridDistance (d) * maxDistance;
+                    const auto azimuth = getGridAzimuth (a);
+                    const auto start = juce::Time::getHighResolutionTicks();
+
+                    chain->setSourceHeight (getGridHeight (h));
+
+                    for (int i = 0; i < settleBlocks; ++i)
+                    {
+                        block.clear();
+                        chain->processBlock (block, distance, azimuth, DistanceProcessor::Room);
+                    }
+
+                    for (int offset = 0; offset < measureLength; offset += blockSize)
+                    {
+                        block.clear();
+                        if (offset == 0)
+                            block.setSample (0, 0, 1.0f);
+
+                        chain->processBlock (block, distance, azimuth, DistanceProcessor::Room);
+
+                        const int count = juce::jmin (blockSize, measureLength - offset);
+                        for (int ear = 0; ear < numEars; ++ear)
+                            response.copyFrom (ear, offset, block, ear, 0, count);
+                    }
+
+                    const auto measured = juce::Time::getHighResolutionTicks();
+                    surface.setPoint (pointIndex (d, a, h), response.getReadPointer (0), response.getReadPointer (1), measureLength);
+
+                    measureTicks += measured - start;
+                    minimumPhaseTicks += juce::Time::getHighResolutionTicks() - measured;
+                }
+
+        result.measureSeconds = BenchmarkHelpers::ticksToMicros (measureTicks) * 1.0e-6;
+        result.minimumPhaseSeconds = BenchmarkHelpers::ticksToMicros (minimumPhaseTicks) * 1.0e-6;
+        return result;
+    }
+
+    //==============================================================================
+    // A mono source circling the listener while it moves in and out and up and down
+    struct Position
+    {
+        float distance, azimuth, height;
+    };
+
+    Position getPosition (int block, int blockSize, double sampleRate) noexcept
+    {
+        const auto seconds = (float) ((double) block * blockSize / sampleRate);
+
+        return { maxDistance * (0.55f + 0.4f * std::sin (0.7f * seconds)),
+                 std::fmod (seconds * 90.0f + 180.0f, 360.0f) - 180.0f,
+                 0.5f + 0.45f * std::sin (0.3f * seconds) };
+    }
+
+    // Height, gain, air, width and panning - the stages the surface stood in for
+    double measureLiveStages (double sampleRate, int blockSize, int numBlocks)
+    {
+        DistanceProcessor processor;
+        processor.setMonoInput (true);
+        processor.setMaxDistance (maxDistance);
+        processor.prepare (sampleRate, blockSize);
+
+        auto& profiler = processor.getStageProfiler();
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::Random random (38);
+
+        const auto warmUpBlocks = juce::jmax (1, (int) (sampleRate / blockSize));
+
+        for (int block = -warmUpBlocks; block < numBlocks; ++block)
+        {
+            if (block == 0)
+            {
+                profiler.setEnabled (true);
+                profiler.takeSnapshot();
+            }
+
+            const auto position = getPosition (block, blockSize, sampleRate);
+            processor.setSourceHeight (position.height);
+
+            BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+            processor.processBlock (buffer, position.distance, position.azimuth, DistanceProcessor::Room);
+        }
+
+        const auto snapshot = profiler.takeSnapshot();
+        double micros = 0.0;
+
+        for (auto stage : { StageProfiler::Height, StageProfiler::Gain, StageProfiler::Air,
+                            StageProfiler::Width, StageProfiler::Panning })
+            micros += snapshot.averageMicros[(size_t) stage];
+
+        return micros;
+    }
+
+    struct SurfaceResult
+    {
+        double microsPerBlock = 0.0;
+        juce::int64 allocations = 0;
+    };
+
+    SurfaceResult measureSurface (const ResponseSurface& surface, double sampleRate, int blockSize, int numBlocks)
+    {
+        ResponseSurfaceFilter filter (blockSize);
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::Random random (38);
+
+        const auto warmUpBlocks = juce::jmax (1, (int) (sampleRate / blockSize));
+        juce::int64 elapsedTicks = 0, allocationsBefore = 0;
+
+        for (int block = -warmUpBlocks; block < numBlocks; ++block)
+        {
+            if (block == 0)
+                allocationsBefore = AllocationCounter::getCount();
+
+            const auto position = getPosition (block, blockSize, sampleRate);
+            BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            {
+                AllocationCounter::ScopedCount counting;
+                filter.process (surface, buffer.getReadPointer (0), buffer.getWritePointer (0), buffer.getWritePointer (1),
+                                blockSize, position.distance / maxDistance, position.azimuth, position.height);
+            }
+
+            if (block >= 0)
+                elapsedTicks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        SurfaceResult result;
+        result.microsPerBlock = BenchmarkHelpers::ticksToMicros (elapsedTicks) / numBlocks;
+        result.allocations = AllocationCounter::getCount() - allocationsBefore;
+        return result;
+    }
+}
+
+//==============================================================================
+void runResponseSurfaceBenchmark (const juce::ArgumentList& args)
+{
+    const auto sampleRate = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto blockSize  = BenchmarkHelpers::getIntOption (args, "--block", 256);
+    const auto seconds    = BenchmarkHelpers::getDoubleOption (args, "--seconds", 10.0);
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || seconds <= 0.0)
+        juce::ConsoleApplication::fail ("--rate, --block and --seconds have to be positive");
+
+    const auto numBlocks = juce::jmax (1, (int) (seconds * sampleRate / blockSize));
+
+    BenchmarkHelpers::print ("Response surface against the live source stages, mono source, "
+                             + juce::String (blockSize) + " samples at " + juce::String (sampleRate, 0) + " Hz");
+
+    ResponseSurface surface;
+    const auto build = buildSurface (surface, sampleRate, blockSize);
+
+    BenchmarkHelpers::print ("surface:       " + juce::String (numPoints) + " points x " + juce::String (numEars) + " ears x "
+                             + juce::String (firLength) + " taps, "
+                             + juce::String ((double) surface.getAllocatedBytes() / (1024.0 * 1024.0), 2) + " MB");
+    BenchmarkHelpers::print ("build:         " + juce::String (build.measureSeconds + build.minimumPhaseSeconds, 2)
+                             + " s on one core (" + juce::String (build.measureSeconds, 2) + " s measuring, "
+                             + juce::String (build.minimumPhaseSeconds, 2) + " s minimum phase)");
+    BenchmarkHelpers::print ("measuring processor kept per instance: "
+                             + juce::String ((double) build.measuringProcessorBytes / (1024.0 * 1024.0), 2) + " MB");
+
+    const auto liveMicros = measureLiveStages (sampleRate, blockSize, numBlocks);
+    const auto surfaceResult = measureSurface (surface, sampleRate, blockSize, numBlocks);
+
+    BenchmarkHelpers::print ("live stages:   " + juce::String (liveMicros, 2) + " us per block");
+    BenchmarkHelpers::print ("surface:       " + juce::String (surfaceResult.microsPerBlock, 2) + " us per block, "
+                             + juce::String (liveMicros > 0.0 ? surfaceResult.microsPerBlock / liveMicros : 0.0, 2)
+                             + "x the live stages");
+
+    if (surfaceResult.allocations > 0)
+        juce::ConsoleApplication::fail ("The surface filter allocated " + juce::String (surfaceResult.allocations) + " times");
+}
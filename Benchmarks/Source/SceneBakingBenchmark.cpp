@@ -0,0 +1,367 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/DistanceProcessor.h"
+#include <memory>
+#include <vector>
+
+//==============================================================================
+// Static-scene baking, which was measured against the live chain and removed:
+// once a scene held still, the whole chain's impulse response was measured
+// and rendered by convolution instead. Only the benchmark keeps the
+// convolver, so the removal can be rerun.
+namespace
+{
+    constexpr int numOutputs = 2;
+    constexpr double maxTailSeconds = 0.25;    // after the first arrival
+
+    //==============================================================================
+    // 1-in/2-out convolution. The response's leading zeros, the propagation
+    // delay, become a plain delay on the input; the first headTaps taps run in
+    // direct form, vectorised across the block, and the rest in uniform FFT
+    // partitions of chunkSize, whose latency the head hides
+    class SceneConvolver
+    {
+    public:
+        SceneConvolver (const juce::AudioBuffer<float>& responses, int length, int lead, int headTaps, int chunkSize)
+            : leadSamples (lead),
+              directTaps (juce::jmin (length, headTaps)),
+              partitionSize (chunkSize)
+        {
+            directResponses.setSize (numOutputs, directTaps);
+
+            for (int out = 0; out < numOutputs; ++out)
+                directResponses.copyFrom (out, 0, responses, out, 0, directTaps);
+
+            directInput.setSize (1, directTaps - 1 + chunkSize);
+
+            const int tailLength = length - directTaps;
+
+            if (tailLength > 0)
+            {
+                const int size = partitionSize;
+                numPartitions = (tailLength + size - 1) / size;
+                spectrumSize = (size_t) (size + 1) * 2;
+
+                fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (size * 2)));
+                fftBuffer.assign ((size_t) size * 4, 0.0f);
+                accumulator.assign (spectrumSize, 0.0f);
+                filterSpectra.assign ((size_t) (numOutputs * numPartitions) * spectrumSize, 0.0f);
+
+                for (int out = 0; out < numOutputs; ++out)
+                {
+                    const float* tail = responses.getReadPointer (out, directTaps);
+
+                    for (int k = 0; k < numPartitions; ++k)
+                    {
+                        std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
+                        const int offset = k * size;
+                        std::copy (tail + offset, tail + juce::jmin (tailLength, offset + size), fftBuffer.begin());
+
+                        fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+                        std::copy (fftBuffer.begin(), fftBuffer.begin() + (std::ptrdiff_t) spectrumSize,
+                                   spectrum (filterSpectra, out * numPartitions + k));
+                    }
+                }
+
+                inputSpectra.assign ((size_t) numPartitions * spectrumSize, 0.0f);
+                outputBlock.setSize (numOutputs, size);
+                outputBlock.clear();
+            }
+
+            const int ringSize = juce::nextPowerOfTwo (lead + directTaps + 2 * chunkSize + 1);
+            inputRing.setSize (1, ringSize);
+            inputRing.clear();
+            ringMask = ringSize - 1;
+        }
+
+        int getDirectTaps() const noexcept      { return directTaps; }
+        int getNumPartitions() const noexcept   { return numPartitions; }
+
+        /** Reads channel 0 and writes both outputs. */
+        void process (juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+        {
+            for (int position = 0; position < numSamples;)
+            {
+                const int chunk = juce::jmin (numSamples - position, partitionSize - blockPosition);
+
+                // The input goes into the history before the outputs overwrite it
+                const float* input = buffer.getReadPointer (0, position);
+                float* ring = inputRing.getWritePointer (0);
+                const int first = juce::jmin (chunk, ringMask + 1 - ringWrite);
+
+                std::copy (input, input + first, ring + ringWrite);
+                std::copy (input + first, input + chunk, ring);
+                ringWrite = (ringWrite + chunk) & ringMask;
+
+                for (int out = 0; out < numOutputs; ++out)
+                {
+                    if (numPartitions > 0)
+                        buffer.copyFrom (out, position, outputBlock, out, blockPosition, chunk);
+                    else
+                        buffer.clear (out, position, chunk);
+                }
+
+                float* history = directInput.getWritePointer (0);
+                readDelayed (leadSamples + chunk + directTaps - 1, directTaps - 1 + chunk, history);
+
+                for (int out = 0; out < numOutputs; ++out)
+                {
+                    const float* h = directResponses.getReadPointer (out);
+                    float* output = buffer.getWritePointer (out, position);
+
+                    for (int k = 0; k < directTaps; ++k)
+                        if (h[k] != 0.0f)
+                            juce::FloatVectorOperations::addWithMultiply (output, history + directTaps - 1 - k, h[k], chunk);
+                }
+
+                blockPosition += chunk;
+                position += chunk;
+
+                if (blockPosition == partitionSize)
+                {
+                    if (numPartitions > 0)
+                        processPartition();
+
+                    blockPosition = 0;
+                }
+            }
+        }
+
+    private:
+        float* spectrum (std::vector<float>& data, int index) noexcept { return data.data() + (size_t) index * spectrumSize; }
+
+        void readDelayed (int delay, int numSamples, float* destination) const noexcept
+        {
+            const float* ring = inputRing.getReadPointer (0);
+            const int start = (ringWrite - delay) & ringMask;
+            const int first = juce::jmin (numSamples, ringMask + 1 - start);
+
+            std::copy (ring + start, ring + start + first, destination);
+            std::copy (ring, ring + numSamples - first, destination + first);
+        }
+
+        // Overlap-save: the last two partitions of the input as the tail hears
+        // it, one partition early to cover the transform's latency
+        void processPartition() noexcept
+        {
+            const int size = partitionSize;
+
+            readDelayed (leadSamples + directTaps + size, 2 * size, fftBuffer.data());
+            std::fill (fftBuffer.begin() + 2 * size, fftBuffer.end(), 0.0f);
+
+            fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+            std::copy (fftBuffer.begin(), fftBuffer.begin() + (std::ptrdiff_t) spectrumSize, spectrum (inputSpectra, currentSlot));
+
+            for (int out = 0; out < numOutputs; ++out)
+            {
+                std::fill (accumulator.begin(), accumulator.end(), 0.0f);
+                float* acc = accumulator.data();
+
+                for (int k = 0, slot = currentSlot; k < numPartitions; ++k, slot = (slot == 0 ? numPartitions : slot) - 1)
+                {
+                    const float* h = spectrum (filterSpectra, out * numPartitions + k);
+                    const float* x = spectrum (inputSpectra, slot);
+
+                    for (int b = 0; b <= size; ++b)
+                    {
+                        const float hr = h[2 * b], hi = h[2 * b + 1];
+                        const float xr = x[2 * b], xi = x[2 * b + 1];
+                        acc[2 * b]     += hr * xr - hi * xi;
+                        acc[2 * b + 1] += hr * xi + hi * xr;
+                    }
+                }
+
+                std::copy (accumulator.begin(), accumulator.end(), fftBuffer.begin());
+                std::fill (fftBuffer.begin() + (std::ptrdiff_t) spectrumSize, fftBuffer.end(), 0.0f);
+                fft->performRealOnlyInverseTransform (fftBuffer.data());
+
+                // The first half wrapped around; the second is the linear result
+                std::copy (fftBuffer.begin() + size, fftBuffer.begin() + 2 * size, outputBlock.getWritePointer (out));
+            }
+
+            currentSlot = (currentSlot + 1) % numPartitions;
+        }
+
+        int leadSamples;
+        int directTaps;
+        int partitionSize;
+        int numPartitions = 0;
+        size_t spectrumSize = 0;    // interleaved re/im, partitionSize + 1 bins
+
+        juce::AudioBuffer<float> directResponses, directInput;
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> filterSpectra, inputSpectra, fftBuffer, accumulator;
+        juce::AudioBuffer<float> outputBlock;
+        int currentSlot = 0, blockPosition = 0;
+
+        juce::AudioBuffer<float> inputRing;
+        int ringMask = 0, ringWrite = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (SceneConvolver)
+    };
+
+    //==============================================================================
+    struct Scene
+    {
+        const char* name;
+        DistanceProcessor::Environment environment;
+        float distance, pan;
+    };
+
+    std::unique_ptr<DistanceProcessor> makeProcessor (const Scene& scene, double sampleRate, int blockSize)
+    {
+        auto processor = std::make_unique<DistanceProcessor>();
+        processor->setMonoInput (true);
+        processor->setEnvironmentType (scene.environment);
+        processor->prepare (sampleRate, blockSize);
+        return processor;
+    }
+
+    struct Response
+    {
+        juce::AudioBuffer<float> taps;
+        int length = 0, lead = 0;
+    };
+
+    // The plugin measured a copy of the live chain with its smoothers snapped;
+    // here the chain settles on silence for half a second instead, then takes
+    // an impulse. The lead is stripped at -120 dB and the tail cut at -80 dB
+    Response measureResponse (const Scene& scene, double sampleRate, int blockSize)
+    {
+        auto processor = makeProcessor (scene, sampleRate, blockSize);
+        juce::AudioBuffer<float> block (2, blockSize);
+
+        for (int i = 0; i < (int) std::ceil (0.5 * sampleRate / blockSize); ++i)
+        {
+            block.clear();
+            processor->processBlock (block, scene.distance, scene.pan, scene.environment);
+        }
+
+        const int captureLength = (int) std::ceil ((scene.distance / processor->speedOfSound + 0.01 + maxTailSeconds) * sampleRate);
+        juce::AudioBuffer<float> captured (numOutputs, captureLength);
+
+        for (int offset = 0; offset < captureLength; offset += blockSize)
+        {
+            block.clear();
+            if (offset == 0)
+                block.setSample (0, 0, 1.0f);
+
+            processor->processBlock (block, scene.distance, scene.pan, scene.environment);
+
+            const int count = juce::jmin (blockSize, captureLength - offset);
+            for (int out = 0; out < numOutputs; ++out)
+                captured.copyFrom (out, offset, block, out, 0, count);
+        }
+
+        float peak = 0.0f;
+        for (int out = 0; out < numOutputs; ++out)
+            peak = juce::jmax (peak, captured.getMagnitude (out, 0, captureLength));
+
+        int first = captureLength, last = -1;
+
+        for (int out = 0; out < numOutputs; ++out)
+        {
+            const float* data = captured.getReadPointer (out);
+
+            for (int n = 0; n < captureLength; ++n)
+                if (std::abs (data[n]) > peak * 1.0e-6f) { first = juce::jmin (first, n); break; }
+
+            for (int n = captureLength; --n >= 0;)
+                if (std::abs (data[n]) > peak * 1.0e-4f) { last = juce::jmax (last, n); break; }
+        }
+
+        Response response;
+
+        if (peak <= 0.0f || last < first)
+            return response;
+
+        response.lead = first;
+        response.length = juce::jmin (last + 1 - first, (int) std::ceil (maxTailSeconds * sampleRate));
+        response.taps.setSize (numOutputs, response.length);
+
+        for (int out = 0; out < numOutputs; ++out)
+            response.taps.copyFrom (out, 0, captured, out, first, response.length);
+
+        return response;
+    }
+
+    // Mean rather than p50: the clock counts whole microseconds, which is
+    // coarser than the blocks being compared
+    template <typename RenderBlock>
+    double measureMean (RenderBlock&& render, double sampleRate, int blockSize, int numBlocks)
+    {
+        // The plugin renders either way with denormals flushed
+        juce::ScopedNoDenormals noDenormals;
+
+        TimingHistogram timings ((size_t) numBlocks);
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::Random random (37);
+
+        const auto warmUpBlocks = juce::jmax (1, (int) (sampleRate / blockSize));
+
+        for (int block = -warmUpBlocks; block < numBlocks; ++block)
+        {
+            BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            render (buffer);
+
+            if (block >= 0)
+                timings.add (BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+        }
+
+        return timings.getMean();
+    }
+}
+
+//==============================================================================
+void runSceneBakingBenchmark (const juce::ArgumentList& args)
+{
+    const auto sampleRate = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto blockSize  = BenchmarkHelpers::getIntOption (args, "--block", 128);
+    const auto seconds    = BenchmarkHelpers::getDoubleOption (args, "--seconds", 5.0);
+    const auto headTaps   = BenchmarkHelpers::getIntOption (args, "--head", 128);
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || seconds <= 0.0 || headTaps <= 0)
+        juce::ConsoleApplication::fail ("--rate, --block, --seconds and --head have to be positive");
+
+    const auto numBlocks = juce::jmax (1, (int) (seconds * sampleRate / blockSize));
+    // The head has to cover one partition of transform latency
+    auto partitionSize = juce::nextPowerOfTwo (blockSize);
+    while (partitionSize > headTaps)
+        partitionSize /= 2;
+
+    BenchmarkHelpers::print ("Baked static scene against the live chain, mono source, " + juce::String (blockSize)
+                             + " samples at " + juce::String (sampleRate, 0) + " Hz, " + juce::String (headTaps)
+                             + "-tap head, " + juce::String (partitionSize) + "-sample partitions, mean per block");
+    BenchmarkHelpers::print ("scene           taps   partitions  live us  baked us  baked / live");
+
+    const Scene scenes[] = { { "near, room",  DistanceProcessor::Room,  2.0f,  30.0f },
+                             { "mid, room",   DistanceProcessor::Room,  10.0f, -60.0f },
+                             { "far, hall",   DistanceProcessor::Hall,  45.0f, 20.0f },
+                             { "cave",        DistanceProcessor::Cave,  20.0f, 90.0f } };
+
+    for (const auto& scene : scenes)
+    {
+        const auto response = measureResponse (scene, sampleRate, blockSize);
+
+        if (response.length == 0)
+            juce::ConsoleApplication::fail (juce::String ("No response measured for ") + scene.name);
+
+        auto live = makeProcessor (scene, sampleRate, blockSize);
+        const auto liveMicros = measureMean ([&] (juce::AudioBuffer<float>& buffer)
+                                               { live->processBlock (buffer, scene.distance, scene.pan, scene.environment); },
+                                               sampleRate, blockSize, numBlocks);
+
+        SceneConvolver baked (response.taps, response.length, response.lead, headTaps, partitionSize);
+        const auto bakedMicros = measureMean ([&] (juce::AudioBuffer<float>& buffer) { baked.process (buffer, blockSize); },
+                                                sampleRate, blockSize, numBlocks);
+
+        BenchmarkHelpers::print (juce::String (scene.name).paddedRight (' ', 16)
+                                 + juce::String (response.length).paddedRight (' ', 7)
+                                 + juce::String (baked.getNumPartitions()).paddedRight (' ', 12)
+                                 + juce::String (liveMicros, 2).paddedRight (' ', 9)
+                                 + juce::String (bakedMicros, 2).paddedRight (' ', 10)
+                                 + juce::String (liveMicros > 0.0 ? bakedMicros / liveMicros : 0.0, 2) + "x");
+    }
+}
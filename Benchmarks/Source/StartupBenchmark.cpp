@@ -0,0 +1,162 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/BackgroundWorkerPool.h"
+
+//==============================================================================
+namespace
+{
+    struct Phase
+    {
+        explicit Phase (size_t numInstances) : times (numInstances) {}
+
+        TimingHistogram times;
+        juce::int64 allocations = 0;
+    };
+
+    // Times one call per instance, counting what it allocates on this thread
+    template <typename Callback>
+    void measure (Phase& phase, std::vector<std::unique_ptr<SOFARAudioProcessor>>& processors, Callback&& callback)
+    {
+        for (auto& processor : processors)
+        {
+            const auto allocationsBefore = AllocationCounter::getCount();
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            {
+                AllocationCounter::ScopedCount counting;
+                callback (*processor);
+            }
+
+            phase.times.add (BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+            phase.allocations += AllocationCounter::getCount() - allocationsBefore;
+        }
+    }
+
+    // Until the work queued by prepare has been picked up and the pool has gone quiet
+    double waitForBackgroundWork (BackgroundWorkerPool& pool, juce::int64& runs)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        const auto timeout = start + 10 * juce::Time::getHighResolutionTicksPerSecond();
+        auto lastRuns = (juce::int64) -1;
+
+        for (;;)
+        {
+            const auto metrics = pool.getMetrics();
+
+            if ((metrics.queueDepth == 0 && metrics.runs == lastRuns) || juce::Time::getHighResolutionTicks() > timeout)
+            {
+                runs = metrics.runs;
+                break;
+            }
+
+            lastRuns = metrics.runs;
+            juce::MessageManager::getInstance()->runDispatchLoopUntil (2);
+        }
+
+        return BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start) / 1000.0;
+    }
+}
+
+//==============================================================================
+void runStartupBenchmark (const juce::ArgumentList& args)
+{
+    const auto numInstances = BenchmarkHelpers::getIntOption (args, "--instances", 100);
+    const auto sampleRate   = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto blockSize    = BenchmarkHelpers::getIntOption (args, "--block", 128);
+
+    if (numInstances < 1 || numInstances > 256)
+        juce::ConsoleApplication::fail ("--instances has to be 1..256");
+
+    if (sampleRate <= 0.0 || blockSize <= 0)
+        juce::ConsoleApplication::fail ("--rate and --block have to be positive");
+
+    juce::SharedResourcePointer<BackgroundWorkerPool> pool;
+    pool->resetMetrics();
+
+    const auto size = (size_t) numInstances;
+    Phase construction (size), preparation (size), firstBlock (size), secondBlock (size), rePreparation (size);
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add (juce::AudioChannelSet::stereo());
+    layout.outputBuses.add (juce::AudioChannelSet::stereo());
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random (3);
+
+    // A session load: every plugin is constructed, then every one prepared,
+    // then the transport starts
+    std::vector<std::unique_ptr<SOFARAudioProcessor>> processors (size);
+    const auto sessionStart = juce::Time::getHighResolutionTicks();
+
+    for (auto& processor : processors)
+    {
+        const auto allocationsBefore = AllocationCounter::getCount();
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        {
+            AllocationCounter::ScopedCount counting;
+            processor = std::make_unique<SOFARAudioProcessor>();
+        }
+
+        construction.times.add (BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+        construction.allocations += AllocationCounter::getCount() - allocationsBefore;
+    }
+
+    measure (preparation, processors, [&] (SOFARAudioProcessor& processor)
+    {
+        BenchmarkHelpers::prepareLikeHost (processor, layout, sampleRate, blockSize);
+    });
+
+    const auto sessionMs = BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - sessionStart) / 1000.0;
+
+    auto renderBlock = [&] (SOFARAudioProcessor& processor)
+    {
+        BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+        processor.processBlock (buffer, midi);
+    };
+
+    // Straight after prepare, before the background pool has caught up
+    measure (firstBlock, processors, renderBlock);
+
+    juce::int64 backgroundRuns = 0;
+    const auto backgroundMs = waitForBackgroundWork (*pool, backgroundRuns);
+
+    measure (secondBlock, processors, renderBlock);
+
+    // A sample-rate or buffer-size change in the host's audio settings
+    measure (rePreparation, processors, [&] (SOFARAudioProcessor& processor)
+    {
+        processor.releaseResources();
+        processor.prepareToPlay (sampleRate, blockSize);
+    });
+
+    for (auto& processor : processors)
+        processor->releaseResources();
+
+    BenchmarkHelpers::print ("Startup, " + juce::String (numInstances) + (numInstances == 1 ? " instance, " : " instances, ")
+                             + juce::String (blockSize) + " samples at " + juce::String (juce::roundToInt (sampleRate)) + " Hz");
+
+    auto report = [&] (const char* name, const Phase& phase)
+    {
+        BenchmarkHelpers::print (juce::String (name).paddedRight (' ', 14) + phase.times.describe()
+                                 + "  mean " + juce::String (phase.times.getMean(), 1) + " us"
+                                 + "  " + juce::String (phase.allocations / numInstances) + " allocations/instance");
+    };
+
+    report ("constructor", construction);
+    report ("prepareToPlay", preparation);
+    report ("first block", firstBlock);
+    report ("settled block", secondBlock);
+    report ("re-prepare", rePreparation);
+
+    BenchmarkHelpers::print ("session load  " + juce::String (sessionMs, 1) + " ms to construct and prepare every instance");
+    BenchmarkHelpers::print ("background    " + juce::String (backgroundMs, 1) + " ms after the first blocks until the pool was idle, "
+                             + juce::String (backgroundRuns) + " runs");
+
+    // The audio path has to be valid, and real-time safe, from the very first block
+    if (firstBlock.allocations > 0 || secondBlock.allocations > 0)
+        juce::ConsoleApplication::fail (juce::String (firstBlock.allocations + secondBlock.allocations)
+                                        + " allocations in processBlock");
+}
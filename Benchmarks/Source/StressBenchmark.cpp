@@ -0,0 +1,225 @@
+#include "Benchmarks.h"
+#include "BenchmarkTools.h"
+#include "../../Source/DistanceProcessor.h"
+
+//==============================================================================
+namespace
+{
+    // Each phase targets one hazard: coefficient bursts from fast pans, the
+    // room model rebuilding on size jumps, impulse responses reloading on
+    // environment switches and the heavy path switching around 30 m
+    enum Phase
+    {
+        PanSweep = 0,
+        RearFlip,
+        RoomJumps,
+        EnvironmentSwitch,
+        ThirtyMetreCrossing,
+        HeightFlip,
+        numPhases
+    };
+
+    const char* const phaseNames[numPhases] = { "pan sweep", "rear flip", "room jumps",
+                                                "env switch", "30 m crossing", "height flip" };
+
+    struct Automation
+    {
+        float distance = 5.0f, pan = 0.0f;
+        float roomLength = 8.0f, roomWidth = 6.0f, roomHeight = 3.0f;
+        float airAbsorption = 0.5f;
+        float presetMaxDistance = 0.0f;     // while an environment preset is in force
+        DistanceProcessor::Environment environment = DistanceProcessor::Room;
+    };
+
+    void automate (DistanceProcessor& processor, Automation& state, Phase phase, int block, float seconds, juce::Random& random)
+    {
+        // 0 to 360 degrees twice a second
+        const auto sweep = std::fmod (seconds * 720.0f, 360.0f) - 180.0f;
+        state.distance = 5.0f;
+
+        if (phase != EnvironmentSwitch)
+        {
+            state.airAbsorption = 0.5f;
+            state.presetMaxDistance = 0.0f;
+        }
+
+        switch (phase)
+        {
+            case PanSweep:
+                state.pan = sweep;
+                break;
+
+            case RearFlip:
+                state.pan = (block & 1) != 0 ? 179.0f : -179.0f;
+                break;
+
+            case RoomJumps:
+                if (block % 8 == 0)
+                {
+                    state.roomLength = 2.0f + 98.0f * random.nextFloat();
+                    state.roomWidth  = 2.0f + 98.0f * random.nextFloat();
+                    state.roomHeight = 2.0f + 28.0f * random.nextFloat();
+                }
+
+                state.pan = 30.0f;
+                break;
+
+            case EnvironmentSwitch:
+                if (block % 16 == 0)
+                {
+                    // The preset's room replaces the automated one below, so the room model rebuilds
+                    state.environment = (DistanceProcessor::Environment) random.nextInt (DistanceProcessor::numEnvironments);
+                    processor.setEnvironmentType (state.environment);
+
+                    const auto preset = DistanceProcessor::getEnvironmentPreset (state.environment);
+                    state.roomLength = preset.length;
+                    state.roomWidth  = preset.width;
+                    state.roomHeight = preset.height;
+                    state.airAbsorption = preset.airAbsorption;
+                    state.presetMaxDistance = preset.maxDistance;
+                }
+
+                state.pan = -60.0f;
+                break;
+
+            case ThirtyMetreCrossing:
+                // The effective distance alternates either side of 30 m every block
+                state.roomLength = 40.0f;
+                state.roomWidth = 30.0f;
+                state.distance = (block & 1) != 0 ? 14.0f : 18.0f;
+                state.pan = 120.0f;
+                break;
+
+            case HeightFlip:
+                processor.setSourceHeight ((block & 1) != 0 ? 0.0f : 1.0f);
+                state.pan = sweep;
+                break;
+
+            case numPhases:
+            default:
+                jassertfalse;
+                break;
+        }
+
+        // As the plugin does: the range follows the room along the pan direction,
+        // unless a preset has set its own
+        const auto lateral = std::abs (std::sin (juce::degreesToRadians (state.pan)));
+        const auto maxDistance = state.presetMaxDistance > 0.0f
+                                     ? state.presetMaxDistance
+                                     : juce::jmax (2.0f, state.roomLength + lateral * (state.roomWidth - state.roomLength));
+
+        processor.setMaxDistance (maxDistance);
+        processor.setRoomWidth (state.roomWidth);
+        processor.setRoomHeight (state.roomHeight);
+        processor.setRoomLength (state.roomLength);
+        processor.setAirAbsorption (state.airAbsorption);
+        processor.setTemperature (20.0f);
+
+        state.distance = juce::jmin (state.distance, maxDistance);
+        processor.setDistance (state.distance);
+    }
+}
+
+//==============================================================================
+void runStressBenchmark (const juce::ArgumentList& args)
+{
+    const auto sampleRate      = BenchmarkHelpers::getDoubleOption (args, "--rate", 48000.0);
+    const auto blockSize       = BenchmarkHelpers::getIntOption (args, "--block", 128);
+    const auto phaseSeconds    = BenchmarkHelpers::getDoubleOption (args, "--phase-seconds", 5.0);
+    const auto rounds          = BenchmarkHelpers::getIntOption (args, "--rounds", 1);
+    const auto budgetP99       = BenchmarkHelpers::getDoubleOption (args, "--budget-p99", 50.0);
+    const auto budgetP999      = BenchmarkHelpers::getDoubleOption (args, "--budget-p999", 75.0);
+    const auto budgetMax       = BenchmarkHelpers::getDoubleOption (args, "--budget-max", 100.0);
+    const auto monoInput       = args.containsOption ("--mono");
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || phaseSeconds <= 0.0 || rounds <= 0)
+        juce::ConsoleApplication::fail ("--rate, --block, --phase-seconds and --rounds have to be positive");
+
+    const auto deadline = blockSize * 1.0e6 / sampleRate;
+    const auto blocksPerPhase = juce::jmax (1, (int) (phaseSeconds * sampleRate / blockSize));
+    const auto numBlocks = blocksPerPhase * numPhases * rounds;
+    const auto warmUpBlocks = juce::jmax (1, (int) (sampleRate / blockSize));
+
+    DistanceProcessor processor;
+    processor.prepare (sampleRate, blockSize);
+    processor.setMonoInput (monoInput);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::Random random (7);
+    Automation state;
+
+    TimingHistogram overall ((size_t) numBlocks);
+    std::vector<std::unique_ptr<TimingHistogram>> perPhase;
+
+    for (int i = 0; i < numPhases; ++i)
+        perPhase.push_back (std::make_unique<TimingHistogram> ((size_t) (blocksPerPhase * rounds)));
+
+    juce::int64 allocationsBefore = 0;
+
+    for (int block = -warmUpBlocks; block < numBlocks; ++block)
+    {
+        if (block == 0)
+            allocationsBefore = AllocationCounter::getCount();
+
+        // Warm-up runs the first phase; the measured run cycles through them all
+        const auto phase = (Phase) (block < 0 ? 0 : (block / blocksPerPhase) % numPhases);
+        const auto seconds = (float) ((double) block * blockSize / sampleRate);
+
+        automate (processor, state, phase, block, seconds, random);
+        BenchmarkHelpers::fillWithNoise (buffer, blockSize, random);
+
+        if (monoInput)
+            buffer.clear (1, 0, blockSize);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        {
+            AllocationCounter::ScopedCount counting;
+            processor.processBlock (buffer, state.distance, state.pan, state.environment);
+        }
+
+        const auto elapsed = BenchmarkHelpers::ticksToMicros (juce::Time::getHighResolutionTicks() - start);
+
+        if (block >= 0)
+        {
+            overall.add (elapsed);
+            perPhase[(size_t) phase]->add (elapsed);
+        }
+    }
+
+    const auto allocations = AllocationCounter::getCount() - allocationsBefore;
+
+    BenchmarkHelpers::print ("DistanceProcessor under adversarial automation, " + juce::String (blockSize) + " samples at "
+                             + juce::String (juce::roundToInt (sampleRate)) + " Hz (deadline " + juce::String (juce::roundToInt (deadline)) + " us), "
+                             + (monoInput ? "mono" : "stereo") + " input");
+
+    for (int i = 0; i < numPhases; ++i)
+        BenchmarkHelpers::print (juce::String (phaseNames[i]).paddedRight (' ', 14) + perPhase[(size_t) i]->describe());
+
+    BenchmarkHelpers::print (juce::String ("all").paddedRight (' ', 14) + overall.describe());
+    BenchmarkHelpers::print (juce::String (allocations) + " allocations in processBlock");
+
+    // Budgets are percentages of the block deadline
+    juce::StringArray overruns;
+
+    auto check = [&] (const juce::String& name, double measured, double budgetPercent)
+    {
+        const auto limit = deadline * budgetPercent / 100.0;
+
+        if (measured > limit)
+            overruns.add (name + " " + juce::String (measured, 1) + " us > " + juce::String (limit, 1)
+                          + " us (" + juce::String (budgetPercent, 1) + "% of the deadline)");
+    };
+
+    check ("p99", overall.getPercentile (0.99), budgetP99);
+    check ("p99.9", overall.getPercentile (0.999), budgetP999);
+    check ("max", overall.getMax(), budgetMax);
+
+    if (allocations > 0)
+        overruns.add (juce::String (allocations) + " allocations");
+
+    if (! overruns.isEmpty())
+        juce::ConsoleApplication::fail ("Over budget: " + overruns.joinIntoString ("; "));
+
+    BenchmarkHelpers::print ("Within budget");
+}
@@ -0,0 +1,244 @@
+#include "AmbisonicBinauralDecoder.h"
+#include <cmath>
+
+namespace
+{
+    // Virtual loudspeakers used to derive the SH-domain HRIR filters
+    constexpr int numVirtualSpeakers = 50;
+
+    /** Unweighted real ACN/SN3D spherical harmonics up to 3rd order. */
+    void computeSphericalHarmonics (float azimuthDeg, float elevationDeg, float* sh) noexcept
+    {
+        // SOFAR azimuth is clockwise, Ambisonics is counter-clockwise
+        const float phi   = juce::degreesToRadians (-azimuthDeg);
+        const float theta = juce::degreesToRadians (elevationDeg);
+
+        const float x = std::cos (theta) * std::cos (phi);
+        const float y = std::cos (theta) * std::sin (phi);
+        const float z = std::sin (theta);
+
+        const float sqrt3  = std::sqrt (3.0f);
+        const float sqrt15 = std::sqrt (15.0f);
+        const float sqrt58 = std::sqrt (5.0f / 8.0f);
+        const float sqrt38 = std::sqrt (3.0f / 8.0f);
+
+        sh[0]  = 1.0f;
+
+        sh[1]  = y;
+        sh[2]  = z;
+        sh[3]  = x;
+
+        sh[4]  = sqrt3 * x * y;
+        sh[5]  = sqrt3 * y * z;
+        sh[6]  = 0.5f * (3.0f * z * z - 1.0f);
+        sh[7]  = sqrt3 * x * z;
+        sh[8]  = 0.5f * sqrt3 * (x * x - y * y);
+
+        sh[9]  = sqrt58 * y * (3.0f * x * x - y * y);
+        sh[10] = sqrt15 * x * y * z;
+        sh[11] = sqrt38 * y * (5.0f * z * z - 1.0f);
+        sh[12] = 0.5f * z * (5.0f * z * z - 3.0f);
+        sh[13] = sqrt38 * x * (5.0f * z * z - 1.0f);
+        sh[14] = 0.5f * sqrt15 * z * (x * x - y * y);
+        sh[15] = sqrt58 * x * (x * x - 3.0f * y * y);
+    }
+
+    int degreeOfChannel (int acn) noexcept
+    {
+        return static_cast<int> (std::sqrt (static_cast<float> (acn)));
+    }
+
+    float maxReWeight (int degree, int order) noexcept
+    {
+        const float x = std::cos (juce::degreesToRadians (137.9f) / (static_cast<float> (order) + 1.51f));
+
+        switch (degree)
+        {
+            case 0:  return 1.0f;
+            case 1:  return x;
+            case 2:  return 0.5f * (3.0f * x * x - 1.0f);
+            case 3:  return 0.5f * (5.0f * x * x * x - 3.0f * x);
+            default: return 0.0f;
+        }
+    }
+}
+
+//==============================================================================
+void AmbisonicBinauralDecoder::computeEncodingGains (float azimuthDeg, float elevationDeg, int encodeOrder, float* gains) noexcept
+{
+    encodeOrder = juce::jlimit (1, maxOrder, encodeOrder);
+
+    float sh[maxChannels];
+    computeSphericalHarmonics (azimuthDeg, elevationDeg, sh);
+
+    for (int k = 0; k < getNumChannelsForOrder (encodeOrder); ++k)
+        gains[k] = sh[k] * maxReWeight (degreeOfChannel (k), encodeOrder);
+}
+
+//==============================================================================
+void AmbisonicBinauralDecoder::prepare (double newSampleRate, int samplesPerBlock)
+{
+    // The decode filters only depend on the sample rate, so a host re-preparing
+    // for a new block size keeps them
+    if (filterLength == 0 || newSampleRate != sampleRate)
+    {
+        sampleRate = newSampleRate;
+        hrirDatabase.setSampleRate (sampleRate);
+        buildFilters();
+    }
+
+    maxBlockSize = juce::jmax (1, samplesPerBlock);
+
+    history.setSize (maxChannels, filterLength - 1 + maxBlockSize);
+    midSide.setSize (2, maxBlockSize);
+    reset();
+}
+
+void AmbisonicBinauralDecoder::reset()
+{
+    history.clear();
+    midSide.clear();
+}
+
+void AmbisonicBinauralDecoder::buildFilters()
+{
+    std::array<std::vector<float>, maxChannels> left, right;
+    std::vector<float> hrirL, hrirR;
+
+    filterLength = 1;
+
+    // Fibonacci sphere - near-uniform sampling for a projection decoder
+    const float goldenAngle = juce::MathConstants<float>::pi * (3.0f - std::sqrt (5.0f));
+
+    for (int l = 0; l < numVirtualSpeakers; ++l)
+    {
+        const float z = 1.0f - 2.0f * (static_cast<float> (l) + 0.5f) / static_cast<float> (numVirtualSpeakers);
+        const float elevationDeg = juce::radiansToDegrees (std::asin (z));
+        const float azimuthDeg   = juce::radiansToDegrees (std::fmod (goldenAngle * static_cast<float> (l),
+                                                                     juce::MathConstants<float>::twoPi));
+
+        hrirDatabase.getHrir (azimuthDeg, elevationDeg, hrirL, hrirR);
+        filterLength = juce::jmax (filterLength, (int) hrirL.size(), (int) hrirR.size());
+
+        float sh[maxChannels];
+        computeSphericalHarmonics (azimuthDeg, elevationDeg, sh);
+
+        for (int k = 0; k < maxChannels; ++k)
+        {
+            // Sampling decoder for SN3D: (2n + 1) / L * Y_k
+            const float decodeGain = static_cast<float> (2 * degreeOfChannel (k) + 1) * sh[k]
+                                     / static_cast<float> (numVirtualSpeakers);
+
+            left[(size_t) k].resize ((size_t) filterLength, 0.0f);
+            right[(size_t) k].resize ((size_t) filterLength, 0.0f);
+
+            for (size_t t = 0; t < hrirL.size(); ++t) left[(size_t) k][t]  += decodeGain * hrirL[t];
+            for (size_t t = 0; t < hrirR.size(); ++t) right[(size_t) k][t] += decodeGain * hrirR[t];
+        }
+    }
+
+    // Convert to sparse mid/side taps so empty filters and zero taps cost nothing
+    for (int k = 0; k < maxChannels; ++k)
+    {
+        auto& mid  = midFilters[(size_t) k];
+        auto& side = sideFilters[(size_t) k];
+        mid.taps.clear();  mid.gains.clear();
+        side.taps.clear(); side.gains.clear();
+
+        left[(size_t) k].resize ((size_t) filterLength, 0.0f);
+        right[(size_t) k].resize ((size_t) filterLength, 0.0f);
+
+        for (int t = 0; t < filterLength; ++t)
+        {
+            const float l = left[(size_t) k][(size_t) t];
+            const float r = right[(size_t) k][(size_t) t];
+            const float m = 0.5f * (l + r);
+            const float s = 0.5f * (l - r);
+
+            if (std::abs (m) > 1.0e-6f) { mid.taps.push_back (t);  mid.gains.push_back (m); }
+            if (std::abs (s) > 1.0e-6f) { side.taps.push_back (t); side.gains.push_back (s); }
+        }
+    }
+}
+
+//==============================================================================
+void AmbisonicBinauralDecoder::process (juce::AudioBuffer<float>& shBed, juce::AudioBuffer<float>& output, int numSamples)
+{
+    jassert (numSamples <= maxBlockSize);
+    jassert (output.getNumChannels() >= 2);
+
+    const int numChannels = juce::jmin (getNumChannelsForOrder (order), shBed.getNumChannels());
+    const int historyOffset = filterLength - 1;
+
+    if (rotationDeg != 0.0f)
+        applyRotation (shBed, numSamples);
+
+    midSide.clear (0, numSamples);
+    float* mid  = midSide.getWritePointer (0);
+    float* side = midSide.getWritePointer (1);
+
+    for (int k = 0; k < maxChannels; ++k)
+    {
+        float* hist = history.getWritePointer (k);
+
+        if (k >= numChannels)
+        {
+            // Keep unused orders silent so raising the order later starts clean
+            juce::FloatVectorOperations::clear (hist, historyOffset);
+            continue;
+        }
+
+        juce::FloatVectorOperations::copy (hist + historyOffset, shBed.getReadPointer (k), numSamples);
+
+        runFilter (midFilters[(size_t) k],  hist, mid,  numSamples);
+        runFilter (sideFilters[(size_t) k], hist, side, numSamples);
+
+        // Shift the tail of this block to the front for the next call
+        std::memmove (hist, hist + numSamples, sizeof (float) * (size_t) historyOffset);
+    }
+
+    float* left  = output.getWritePointer (0);
+    float* right = output.getWritePointer (1);
+    juce::FloatVectorOperations::add (left, mid, side, numSamples);
+    juce::FloatVectorOperations::subtract (right, mid, side, numSamples);
+}
+
+void AmbisonicBinauralDecoder::runFilter (const SparseFilter& filter, const float* hist, float* out, int numSamples) const noexcept
+{
+    const int historyOffset = filterLength - 1;
+
+    for (size_t i = 0; i < filter.taps.size(); ++i)
+        juce::FloatVectorOperations::addWithMultiply (out, hist + historyOffset - filter.taps[i], filter.gains[i], numSamples);
+}
+
+void AmbisonicBinauralDecoder::applyRotation (juce::AudioBuffer<float>& shBed, int numSamples) const noexcept
+{
+    // Yaw only: each (m, -m) pair of a given degree rotates by m * yaw
+    const float yaw = juce::degreesToRadians (rotationDeg);
+
+    for (int n = 1; n <= order; ++n)
+    {
+        for (int m = 1; m <= n; ++m)
+        {
+            const int cosChannel = n * n + n + m;
+            const int sinChannel = n * n + n - m;
+
+            if (sinChannel >= shBed.getNumChannels() || cosChannel >= shBed.getNumChannels())
+                continue;
+
+            const float cm = std::cos (static_cast<float> (m) * yaw);
+            const float sm = std::sin (static_cast<float> (m) * yaw);
+
+            float* c = shBed.getWritePointer (cosChannel);
+            float* s = shBed.getWritePointer (sinChannel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float cValue = c[i];
+                const float sValue = s[i];
+                c[i] = cValue * cm + sValue * sm;
+                s[i] = sValue * cm - cValue * sm;
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "MySofaHRIR.h"
+
+//==============================================================================
+/**
+    Higher-order Ambisonics bus with a single binaural decoder
+    Sources are encoded into an ACN/SN3D sound field (up to 3rd order) with a
+    handful of spherical-harmonic gains, mixed in the SH domain, optionally
+    rotated, and decoded to headphones with one set of SH-domain HRIR filters.
+    HRTF cost therefore stays constant regardless of the number of sources.
+*/
+class AmbisonicBinauralDecoder
+{
+public:
+    //==============================================================================
+    static constexpr int maxOrder    = 3;
+    static constexpr int maxChannels = (maxOrder + 1) * (maxOrder + 1);
+
+    static constexpr int getNumChannelsForOrder (int order) noexcept { return (order + 1) * (order + 1); }
+
+    /** Real ACN/SN3D spherical harmonics for a direction in SOFAR convention
+        (azimuth 0° = front, 90° = right; elevation positive = up). Orders
+        above 'order' are left untouched. Max-rE weighting is applied per order. */
+    static void computeEncodingGains (float azimuthDeg, float elevationDeg, int order, float* gains) noexcept;
+
+    //==============================================================================
+    AmbisonicBinauralDecoder() = default;
+    ~AmbisonicBinauralDecoder() = default;
+
+    void prepare (double sampleRate, int samplesPerBlock);
+    void reset();
+
+    void setOrder (int newOrder) noexcept { order = juce::jlimit (1, maxOrder, newOrder); }
+    int getOrder() const noexcept { return order; }
+
+    /** Yaw rotation of the whole scene in degrees (positive = clockwise). */
+    void setSceneRotation (float yawDegrees) noexcept { rotationDeg = yawDegrees; }
+
+    /** Rotates the SH bed in place and decodes it into the two channels of 'output'
+        (which are overwritten). The bed must hold getNumChannelsForOrder (order) channels. */
+    void process (juce::AudioBuffer<float>& shBed, juce::AudioBuffer<float>& output, int numSamples);
+
+private:
+    //==============================================================================
+    struct SparseFilter
+    {
+        std::vector<int>   taps;
+        std::vector<float> gains;
+
+        bool isEmpty() const noexcept { return taps.empty(); }
+    };
+
+    void buildFilters();
+    void applyRotation (juce::AudioBuffer<float>& shBed, int numSamples) const noexcept;
+    void runFilter (const SparseFilter& filter, const float* history, float* out, int numSamples) const noexcept;
+
+    //==============================================================================
+    double sampleRate = 44100.0;
+    int maxBlockSize = 512;
+    int order = maxOrder;
+    float rotationDeg = 0.0f;
+
+    MySofaHrirDatabase hrirDatabase;
+    int filterLength = 0;
+
+    // Per SH channel: mid = (L + R) / 2, side = (L - R) / 2.
+    // For a left/right symmetric head one of the two is empty and skipped.
+    std::array<SparseFilter, maxChannels> midFilters;
+    std::array<SparseFilter, maxChannels> sideFilters;
+
+    juce::AudioBuffer<float> history; // per SH channel: filterLength - 1 samples of past input + block
+    juce::AudioBuffer<float> midSide;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AmbisonicBinauralDecoder)
+};
@@ -0,0 +1,287 @@
+#include "AtmosphericAbsorption.h"
+#include <cmath>
+
+namespace
+{
+    constexpr std::array<float, AtmosphericAbsorption::numBands> bandFrequencies
+        { 63.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f, 16000.0f };
+
+    // Each fidelity level: broadband gain matched at baseBand, then one shelf
+    // per anchor band, cornered between that anchor and the one below it
+    struct ShelfLayout
+    {
+        int numShelves;
+        int baseBand;
+        std::array<float, AtmosphericAbsorption::maxShelves> corners;
+        std::array<int, AtmosphericAbsorption::maxShelves> anchorBands;
+    };
+
+    constexpr ShelfLayout shelfLayouts[]
+    {
+        { 1, 4, { { 8000.0f, 0.0f, 0.0f } },          { { 8, 8, 8 } } },  // Fast: 1 kHz + 16 kHz
+        { 3, 3, { { 2000.0f, 5657.0f, 11314.0f } },   { { 6, 7, 8 } } }   // Accurate: 500 Hz + 4, 8, 16 kHz
+    };
+
+    constexpr float shelfQ = 0.7071f;
+    constexpr int fitIterations = 6;
+    constexpr float fitStep = 0.8f;           // damped: neighbouring shelves overlap
+    constexpr float refitToleranceDb = 0.1f;
+    constexpr float transparentDb = 0.05f;
+
+    float magnitudeDb (const std::array<float, 6>& c, float cosW, float cosTwoW) noexcept
+    {
+        const float num = c[0] * c[0] + c[1] * c[1] + c[2] * c[2]
+                        + 2.0f * (c[0] * c[1] + c[1] * c[2]) * cosW + 2.0f * c[0] * c[2] * cosTwoW;
+        const float den = c[3] * c[3] + c[4] * c[4] + c[5] * c[5]
+                        + 2.0f * (c[3] * c[4] + c[4] * c[5]) * cosW + 2.0f * c[3] * c[5] * cosTwoW;
+
+        return 10.0f * std::log10 (juce::jmax (1.0e-12f, num) / juce::jmax (1.0e-12f, den));
+    }
+}
+
+//==============================================================================
+AtmosphericAbsorption::AtmosphericAbsorption()
+{
+    for (auto& coefficients : sharedCoefficients)
+        coefficients = new juce::dsp::IIR::Coefficients<float> (1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+
+    // Every channel's shelf k reads the same coefficients, so one fit updates both ears
+    for (auto& channel : shelves)
+        for (size_t k = 0; k < (size_t) maxShelves; ++k)
+            channel[k].coefficients = sharedCoefficients[k];
+
+    rebuildTable();
+}
+
+void AtmosphericAbsorption::prepare (double newSampleRate, int numChannels)
+{
+    sampleRate = newSampleRate;
+    preparedChannels = juce::jlimit (1, maxChannels, numChannels);
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        const float frequency = juce::jmin (bandFrequencies[(size_t) b], (float) (0.45 * sampleRate));
+        const float omega = juce::MathConstants<float>::twoPi * frequency / (float) sampleRate;
+        cosOmega[(size_t) b]    = std::cos (omega);
+        cosTwoOmega[(size_t) b] = std::cos (2.0f * omega);
+    }
+
+    for (auto& channel : shelves)
+        for (auto& shelf : channel)
+            shelf.prepare (juce::dsp::ProcessSpec { sampleRate, 1, 1 });
+
+    needsFit = true;
+    reset();
+}
+
+void AtmosphericAbsorption::reset()
+{
+    for (auto& channel : shelves)
+        for (auto& shelf : channel)
+            shelf.reset();
+
+    lastGain = targetGain;
+}
+
+//==============================================================================
+void AtmosphericAbsorption::setAtmosphere (float temperatureCelsius, float humidityPercent, float pressureKPa) noexcept
+{
+    temperatureCelsius = juce::jlimit (-40.0f, 60.0f, temperatureCelsius);
+    humidityPercent    = juce::jlimit (0.0f, 100.0f, humidityPercent);
+    pressureKPa        = juce::jlimit (50.0f, 110.0f, pressureKPa);
+
+    if (temperatureCelsius == temperature && humidityPercent == humidity && pressureKPa == pressure)
+        return;
+
+    temperature = temperatureCelsius;
+    humidity    = humidityPercent;
+    pressure    = pressureKPa;
+    rebuildTable();
+}
+
+void AtmosphericAbsorption::setFidelity (Fidelity newFidelity) noexcept
+{
+    if (newFidelity != fidelity)
+    {
+        fidelity = newFidelity;
+        needsFit = true;
+    }
+}
+
+void AtmosphericAbsorption::setPathLength (float metres) noexcept
+{
+    pathLength = juce::jmax (0.0f, metres);
+
+    if (! needsFit)
+    {
+        for (int b = 0; b < numBands && ! needsFit; ++b)
+            needsFit = std::abs (bandAttenuation (b) - fittedAttenuation[(size_t) b]) > refitToleranceDb;
+    }
+
+    if (needsFit)
+        fit();
+}
+
+//==============================================================================
+void AtmosphericAbsorption::process (juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept
+{
+    if (transparent)
+    {
+        lastGain = targetGain;
+        return;
+    }
+
+    numChannels = juce::jmin (numChannels, buffer.getNumChannels(), preparedChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        buffer.applyGainRamp (ch, 0, numSamples, lastGain, targetGain);
+
+        auto* data = buffer.getWritePointer (ch);
+
+        for (int k = 0; k < activeShelves; ++k)
+        {
+            auto& shelf = shelves[(size_t) ch][(size_t) k];
+
+            for (int s = 0; s < numSamples; ++s)
+                data[s] = shelf.processSample (data[s]);
+        }
+    }
+
+    lastGain = targetGain;
+}
+
+//==============================================================================
+float AtmosphericAbsorption::getBandFrequency (int band) noexcept
+{
+    return bandFrequencies[(size_t) juce::jlimit (0, numBands - 1, band)];
+}
+
+float AtmosphericAbsorption::computeAttenuationPerMetre (float frequencyHz, float temperatureCelsius,
+                                                         float humidityPercent, float pressureKPa) noexcept
+{
+    // ISO 9613-1:1993, equations (1) to (5) and annex B
+    constexpr double referencePressure = 101.325;  // kPa
+    constexpr double referenceTemperature = 293.15; // K
+    constexpr double triplePointTemperature = 273.16;
+
+    const double f  = frequencyHz;
+    const double T  = temperatureCelsius + 273.15;
+    const double pa = pressureKPa / referencePressure;
+    const double tr = T / referenceTemperature;
+
+    // Molar concentration of water vapour, in percent
+    const double saturationExponent = -6.8346 * std::pow (triplePointTemperature / T, 1.261) + 4.6151;
+    const double h = humidityPercent * std::pow (10.0, saturationExponent) / pa;
+
+    // Oxygen and nitrogen relaxation frequencies
+    const double frO = pa * (24.0 + 4.04e4 * h * (0.02 + h) / (0.391 + h));
+    const double frN = pa / std::sqrt (tr) * (9.0 + 280.0 * h * std::exp (-4.170 * (std::pow (tr, -1.0 / 3.0) - 1.0)));
+
+    const double classical = 1.84e-11 / pa * std::sqrt (tr);
+    const double oxygen    = 0.01275 * std::exp (-2239.1 / T) / (frO + f * f / frO);
+    const double nitrogen  = 0.1068  * std::exp (-3352.0 / T) / (frN + f * f / frN);
+
+    return (float) (8.686 * f * f * (classical + std::pow (tr, -2.5) * (oxygen + nitrogen)));
+}
+
+//==============================================================================
+void AtmosphericAbsorption::rebuildTable() noexcept
+{
+    for (int b = 0; b < numBands; ++b)
+        attenuationPerMetre[(size_t) b] = computeAttenuationPerMetre (bandFrequencies[(size_t) b],
+                                                                      temperature, humidity, pressure);
+
+    needsFit = true;
+}
+
+float AtmosphericAbsorption::bandAttenuation (int band) const noexcept
+{
+    return juce::jmin (maxAttenuationDb, attenuationPerMetre[(size_t) band] * pathLength);
+}
+
+float AtmosphericAbsorption::cascadeResponse (int band, int numShelves) const noexcept
+{
+    float response = 0.0f;
+
+    for (int k = 0; k < numShelves; ++k)
+        response += magnitudeDb (shelfCoefficients[(size_t) k], cosOmega[(size_t) band], cosTwoOmega[(size_t) band]);
+
+    return response;
+}
+
+void AtmosphericAbsorption::fit() noexcept
+{
+    needsFit = false;
+
+    for (int b = 0; b < numBands; ++b)
+        fittedAttenuation[(size_t) b] = bandAttenuation (b);
+
+    // Attenuation rises monotonically with frequency, so the top band decides
+    const bool wasTransparent = transparent;
+    transparent = fittedAttenuation[(size_t) numBands - 1] < transparentDb;
+
+    if (transparent)
+    {
+        targetGain = 1.0f;
+        return;
+    }
+
+    const auto& layout = shelfLayouts[fidelity];
+    const float baseDb = fittedAttenuation[(size_t) layout.baseBand];
+    const float maxCorner = (float) (0.4 * sampleRate);
+
+    // Start from the staircase: each shelf takes the rise up to its anchor
+    float previousDb = baseDb;
+
+    for (int k = 0; k < layout.numShelves; ++k)
+    {
+        const float anchorDb = fittedAttenuation[(size_t) layout.anchorBands[(size_t) k]];
+        shelfGainsDb[(size_t) k] = previousDb - anchorDb;
+        previousDb = anchorDb;
+    }
+
+    auto updateCoefficients = [&]
+    {
+        for (int k = 0; k < layout.numShelves; ++k)
+            shelfCoefficients[(size_t) k] = juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf (
+                sampleRate, juce::jmin (layout.corners[(size_t) k], maxCorner), shelfQ,
+                juce::Decibels::decibelsToGain (shelfGainsDb[(size_t) k], -300.0f));
+    };
+
+    // Shelves overlap, so correct each one against its anchor's residual
+    for (int iteration = 0; iteration < fitIterations; ++iteration)
+    {
+        updateCoefficients();
+
+        std::array<float, maxShelves> residuals {};
+
+        for (int k = 0; k < layout.numShelves; ++k)
+        {
+            const int band = layout.anchorBands[(size_t) k];
+            residuals[(size_t) k] = cascadeResponse (band, layout.numShelves) - baseDb + fittedAttenuation[(size_t) band];
+        }
+
+        for (int k = 0; k < layout.numShelves; ++k)
+            shelfGainsDb[(size_t) k] = juce::jlimit (-maxAttenuationDb, maxAttenuationDb,
+                                                     shelfGainsDb[(size_t) k] - fitStep * residuals[(size_t) k]);
+    }
+
+    updateCoefficients();
+
+    for (int k = 0; k < layout.numShelves; ++k)
+        *sharedCoefficients[(size_t) k] = shelfCoefficients[(size_t) k];
+
+    // Shelves coming back into use must not ring out whatever they held before
+    const int firstStaleShelf = wasTransparent ? 0 : activeShelves;
+
+    for (auto& channel : shelves)
+        for (int k = firstStaleShelf; k < layout.numShelves; ++k)
+            channel[(size_t) k].reset();
+
+    if (wasTransparent)
+        lastGain = 1.0f;
+
+    activeShelves = layout.numShelves;
+    targetGain = juce::Decibels::decibelsToGain (-baseDb);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+//==============================================================================
+/**
+    ISO 9613-1 atmospheric absorption
+    Keeps a per-octave table (63 Hz - 16 kHz) of the pure-tone attenuation
+    coefficient in dB/m for the current temperature, relative humidity and
+    pressure; the table is only rebuilt when the atmosphere changes.
+    For a given path length the band attenuations are matched at control rate
+    by a broadband gain and a short cascade of high-shelf biquads, so the
+    audio thread only runs the shelves. Fast fits one shelf at 16 kHz;
+    Accurate fits three, at 4, 8 and 16 kHz.
+    Band attenuation is floored at maxAttenuationDb: beyond that the band is
+    effectively gone, and shelves cannot follow a deeper curve anyway.
+*/
+class AtmosphericAbsorption
+{
+public:
+    //==============================================================================
+    enum Fidelity
+    {
+        Fast = 0,   // broadband gain + one shelf
+        Accurate    // broadband gain + three shelves
+    };
+
+    static constexpr int numBands = 9;
+    static constexpr int maxShelves = 3;
+    static constexpr int maxChannels = 2;
+    static constexpr float maxAttenuationDb = 24.0f;
+
+    AtmosphericAbsorption();
+    ~AtmosphericAbsorption() = default;
+
+    void prepare (double sampleRate, int numChannels);
+    void reset();
+
+    /** Rebuilds the attenuation table if any value has changed. */
+    void setAtmosphere (float temperatureCelsius, float humidityPercent, float pressureKPa) noexcept;
+    void setFidelity (Fidelity newFidelity) noexcept;
+
+    /** Path length in metres; the filters are refitted when its attenuation
+        has moved by more than a tenth of a dB in any fitted band. */
+    void setPathLength (float metres) noexcept;
+
+    /** True when the current path attenuates no band audibly. */
+    bool isTransparent() const noexcept { return transparent; }
+
+    /** Filters the first numChannels channels of the buffer in place. */
+    void process (juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept;
+
+    //==============================================================================
+    static float getBandFrequency (int band) noexcept;
+    float getAttenuationPerMetre (int band) const noexcept { return attenuationPerMetre[(size_t) band]; }
+
+    /** ISO 9613-1 pure-tone attenuation coefficient in dB/m. */
+    static float computeAttenuationPerMetre (float frequencyHz, float temperatureCelsius,
+                                             float humidityPercent, float pressureKPa) noexcept;
+
+private:
+    //==============================================================================
+    void rebuildTable() noexcept;
+    void fit() noexcept;
+    float bandAttenuation (int band) const noexcept;
+    float cascadeResponse (int band, int numShelves) const noexcept;
+
+    //==============================================================================
+    double sampleRate = 44100.0;
+    int preparedChannels = maxChannels;
+
+    float temperature = 20.0f;
+    float humidity = 50.0f;
+    float pressure = 101.325f;
+    Fidelity fidelity = Accurate;
+    float pathLength = 0.0f;
+
+    std::array<float, numBands> attenuationPerMetre {};
+    std::array<float, numBands> cosOmega {};      // per band centre, for the magnitude sums
+    std::array<float, numBands> cosTwoOmega {};
+
+    // Attenuation the current fit was made for, to skip needless refits
+    std::array<float, numBands> fittedAttenuation {};
+    bool needsFit = true;
+    bool transparent = true;
+
+    std::array<float, maxShelves> shelfGainsDb {};
+    std::array<std::array<float, 6>, maxShelves> shelfCoefficients {};
+    int activeShelves = 0;
+
+    float targetGain = 1.0f;
+    float lastGain = 1.0f;
+
+    std::array<juce::dsp::IIR::Coefficients<float>::Ptr, maxShelves> sharedCoefficients;
+    std::array<std::array<juce::dsp::IIR::Filter<float>, maxShelves>, maxChannels> shelves;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AtmosphericAbsorption)
+};
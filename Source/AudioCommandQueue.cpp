@@ -0,0 +1,15 @@
+#include "AudioCommandQueue.h"
+
+//==============================================================================
+bool AudioCommandQueue::push (Command command, int value) noexcept
+{
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    auto& entry = entries[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)];
+    entry.command = command;
+    entry.value = value;
+    return true;
+}
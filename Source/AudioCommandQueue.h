@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+    Message-to-audio command queue
+    State that is not an automatable parameter - the room type restored from
+    a session, for instance - is not written into the DSP objects from the
+    message thread. It is pushed as a small fixed-size command into a
+    preallocated single-producer, single-consumer ring, and the audio thread
+    applies every queued command at the start of its next block, so a change
+    never lands halfway through one. Neither side locks or allocates.
+    The message thread is the only producer; state restored on a host thread
+    is marshalled onto it first. While the audio thread is stopped,
+    prepareToPlay applies the queue itself, and a consumer that finds the
+    other one inside leaves the commands queued.
+*/
+class AudioCommandQueue
+{
+public:
+    //==============================================================================
+    enum Command
+    {
+        SetEnvironment = 0,     // value: DistanceProcessor::Environment
+        numCommands
+    };
+
+    static constexpr int capacity = 256;
+
+    AudioCommandQueue() = default;
+    ~AudioCommandQueue() = default;
+
+    /** Message thread only. Returns false if the ring is full. */
+    bool push (Command command, int value) noexcept;
+
+    /** Audio thread, or prepareToPlay while processing is stopped: calls
+        handler (command, value) for every queued command, oldest first.
+        Returns false, applying nothing, if another consumer is inside. */
+    template <typename Handler>
+    bool apply (Handler&& handler) noexcept
+    {
+        if (consuming.exchange (true, std::memory_order_acquire))
+        {
+            jassertfalse;
+            return false;
+        }
+
+        {
+            // The scope releases the entries when it is destroyed, which has
+            // to happen before the next consumer may claim the queue.
+            const auto scope = fifo.read (fifo.getNumReady());
+
+            for (int i = 0; i < scope.blockSize1; ++i)
+                handler (entries[(size_t) (scope.startIndex1 + i)].command, entries[(size_t) (scope.startIndex1 + i)].value);
+
+            for (int i = 0; i < scope.blockSize2; ++i)
+                handler (entries[(size_t) (scope.startIndex2 + i)].command, entries[(size_t) (scope.startIndex2 + i)].value);
+        }
+
+        consuming.store (false, std::memory_order_release);
+        return true;
+    }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        Command command = SetEnvironment;
+        int value = 0;
+    };
+
+    juce::AbstractFifo fifo { capacity };
+    std::array<Entry, capacity> entries;
+    std::atomic<bool> consuming { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioCommandQueue)
+};
@@ -0,0 +1,158 @@
+#include "AudioThreadLog.h"
+#include "StageProfiler.h"
+#include <limits>
+
+//==============================================================================
+AudioThreadLog::AudioThreadLog()
+{
+    startTimerHz (4);
+}
+
+AudioThreadLog::~AudioThreadLog()
+{
+    stopTimer();
+    drain();
+    flushSuppressed (true);
+}
+
+//==============================================================================
+juce::int64 AudioThreadLog::getIntervalTicks() noexcept
+{
+    return (juce::int64) (minimumIntervalSeconds * (double) juce::Time::getHighResolutionTicksPerSecond());
+}
+
+AudioThreadLog::Limiter& AudioThreadLog::getLimiter (Event event, float payload) noexcept
+{
+    const auto count = numLimiters.load (std::memory_order_relaxed);
+
+    for (int i = 0; i < count; ++i)
+        if (limiters[(size_t) i].event == event && limiters[(size_t) i].payload == payload)
+            return limiters[(size_t) i];
+
+    if (count == maxLimiters)
+        return limiters.back();
+
+    // Published with release, so the drain never sees a slot before its key
+    auto& limiter = limiters[(size_t) count];
+    limiter.event = event;
+    limiter.payload = payload;
+    limiter.lastPushTicks.store (std::numeric_limits<juce::int64>::min() / 2, std::memory_order_relaxed);
+    numLimiters.store (count + 1, std::memory_order_release);
+    return limiter;
+}
+
+void AudioThreadLog::push (Event event, float payload) noexcept
+{
+    auto& limiter = getLimiter (event, payload);
+    const auto now = juce::Time::getHighResolutionTicks();
+
+    if (now - limiter.lastPushTicks.load (std::memory_order_relaxed) < getIntervalTicks())
+    {
+        limiter.suppressed.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+    {
+        droppedCount.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& entry = entries[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)];
+    entry.event = event;
+    entry.payload = payload;
+    entry.suppressed = limiter.suppressed.exchange (0, std::memory_order_relaxed);
+    entry.dropped = droppedCount.exchange (0, std::memory_order_relaxed);
+
+    limiter.lastPushTicks.store (now, std::memory_order_relaxed);
+}
+
+void AudioThreadLog::drain()
+{
+    for (;;)
+    {
+        const auto scope = fifo.read (1);
+
+        if (scope.blockSize1 + scope.blockSize2 == 0)
+            break;
+
+        juce::Logger::writeToLog (format (entries[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)]));
+    }
+
+    flushSuppressed (false);
+}
+
+void AudioThreadLog::flushSuppressed (bool includeRecent)
+{
+    // A burst that stopped leaves its count behind with no event to carry it;
+    // report it once the pair has been quiet for the interval, or at shutdown
+    const auto now = juce::Time::getHighResolutionTicks();
+    const auto count = numLimiters.load (std::memory_order_acquire);
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto& limiter = limiters[(size_t) i];
+
+        if (limiter.suppressed.load (std::memory_order_relaxed) == 0
+             || (! includeRecent && now - limiter.lastPushTicks.load (std::memory_order_relaxed) < getIntervalTicks()))
+            continue;
+
+        Entry entry;
+        entry.event = limiter.event;
+        entry.payload = limiter.payload;
+        entry.suppressed = limiter.suppressed.exchange (0, std::memory_order_relaxed);
+        entry.repeatsOnly = true;
+
+        if (entry.suppressed > 0)
+            juce::Logger::writeToLog (format (entry));
+    }
+
+    const auto dropped = droppedCount.exchange (0, std::memory_order_relaxed);
+
+    if (dropped > 0)
+        juce::Logger::writeToLog ("Audio thread log: " + juce::String (dropped) + " events lost");
+}
+
+juce::String AudioThreadLog::format (const Entry& entry)
+{
+    juce::String text;
+
+    switch (entry.event)
+    {
+        case StageException:
+            text << "DistanceProcessor " << StageProfiler::getStageName ((StageProfiler::Stage) juce::roundToInt (entry.payload))
+                 << " stage threw";
+            break;
+
+        case ProcessException:
+            text << "Exception in processBlock";
+            break;
+
+        case ProcessUnknownException:
+            text << "Unknown exception in processBlock";
+            break;
+
+        case RoomSendDropped:
+            text << "Shared room " << juce::roundToInt (entry.payload) << " send dropped, its return is not keeping up";
+            break;
+
+        case numEvents:
+        default:
+            text << "Audio thread event " << (int) entry.event << " (" << entry.payload << ")";
+            break;
+    }
+
+    if (entry.repeatsOnly)
+        return text << " " << entry.suppressed << (entry.suppressed == 1 ? " more time" : " more times")
+                    << " since the last report";
+
+    if (entry.suppressed > 0)
+        text << " [" << entry.suppressed << " similar events suppressed]";
+
+    if (entry.dropped > 0)
+        text << " [" << entry.dropped << " events lost]";
+
+    return text;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+    Real-time safe event log
+    The audio thread pushes fixed-size events - a code and a numeric
+    payload - into a preallocated single-producer ring; a message-thread
+    timer drains the ring and formats the events for juce::Logger. Pushing
+    never allocates, formats or blocks.
+    Each code and payload pair - each stage of StageException, say - is
+    rate-limited on its own: a repeat within minimumInterval is only counted,
+    and the count travels with the next event of that pair that gets through,
+    as does any loss to a full ring. Counts that no later event picks up are
+    reported by the drain once the interval has passed.
+*/
+class AudioThreadLog : private juce::Timer
+{
+public:
+    //==============================================================================
+    enum Event
+    {
+        StageException = 0,     // payload: StageProfiler::Stage that threw
+        ProcessException,       // PluginProcessor::processBlock caught a std::exception
+        ProcessUnknownException,
+        RoomSendDropped,        // payload: shared room ID whose send FIFO was full
+        numEvents
+    };
+
+    static constexpr int capacity = 128;
+    static constexpr int maxLimiters = 16;  // distinct code and payload pairs; further pairs share the last
+    static constexpr double minimumIntervalSeconds = 1.0;
+
+    AudioThreadLog();
+    ~AudioThreadLog() override;
+
+    /** Audio thread. */
+    void push (Event event, float payload = 0.0f) noexcept;
+
+    /** Message thread; also runs from the timer. */
+    void drain();
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        Event event = StageException;
+        float payload = 0.0f;
+        int suppressed = 0;         // repeats of this code and payload held back since its last entry
+        int dropped = 0;            // events of any code lost to a full ring before this one
+        bool repeatsOnly = false;   // from the drain: held-back repeats no later event picked up
+    };
+
+    // Written by the audio thread; the drain reads them to flush what is left over
+    struct Limiter
+    {
+        Event event = StageException;
+        float payload = 0.0f;
+        std::atomic<juce::int64> lastPushTicks { 0 };
+        std::atomic<int> suppressed { 0 };
+    };
+
+    static juce::String format (const Entry& entry);
+    static juce::int64 getIntervalTicks() noexcept;
+    Limiter& getLimiter (Event event, float payload) noexcept;
+    void flushSuppressed (bool includeRecent);
+    void timerCallback() override { drain(); }
+
+    juce::AbstractFifo fifo { capacity };
+    std::array<Entry, capacity> entries;
+
+    std::array<Limiter, maxLimiters> limiters;
+    std::atomic<int> numLimiters { 0 };     // claimed by the audio thread only
+    std::atomic<int> droppedCount { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioThreadLog)
+};
@@ -0,0 +1,408 @@
+#include "BackgroundWorkerPool.h"
+#include <algorithm>
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <cerrno>
+ #include <semaphore.h>
+#endif
+
+namespace
+{
+    constexpr int maxWorkers = 4;
+
+    // A task is on a ready queue at most once, so registration caps the depth
+    constexpr size_t queueCapacity = 4096;
+
+    template <typename T>
+    void updateMaximum (std::atomic<T>& maximum, T value) noexcept
+    {
+        auto current = maximum.load (std::memory_order_relaxed);
+        while (value > current && ! maximum.compare_exchange_weak (current, value, std::memory_order_relaxed)) {}
+    }
+
+    // Takes the lock, counting the times another thread already held it
+    struct CountingScopedLock
+    {
+        CountingScopedLock (const juce::CriticalSection& lockToTake, std::atomic<juce::int64>& waits) noexcept
+            : lock (lockToTake)
+        {
+            if (! lock.tryEnter())
+            {
+                waits.fetch_add (1, std::memory_order_relaxed);
+                lock.enter();
+            }
+        }
+
+        ~CountingScopedLock() noexcept  { lock.exit(); }
+
+        const juce::CriticalSection& lock;
+
+        JUCE_DECLARE_NON_COPYABLE (CountingScopedLock)
+    };
+}
+
+//==============================================================================
+/*
+    Bounded multi-producer, multi-consumer ring of task pointers (Vyukov).
+    juce::AbstractFifo would do for one producer, but tasks are triggered
+    from every instance's audio thread and claimed by every worker.
+*/
+class BackgroundWorkerPool::ReadyQueue
+{
+public:
+    ReadyQueue()
+    {
+        for (size_t i = 0; i < queueCapacity; ++i)
+            cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+
+    bool push (Task* task) noexcept
+    {
+        auto position = enqueuePosition.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& cell = cells[position & mask];
+            const auto sequence = cell.sequence.load (std::memory_order_acquire);
+            const auto difference = (std::ptrdiff_t) sequence - (std::ptrdiff_t) position;
+
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.task = task;
+                    cell.sequence.store (position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Task* pop() noexcept
+    {
+        auto position = dequeuePosition.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& cell = cells[position & mask];
+            const auto sequence = cell.sequence.load (std::memory_order_acquire);
+            const auto difference = (std::ptrdiff_t) sequence - (std::ptrdiff_t) (position + 1);
+
+            if (difference == 0)
+            {
+                if (dequeuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                {
+                    auto* task = cell.task;
+                    cell.sequence.store (position + queueCapacity, std::memory_order_release);
+                    return task;
+                }
+            }
+            else if (difference < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                position = dequeuePosition.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence { 0 };
+        Task* task = nullptr;
+    };
+
+    static constexpr size_t mask = queueCapacity - 1;
+    static_assert ((queueCapacity & mask) == 0, "capacity must be a power of two");
+
+    std::array<Cell, queueCapacity> cells;
+    alignas (64) std::atomic<size_t> enqueuePosition { 0 };
+    alignas (64) std::atomic<size_t> dequeuePosition { 0 };
+};
+
+//==============================================================================
+/*
+    Counting semaphore the idle workers sleep on. juce::WaitableEvent guards
+    its flag with a mutex that a sleeping worker holds on its way into and
+    out of wait(), so an audio thread signalling it could block behind a
+    low-priority thread. post() here is a single kernel call that never
+    blocks. Surplus posts only cost a worker one more look at the queues.
+*/
+class BackgroundWorkerPool::WakeSemaphore
+{
+public:
+   #if JUCE_MAC || JUCE_IOS
+    WakeSemaphore()  : semaphore (dispatch_semaphore_create (0)) {}
+    ~WakeSemaphore() { dispatch_release (semaphore); }
+
+    void post() noexcept  { dispatch_semaphore_signal (semaphore); }
+    void wait() noexcept  { dispatch_semaphore_wait (semaphore, DISPATCH_TIME_FOREVER); }
+
+private:
+    dispatch_semaphore_t semaphore;
+   #else
+    WakeSemaphore()  { sem_init (&semaphore, 0, 0); }
+    ~WakeSemaphore() { sem_destroy (&semaphore); }
+
+    void post() noexcept  { sem_post (&semaphore); }
+    void wait() noexcept  { while (sem_wait (&semaphore) != 0 && errno == EINTR) {} }
+
+private:
+    sem_t semaphore;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (WakeSemaphore)
+};
+
+//==============================================================================
+class BackgroundWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker (BackgroundWorkerPool& ownerPool, int index)
+        : juce::Thread ("SOFAR worker " + juce::String (index)), pool (ownerPool)
+    {
+    }
+
+    void run() override
+    {
+        for (;;)
+        {
+            if (auto* task = pool.claimNextTask())
+            {
+                pool.runTask (*task);
+                continue;
+            }
+
+            if (threadShouldExit())
+                break;
+
+            // Announced before the last look at the queue: an enqueue either
+            // sees the sleeper and posts, or is seen here
+            pool.sleepingWorkers.fetch_add (1);
+
+            if (pool.queueDepth.load() <= 0)
+                pool.workAvailable->wait();
+
+            pool.sleepingWorkers.fetch_sub (1);
+        }
+    }
+
+private:
+    BackgroundWorkerPool& pool;
+};
+
+//==============================================================================
+BackgroundWorkerPool::BackgroundWorkerPool()
+    : workAvailable (std::make_unique<WakeSemaphore>())
+{
+    for (auto& queue : readyQueues)
+        queue = std::make_unique<ReadyQueue>();
+
+    const int numWorkers = juce::jlimit (1, maxWorkers, juce::SystemStats::getNumCpus() / 2);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back (std::make_unique<Worker> (*this, i + 1));
+        workers.back()->startThread();
+    }
+}
+
+BackgroundWorkerPool::~BackgroundWorkerPool()
+{
+    for (auto& worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        workAvailable->post();
+    }
+
+    for (auto& worker : workers)
+        worker->stopThread (2000);
+
+    // Every task must have been removed by its owner before the pool goes away
+    jassert (std::all_of (tasks.begin(), tasks.end(), [] (const auto& list) { return list.empty(); }));
+}
+
+//==============================================================================
+void BackgroundWorkerPool::addTask (Task& task)
+{
+    const CountingScopedLock sl (tasksLock, lockWaits);
+    auto& list = tasks[(size_t) task.priority];
+
+    if (std::find (list.begin(), list.end(), &task) != list.end())
+        return;
+
+    // Keeps every push onto the ready queue from succeeding
+    if (list.size() >= queueCapacity)
+    {
+        jassertfalse;
+        juce::Logger::writeToLog ("Background worker pool full - task not registered");
+        return;
+    }
+
+    list.push_back (&task);
+    task.registered.store (true);
+}
+
+void BackgroundWorkerPool::removeTask (Task& task)
+{
+    {
+        const CountingScopedLock sl (tasksLock, lockWaits);
+        auto& list = tasks[(size_t) task.priority];
+        list.erase (std::remove (list.begin(), list.end(), &task), list.end());
+    }
+
+    // A queued pointer is dropped by the worker that pops it; wait for that,
+    // or for a run in progress, before the task can be destroyed
+    task.registered.store (false);
+
+    while (task.state.load() != Task::Idle)
+        juce::Thread::sleep (1);
+}
+
+void BackgroundWorkerPool::trigger (Task& task) noexcept
+{
+    if (! task.registered.load (std::memory_order_relaxed))
+        return;
+
+    task.requestTicks.store (juce::Time::getHighResolutionTicks(), std::memory_order_relaxed);
+
+    auto state = task.state.load();
+
+    for (;;)
+    {
+        if (state == Task::Queued || state == Task::RunningAgain)
+        {
+            coalesced.fetch_add (1, std::memory_order_relaxed);
+            return;
+        }
+
+        // A running task is queued again by its worker when it finishes
+        const int next = state == Task::Idle ? Task::Queued : Task::RunningAgain;
+
+        if (task.state.compare_exchange_weak (state, next))
+            break;
+    }
+
+    if (state == Task::Idle)
+        enqueue (task);
+}
+
+void BackgroundWorkerPool::enqueue (Task& task) noexcept
+{
+    updateMaximum (maxQueueDepth, queueDepth.fetch_add (1) + 1);
+
+    const bool pushed = readyQueues[(size_t) task.priority]->push (&task);
+    jassert (pushed); // addTask bounds the queue
+    juce::ignoreUnused (pushed);
+
+    wakeWorker();
+}
+
+void BackgroundWorkerPool::wakeWorker() noexcept
+{
+    // Busy workers look at the queues again before they sleep
+    if (sleepingWorkers.load() > 0)
+        workAvailable->post();
+}
+
+//==============================================================================
+BackgroundWorkerPool::Task* BackgroundWorkerPool::claimNextTask() noexcept
+{
+    for (auto& queue : readyQueues)
+    {
+        while (auto* task = queue->pop())
+        {
+            queueDepth.fetch_sub (1);
+
+            // Removed while queued: retire the pointer without running it
+            if (! task->registered.load())
+            {
+                task->state.store (Task::Idle);
+                continue;
+            }
+
+            // More may be waiting; wake another worker for them
+            wakeWorker();
+
+            task->state.store (Task::Running);
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+void BackgroundWorkerPool::runTask (Task& task)
+{
+    const auto latency = juce::Time::getHighResolutionTicks() - task.requestTicks.load (std::memory_order_relaxed);
+    totalLatencyTicks.fetch_add (latency, std::memory_order_relaxed);
+    updateMaximum (maxLatencyTicks, latency);
+
+    try
+    {
+        task.run();
+    }
+    catch (const std::exception& e)
+    {
+        juce::Logger::writeToLog ("Background task error: " + juce::String (e.what()));
+    }
+    catch (...)
+    {
+        juce::Logger::writeToLog ("Unknown background task error");
+    }
+
+    runs.fetch_add (1, std::memory_order_relaxed);
+
+    // Triggered again meanwhile: back onto the queue, still never concurrent with itself
+    int running = Task::Running;
+
+    if (! task.state.compare_exchange_strong (running, Task::Idle))
+    {
+        task.state.store (Task::Queued);
+        enqueue (task);
+    }
+}
+
+//==============================================================================
+BackgroundWorkerPool::Metrics BackgroundWorkerPool::getMetrics() const noexcept
+{
+    const double ticksToMs = 1000.0 / static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+
+    Metrics metrics;
+    metrics.numThreads    = (int) workers.size();
+    metrics.queueDepth    = juce::jmax (0, queueDepth.load());
+    metrics.maxQueueDepth = maxQueueDepth.load();
+    metrics.runs          = runs.load();
+    metrics.coalesced     = coalesced.load();
+    metrics.maxLatencyMs  = static_cast<double> (maxLatencyTicks.load()) * ticksToMs;
+    metrics.lockWaits     = lockWaits.load();
+
+    if (metrics.runs > 0)
+        metrics.averageLatencyMs = static_cast<double> (totalLatencyTicks.load()) * ticksToMs
+                                   / static_cast<double> (metrics.runs);
+
+    return metrics;
+}
+
+void BackgroundWorkerPool::resetMetrics() noexcept
+{
+    maxQueueDepth.store (juce::jmax (0, queueDepth.load()));
+    runs.store (0);
+    coalesced.store (0);
+    totalLatencyTicks.store (0);
+    maxLatencyTicks.store (0);
+    lockWaits.store (0);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+    Process-wide background worker pool
+    Shared by every SOFAR instance through juce::SharedResourcePointer, so the
+    number of background threads stays bounded no matter how many instances a
+    session holds. Work is registered once as a Task and then triggered; a
+    task that is triggered again before it runs is coalesced into the pending
+    run, which always sees the most recent request. A triggered task is put
+    on a lock-free ready queue, one per priority, and the idle workers sleep
+    on a semaphore that trigger() posts, so nothing polls. trigger() may be
+    called from the audio thread: it only posts when a task goes from idle to
+    queued while a worker is asleep, and posting never takes a lock a worker
+    could be holding.
+*/
+class BackgroundWorkerPool
+{
+public:
+    //==============================================================================
+    enum Priority
+    {
+        High = 0,   // audible results (HRIR updates)
+        Normal,
+        Low,        // speculative / cache warming
+        numPriorities
+    };
+
+    class Task
+    {
+    public:
+        explicit Task (Priority taskPriority = Normal) noexcept : priority (taskPriority) {}
+        virtual ~Task() = default;
+
+        /** Runs on a worker thread. Never runs concurrently with itself. */
+        virtual void run() = 0;
+
+        Priority getPriority() const noexcept { return priority; }
+
+    private:
+        friend class BackgroundWorkerPool;
+
+        enum State
+        {
+            Idle = 0,
+            Queued,         // on a ready queue
+            Running,
+            RunningAgain    // triggered while running: queued again when it finishes
+        };
+
+        const Priority priority;
+        std::atomic<int> state { Idle };
+        std::atomic<bool> registered { false };
+        std::atomic<juce::int64> requestTicks { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE (Task)
+    };
+
+    struct Metrics
+    {
+        int numThreads = 0;
+        int queueDepth = 0;         // tasks waiting for a worker right now
+        int maxQueueDepth = 0;
+        juce::int64 runs = 0;
+        juce::int64 coalesced = 0;  // triggers folded into an already pending run
+        double averageLatencyMs = 0.0; // trigger -> start of run
+        double maxLatencyMs = 0.0;
+        juce::int64 lockWaits = 0;  // registrations that found the task lock held
+    };
+
+    //==============================================================================
+    BackgroundWorkerPool();
+    ~BackgroundWorkerPool();
+
+    /** Registers a task. Call from the message thread (prepare). */
+    void addTask (Task& task);
+
+    /** Unregisters a task, waiting for a queued or running run to be retired.
+        The task must not be triggered concurrently. */
+    void removeTask (Task& task);
+
+    /** Requests a run of a registered task; ignored for any other. Lock-free. */
+    void trigger (Task& task) noexcept;
+
+    Metrics getMetrics() const noexcept;
+    void resetMetrics() noexcept;
+
+private:
+    //==============================================================================
+    class Worker;
+    class ReadyQueue;
+    class WakeSemaphore;
+
+    void enqueue (Task& task) noexcept;
+    void wakeWorker() noexcept;
+    Task* claimNextTask() noexcept;
+    void runTask (Task& task);
+
+    // Registration only; the workers never take it
+    juce::CriticalSection tasksLock;
+    std::array<std::vector<Task*>, numPriorities> tasks;
+
+    std::array<std::unique_ptr<ReadyQueue>, numPriorities> readyQueues;
+    std::unique_ptr<WakeSemaphore> workAvailable;
+    std::atomic<int> sleepingWorkers { 0 };
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::atomic<int> queueDepth { 0 };
+    std::atomic<int> maxQueueDepth { 0 };
+    std::atomic<juce::int64> runs { 0 };
+    std::atomic<juce::int64> coalesced { 0 };
+    std::atomic<juce::int64> totalLatencyTicks { 0 };
+    std::atomic<juce::int64> maxLatencyTicks { 0 };
+    std::atomic<juce::int64> lockWaits { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundWorkerPool)
+};
@@ -10,7 +10,12 @@ DistanceProcessor::DistanceProcessor()
 
     currentEnvironment = Room;
     lastEnvironment    = Room;
-    updateEnvironmentParameters (Room);
+
+    // The audio thread always has a room model to read
+    requestedRoom = { currentRoomWidth, currentRoomHeight, currentRoomLength,
+                      currentMaxDistance, currentAirAbsorption, currentTemperature };
+    roomModels.publish (std::make_unique<RoomModel> (requestedRoom));
+    room = &roomModels.acquire();
 
     trueGainEnabled  = true;
     trueDelayEnabled = true;
@@ -21,23 +26,39 @@ DistanceProcessor::DistanceProcessor()
     leftPanGain  = 0.707f;
     rightPanGain = 0.707f;
 }
+
+DistanceProcessor::~DistanceProcessor()
+{
+    workerPool->removeTask (hrirUpdateTask);
+    workerPool->removeTask (roomModelTask);
+}
 void DistanceProcessor::prepare(double sampleRate, int samplesPerBlock)
 {
+    // Hosts re-prepare on transport changes and offline bounces. At the same
+    // sample rate every coefficient and HRIR pair still
+    // holds, so only the block scratch grows and the state is cleared
+    if (isPrepared && sampleRate == this->sampleRate)
+    {
+        prepareBlockSize(samplesPerBlock);
+        return;
+    }
+    
     try {
+        // No HRIR builds may run while the chain is re-prepared
+        workerPool->removeTask (hrirUpdateTask);
+        
         this->sampleRate = sampleRate;
         this->samplesPerBlock = samplesPerBlock;
         hrirDatabase.setSampleRate (sampleRate);
-        earlyReflection.prepare (sampleRate, samplesPerBlock, 2);
-        hrtfTempBuffer.setSize (2, samplesPerBlock);
+        allocateScratch();
+        crossfeedPosition = 0;
         
         // Initialize parameter smoothing with optimized times to prevent artifacts
         smoothedDistance.reset(sampleRate, 0.010);  // 10ms smoothing time - balanced responsiveness
         smoothedPan.reset(sampleRate, 0.015);       // 15ms smoothing for panning - prevent artifacts  
         smoothedGain.reset(sampleRate, 0.020);      // 20ms smoothing for gain - prevents zipper noise
-        smoothedCutoffFreq.reset(sampleRate, 0.025); // 25ms smoothing for smooth frequency transitions
         smoothedLeftPanGain.reset(sampleRate, 0.015);
         smoothedRightPanGain.reset(sampleRate, 0.015);
-        smoothedDelayTime.reset(sampleRate, 0.025);  // 25ms smoothing for delay - prevents artifacts
         smoothedStereoWidth.reset(sampleRate, 0.030); // 30ms smoothing for stereo width - smooth transitions
         smoothedHeight.reset(sampleRate, 0.020);
         smoothedHeight.setCurrentAndTargetValue(currentHeightPercent);
@@ -56,28 +77,13 @@ void DistanceProcessor::prepare(double sampleRate, int samplesPerBlock)
         smoothedIldGainL.reset(sampleRate, 0.020);         // 20ms smoothing for ILD gains
         smoothedIldGainR.reset(sampleRate, 0.020);
         
-        // ITD smoothing (slower to prevent artifacts)
-        smoothedEarDelayLeft.reset(sampleRate, 0.015);
-        smoothedEarDelayRight.reset(sampleRate, 0.015);
-        
-        // Prepare ear delay lines (max 1 ms @ 96 kHz = 96 samples → allocate 480 for headroom)
-        earDelayLeft.reset();
-        earDelayRight.reset();
-        const int maxItdSamples = static_cast<int>(sampleRate * 0.002f); // 2 ms safety
-        earDelayLeft.prepare(juce::dsp::ProcessSpec{ sampleRate, (juce::uint32)samplesPerBlock, 1 });
-        earDelayRight.prepare(juce::dsp::ProcessSpec{ sampleRate, (juce::uint32)samplesPerBlock, 1 });
-        earDelayLeft.setMaximumDelayInSamples(maxItdSamples);
-        earDelayRight.setMaximumDelayInSamples(maxItdSamples);
-        
         // Set initial values
         smoothedDistance.setCurrentAndTargetValue(0.0f);
         smoothedPan.setCurrentAndTargetValue(0.0f);
         smoothedGain.setCurrentAndTargetValue(1.0f);  // Start at unity gain
-        smoothedCutoffFreq.setCurrentAndTargetValue(20000.0f);
         smoothedStereoWidth.setCurrentAndTargetValue(1.0f);
         smoothedLeftPanGain.setCurrentAndTargetValue(0.707f);
         smoothedRightPanGain.setCurrentAndTargetValue(0.707f);
-        smoothedDelayTime.setCurrentAndTargetValue(0.0f);
         
         // Set initial values for height processing
         smoothedTiltGain.setCurrentAndTargetValue(0.0f);
@@ -90,51 +96,46 @@ void DistanceProcessor::prepare(double sampleRate, int samplesPerBlock)
         smoothedBrightness.setCurrentAndTargetValue(1.0f);
         smoothedIldGainL.setCurrentAndTargetValue(0.707f);
         smoothedIldGainR.setCurrentAndTargetValue(0.707f);
-        smoothedEarDelayLeft.setCurrentAndTargetValue(0.0f);
-        smoothedEarDelayRight.setCurrentAndTargetValue(0.0f);
         
-        // Initialize filters - separate left and right for perfect stereo balance
-        lowPassFilterLeft.reset();
-        lowPassFilterRight.reset();
-        lowPassFilterLeft.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 1});
-        lowPassFilterRight.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 1});
+        // ISO 9613-1 air absorption - both ears share one fitted shelf cascade
+        atmosphericAbsorption.setAtmosphere(currentTemperature, currentHumidity, currentPressure);
+        atmosphericAbsorption.prepare(sampleRate, 2);
         
+        const auto identityCoeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(sampleRate, 20000.0f);
+
         // Prepare rear-hemisphere head-shadow filters (initially bypass-wide)
+        backFilterCoefficients.assign(identityCoeffs);
         backFilterLeft.reset();
         backFilterRight.reset();
-        backFilterLeft.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 1});
-        backFilterRight.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 1});
-        auto identityCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, 20000.0f);
-        *backFilterLeft.coefficients = *identityCoeffs;
-        *backFilterRight.coefficients = *identityCoeffs;
-        
+
         // Prepare height tilt filters (initially bypass)
+        heightTiltCoefficients.assign(identityCoeffs);
         heightTiltFilterLeft.reset();
         heightTiltFilterRight.reset();
-        heightTiltFilterLeft.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 1});
-        heightTiltFilterRight.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 1});
-        *heightTiltFilterLeft.coefficients = *identityCoeffs;
-        *heightTiltFilterRight.coefficients = *identityCoeffs;
         
-        // Initialize delay line
-        delayLine.reset();
-        delayLine.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 2});
-        delayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 0.5)); // 500ms max delay
+        preparePropagationDelay();
+        propagationDelay.setEarOffsets(0.0f, 0.0f);
+        propagationDelay.setDelayImmediate(0.0f);
+        isPrepared = true;
         
         // Initialize gain processor
         gainProcessor.reset();
         gainProcessor.prepare(juce::dsp::ProcessSpec{sampleRate, (juce::uint32)samplesPerBlock, 2});
         
-        // Prepare HRTF convolvers
-        juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32> (samplesPerBlock), 1 };
-        hrtfLeft.prepare (spec);
-        hrtfRight.prepare (spec);
-
-        // Load default SOFA database (fallback to unity if not found)
-        const juce::File sofaFile (juce::File::getCurrentWorkingDirectory().getChildFile ("libs/libmysofa/share/default.sofa"));
-        hrirDatabase.loadSofaFile (sofaFile.getFullPathName());
+        // Prepare HRTF filters; they pass the signal through until the first
+        // HRIR pair is published, so the chain is valid from the first block
+        hrtfFilter.prepare (samplesPerBlock);
 
-        updateHrirFilters (0.0f, 0.0f);
+        // The SOFA lookup and the frontal pair are asset work for the worker
+        // pool's first HRIR update
+        lastAzimuthDeg = lastElevationDeg = 0.0f;
+        requestedAzimuthDeg = 0.0f;
+        requestedElevationDeg = 0.0f;
+        hrirDatabasePending = true;
+        
+        workerPool->addTask (hrirUpdateTask);
+        workerPool->addTask (roomModelTask);
+        workerPool->trigger (hrirUpdateTask);
         
         juce::Logger::writeToLog("DistanceProcessor prepared successfully");
     }
@@ -143,25 +144,121 @@ void DistanceProcessor::prepare(double sampleRate, int samplesPerBlock)
     }
 }
 
+void DistanceProcessor::prepareBlockSize(int newSamplesPerBlock)
+{
+    if (newSamplesPerBlock > samplesPerBlock)
+    {
+        // The workers read the block size, so they are paused while it grows
+        workerPool->removeTask (hrirUpdateTask);
+        
+        samplesPerBlock = newSamplesPerBlock;
+        allocateScratch();
+        hrtfFilter.prepare(samplesPerBlock);
+        
+        const float delay = propagationDelay.getCurrentDelay();
+        preparePropagationDelay();
+        propagationDelay.setDelayImmediate(delay);
+        
+        workerPool->addTask (hrirUpdateTask);
+        workerPool->trigger (hrirUpdateTask);
+    }
+    
+    // A smaller block keeps the larger scratch; only the state starts over
+    reset();
+}
+
+void DistanceProcessor::allocateScratch()
+{
+    // The block scratch and the crossfeed history share one cache-line-aligned
+    // block, each channel starting on a line of its own. The buffers only refer
+    // to it, so they must never be resized; the audio thread works on views
+    constexpr int lineFloats = 16;
+    const auto roundUp = [] (int samples) { return (samples + lineFloats - 1) & ~(lineFloats - 1); };
+    
+    const int crossfeedLength = juce::jmax(1, static_cast<int>(0.0003 * sampleRate)); // 0.3 ms
+    const int blockStride = roundUp(samplesPerBlock);
+    const int crossfeedStride = roundUp(crossfeedLength);
+    
+    scratchArena.calloc((size_t) (2 * blockStride + 2 * crossfeedStride + lineFloats));
+    float* next = juce::snapPointerToAlignment(scratchArena.get(), (size_t) lineFloats * sizeof(float));
+    
+    const auto carve = [&next] (juce::AudioBuffer<float>& target, int stride, int numSamples)
+    {
+        float* channels[] = { next, next + stride };
+        target.setDataToReferTo(channels, 2, numSamples);
+        next += 2 * stride;
+    };
+    
+    carve(hrtfTempBuffer, blockStride, samplesPerBlock);
+    carve(crossfeedHistory, crossfeedStride, crossfeedLength);
+}
+
+void DistanceProcessor::preparePropagationDelay()
+{
+    // Per-ear delay line sized for the active range only. Sources move at up
+    // to half the speed of sound
+    const double maxDelaySeconds = getMaxDelaySeconds();
+    
+    propagationDelay.prepare(sampleRate, samplesPerBlock, 2, maxDelaySeconds, maxSpreadSeconds);
+    propagationDelay.setMaxSlewRate(0.5f);
+    
+    juce::Logger::writeToLog("Propagation delay: " + juce::String(maxDelaySeconds, 2) + " s, "
+                             + juce::String((double) propagationDelay.getAllocatedBytes() / 1048576.0, 2) + " MB");
+}
+
+double DistanceProcessor::getMaxDelaySeconds() const
+{
+    // The farthest source sits at the room's far corner at the ceiling, heard
+    // at the slowest speed of sound, plus the aligned-mode lead
+    const float range = getRangeLimit();
+    const double farthestSource = std::sqrt(range * range * 1.25f) + 20.0f;
+    return farthestSource / 330.0 + maxAlignedLeadSeconds;
+}
+
+double DistanceProcessor::getTailLengthSeconds() const
+{
+    // The farthest arrival, its last reflection and the longest late reverb
+    return getMaxDelaySeconds() + maxSpreadSeconds + (double) RoomModel::maxDecayTime;
+}
+
+void DistanceProcessor::setLongRange(bool shouldUseLongRange)
+{
+    if (shouldUseLongRange == longRange)
+        return;
+    
+    longRange = shouldUseLongRange;
+    
+    // Room mode clamps anything that was placed beyond its limit; the next
+    // block's setters bring the room model in line
+    currentMaxDistance = juce::jmin(currentMaxDistance, getRangeLimit());
+    currentRoomWidth   = juce::jmin(currentRoomWidth, getRangeLimit());
+    currentRoomLength  = juce::jmin(currentRoomLength, getRangeLimit());
+    
+    if (isPrepared)
+    {
+        const float delay = propagationDelay.getCurrentDelay();
+        preparePropagationDelay();
+        propagationDelay.setDelayImmediate(delay);
+    }
+}
+
 void DistanceProcessor::reset()
 {
-    lowPassFilterLeft.reset();
-    lowPassFilterRight.reset();
+    atmosphericAbsorption.reset();
+    backFilterLeft.reset();
+    backFilterRight.reset();
     heightTiltFilterLeft.reset();
     heightTiltFilterRight.reset();
-    delayLine.reset();
-    earDelayLeft.reset();
-    earDelayRight.reset();
+    propagationDelay.reset();
     gainProcessor.reset();
-    earlyReflection.reset();
+    hrtfFilter.reset();
+    crossfeedHistory.clear();
 
     smoothedDistance.setCurrentAndTargetValue (smoothedDistance.getCurrentValue());
     smoothedPan.setCurrentAndTargetValue (smoothedPan.getCurrentValue());
     smoothedGain.setCurrentAndTargetValue (smoothedGain.getCurrentValue());
-    smoothedCutoffFreq.setCurrentAndTargetValue (smoothedCutoffFreq.getCurrentValue());
     smoothedLeftPanGain.setCurrentAndTargetValue (smoothedLeftPanGain.getCurrentValue());
     smoothedRightPanGain.setCurrentAndTargetValue (smoothedRightPanGain.getCurrentValue());
-    smoothedDelayTime.setCurrentAndTargetValue (smoothedDelayTime.getCurrentValue());
 
     juce::Logger::writeToLog ("DistanceProcessor reset");
 }
@@ -174,11 +271,42 @@ void DistanceProcessor::processBlock (juce::AudioBuffer<float>& buffer, float di
     if (numSamples <= 0 || numChannels <= 0)
         return;
 
+    // Hosts may exceed the prepared block size, offline renders especially.
+    // Every stage and scratch buffer is sized for samplesPerBlock, so split
+    // rather than reallocate or overrun
+    if (numSamples > samplesPerBlock)
+    {
+        for (int start = 0; start < numSamples; start += samplesPerBlock)
+        {
+            const int chunk = juce::jmin (samplesPerBlock, numSamples - start);
+            juce::AudioBuffer<float> view (buffer.getArrayOfWritePointers(), numChannels, start, chunk);
+            processBlock (view, distance, panValue, environment);
+        }
+        return;
+    }
+
     smoothedDistance.setTargetValue (distance);
     smoothedPan.setTargetValue (panValue);
     smoothedClarity.setTargetValue (currentClarity);
+    updateRoomModel();
+
+    profiler.beginBlock (numSamples, sampleRate);
+
+    if (profiler.isTracing())
+    {
+        profiler.noteParameter (TraceRecorder::Distance, distance);
+        profiler.noteParameter (TraceRecorder::Pan, panValue);
+        profiler.noteParameter (TraceRecorder::Height, currentHeightPercent);
+        profiler.noteParameter (TraceRecorder::RoomWidth, currentRoomWidth);
+        profiler.noteParameter (TraceRecorder::RoomLength, currentRoomLength);
+        profiler.noteParameter (TraceRecorder::RoomHeight, currentRoomHeight);
+        profiler.noteParameter (TraceRecorder::AirAbsorption, currentAirAbsorption);
+        profiler.noteParameter (TraceRecorder::Temperature, currentTemperature);
+    }
 
     processDistanceEffects (buffer, distance, panValue, numSamples);
+
+    profiler.endBlock();
 }
 
 void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer, float distance, float panValue, int numSamples)
@@ -192,10 +320,35 @@ void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer,
                                                      ? distance / currentMaxDistance
                                                      : 0.0f);
 
+        // Mono sources run height, gain and air once on channel 0 and are
+        // split to stereo just before the binaural stages
+        const bool monoPath = monoInput && buffer.getNumChannels() >= 2;
+        juce::AudioBuffer<float> monoView(buffer.getArrayOfWritePointers(), 1, numSamples);
+        auto& preBuffer = monoPath ? monoView : buffer;
+        
         // CRITICAL: At exact zero distance, do nothing but basic panning
         if (distanceFactor <= 0.0f) {
+            profiler.noteTier(TraceRecorder::Transparent);
+            
+            if (monoPath)
+                buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+            
+            // Aligned mode reports latency, so the source must still arrive on time.
+            // Otherwise the ring is still fed, so moving away again glides from
+            // the undelayed signal rather than replaying audio from before the gap
+            {
+                StageProfiler::ScopedStage timer(profiler, StageProfiler::Delay);
+                propagationDelay.setEarOffsets(0.0f, 0.0f);
+                
+                if (alignedDelay)
+                    processDelayEffect(buffer, 0.0f, false, numSamples);
+                else
+                    propagationDelay.bypass(buffer, buffer.getNumChannels(), numSamples);
+            }
+            
             // Only basic equal-power panning - no spatial processing at all
             if (buffer.getNumChannels() >= 2) {
+                StageProfiler::ScopedStage timer(profiler, StageProfiler::Panning);
                 const float azRad = panValue * juce::MathConstants<float>::pi / 180.0f;
                 const float panNorm = juce::jlimit(-1.0f, 1.0f, std::sin(azRad));
                 
@@ -216,6 +369,94 @@ void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer,
         
         // Scale all spatial processing directly with the distance factor
         const float spatialProcessingAmount = distanceFactor;
+        const SourceGeometry geometry = computeSourceGeometry(distanceFactor, panValue);
+        const float true3DDistance = geometry.true3DDistance;
+        const float effectiveDistance = geometry.effectiveDistance;
+        const bool heavyLoad = geometry.heavyLoad;
+
+        // In heavy-load scenarios use a simplified path to avoid CPU spikes
+        if (heavyLoad)
+        {
+            profiler.noteTier(TraceRecorder::HeavyLoad);
+            
+            if (trueGainEnabled)
+            {
+                StageProfiler::ScopedStage timer(profiler, StageProfiler::Gain);
+                processDistanceGain(preBuffer, effectiveDistance, numSamples);
+            }
+
+            // The air low-pass is linear, so a mono source can take it before the split
+            if (monoPath)
+            {
+                StageProfiler::ScopedStage timer(profiler, StageProfiler::Air);
+                processAirAbsorption(preBuffer, effectiveDistance, numSamples);
+                buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+            }
+
+            {
+                StageProfiler::ScopedStage timer(profiler, StageProfiler::Panning);
+                smoothedPan.setTargetValue(panValue);
+                processPanning(buffer, panValue, numSamples);
+            }
+            
+            // Arrival time and ITD keep tracking the source so leaving this path never jumps
+            {
+                StageProfiler::ScopedStage timer(profiler, StageProfiler::Delay);
+                processDelayEffect(buffer, true3DDistance, false, numSamples);
+            }
+
+            if (! monoPath)
+            {
+                StageProfiler::ScopedStage timer(profiler, StageProfiler::Air);
+                processAirAbsorption(buffer, effectiveDistance, numSamples);
+            }
+            
+            // lightweight height cues still apply
+            StageProfiler::ScopedStage timer(profiler, StageProfiler::Height);
+            processHeightEffects(buffer, numSamples);
+            return; // skip expensive processing
+        }
+        
+        // Height, gain, air and panning
+        profiler.noteTier(TraceRecorder::Live);
+        processSourceStages(buffer, geometry, panValue, monoPath, numSamples);
+        
+        // Propagation delay, ITD and early reflections from one per-ear delay line.
+        // The common delay and the reflections are identical on both ears, so
+        // they commute with the width and panning stages above
+        {
+            StageProfiler::ScopedStage timer(profiler, StageProfiler::Delay);
+            processDelayEffect(buffer, true3DDistance, true, numSamples);
+        }
+
+        // OPTIONAL: Final HRTF convolution with ultra-safe scaling
+        if (!heavyLoad && spatialProcessingAmount > 0.2f)
+        {
+            StageProfiler::ScopedStage timer(profiler, StageProfiler::Hrtf);
+            const int wetChannels = juce::jmin (2, buffer.getNumChannels());
+            juce::AudioBuffer<float> wetBuffer (hrtfTempBuffer.getArrayOfWritePointers(), wetChannels, numSamples);
+            for (int ch = 0; ch < wetChannels; ++ch)
+                wetBuffer.copyFrom (ch, 0, buffer, ch, 0, numSamples);
+            processHrtfConvolution (wetBuffer);
+
+            const float ultraSafeHrtfAmount = spatialProcessingAmount * 0.3f; // Max 30%
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                float* dry = buffer.getWritePointer (ch);
+                const float* wet = ch < wetChannels ? wetBuffer.getReadPointer (ch) : dry;
+                for (int n = 0; n < numSamples; ++n)
+                {
+                    float mixed = wet[n] * ultraSafeHrtfAmount + dry[n] * (1.0f - ultraSafeHrtfAmount);
+                    dry[n] = juce::jlimit (-1.2f, 1.2f, mixed);
+                }
+            }
+        }
+}
+
+DistanceProcessor::SourceGeometry DistanceProcessor::computeSourceGeometry(float distanceFactor, float panValue) const
+{
+        SourceGeometry geometry;
+        geometry.distanceFactor = distanceFactor;
         
         // ROOM-CONNECTED SPATIAL PROCESSING with smooth scaling
         // ====================================================
@@ -225,9 +466,9 @@ void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer,
         const float actualDistanceMeters = distanceFactor * roomDepth; // 0-1 maps to 0-roomDepth meters
         
         // 2. ROOM-CONSTRAINED PANNING - Smooth panning with room boundaries
-        const float panRad = panValue * juce::MathConstants<float>::pi / 180.0f;
+        geometry.panRad = panValue * juce::MathConstants<float>::pi / 180.0f;
         const float maxLateralDistance = juce::jmax(0.5f, currentRoomWidth * 0.5f); // Minimum 0.5m
-        const float lateralDistanceMeters = std::sin(panRad) * maxLateralDistance;
+        const float lateralDistanceMeters = std::sin(geometry.panRad) * maxLateralDistance;
         const float absoluteLateralDistance = std::abs(lateralDistanceMeters);
         
         // 3. ROOM-SCALED HEIGHT - Smooth height scaling
@@ -235,9 +476,9 @@ void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer,
         const float verticalOffsetMeters = sourceHeightMeters - DistanceProcessor::listenerEarHeight;
         
         // 4. SMOOTH 3D POSITION CALCULATION
-        const float true3DDistance = std::sqrt(actualDistanceMeters * actualDistanceMeters + 
-                                              absoluteLateralDistance * absoluteLateralDistance + 
-                                              verticalOffsetMeters * verticalOffsetMeters);
+        geometry.true3DDistance = std::sqrt(actualDistanceMeters * actualDistanceMeters + 
+                                            absoluteLateralDistance * absoluteLateralDistance + 
+                                            verticalOffsetMeters * verticalOffsetMeters);
         
         // 5. ROOM SIZE PERCEPTION - Smooth scaling without hard thresholds
         const float roomVolume = currentRoomWidth * currentRoomLength * currentRoomHeight;
@@ -250,45 +491,46 @@ void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer,
         // =================================
 
         // Scale all effects by spatialProcessingAmount for smooth onset
-        const float effectiveDistance = true3DDistance * perceptualDistanceFactor;
-
-        // Skip heavy convolution/reverb when extremely far or in huge rooms
-        const bool heavyLoad = (effectiveDistance > 30.0f || currentRoomLength > 50.0f);
-
-        // In heavy-load scenarios use a simplified path to avoid CPU spikes
-        if (heavyLoad)
-        {
-            if (trueGainEnabled)
-                processDistanceGain(buffer, effectiveDistance, numSamples);
+        geometry.effectiveDistance = geometry.true3DDistance * perceptualDistanceFactor;
 
-            smoothedPan.setTargetValue(panValue);
-            processPanning(buffer, panValue, numSamples);
+        // Skip heavy convolution/reverb when the source itself is extremely far.
+        // Room size alone never does: Long Range stretches the room to its
+        // extent, and near sources there still get the full chain
+        geometry.heavyLoad = geometry.effectiveDistance > 30.0f;
+        return geometry;
+}
 
-            processAirAbsorption(buffer, effectiveDistance, numSamples);
-            // lightweight height cues still apply
-            processHeightEffects(buffer, numSamples);
-            return; // skip expensive processing
-        }
+void DistanceProcessor::processSourceStages(juce::AudioBuffer<float>& buffer, const SourceGeometry& geometry, float panValue, bool monoPath, int numSamples)
+{
+        const float spatialProcessingAmount = geometry.distanceFactor;
+        const float effectiveDistance = geometry.effectiveDistance;
+        const float panRad = geometry.panRad;
         
-        // Height effects - always process for smooth height movement
-        processHeightEffects(buffer, numSamples);
+        juce::AudioBuffer<float> monoView(buffer.getArrayOfWritePointers(), 1, numSamples);
+        auto& preBuffer = monoPath ? monoView : buffer;
         
-        // Delay effect with smooth scaling - engage immediately with tiny threshold
-        if (trueDelayEnabled && spatialProcessingAmount > 0.001f) {
-            processDelayEffect(buffer, effectiveDistance * spatialProcessingAmount, numSamples);
+        // Height effects - always process for smooth height movement
+        {
+            StageProfiler::ScopedStage timer(profiler, StageProfiler::Height);
+            processHeightEffects(preBuffer, numSamples);
         }
-
+        
         // Distance gain with smooth scaling - engage immediately with tiny threshold
         if (trueGainEnabled && spatialProcessingAmount > 0.001f) {
-            processDistanceGain(buffer, effectiveDistance * spatialProcessingAmount, numSamples);
+            StageProfiler::ScopedStage timer(profiler, StageProfiler::Gain);
+            processDistanceGain(preBuffer, effectiveDistance * spatialProcessingAmount, numSamples);
         }
 
         // Air absorption with smooth scaling - engage immediately with tiny threshold
         if (spatialProcessingAmount > 0.001f)
-            processAirAbsorption(buffer, effectiveDistance * spatialProcessingAmount, numSamples);
+        {
+            StageProfiler::ScopedStage timer(profiler, StageProfiler::Air);
+            processAirAbsorption(preBuffer, effectiveDistance * spatialProcessingAmount, numSamples);
+        }
 
-        // Early reflections
-        earlyReflection.process (buffer);
+        // Binaural split for mono sources
+        if (monoPath)
+            buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
 
         // ROOM WIDTH PERCEPTION - smooth and continuous
         // =====================================================
@@ -308,8 +550,11 @@ void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer,
         safeStereoWidth = 1.0f + (safeStereoWidth - 1.0f) * lateralPanFactor;
         
         // SAFE M/S processing - smooth width without channel swapping
-        if (buffer.getNumChannels() >= 2 && std::abs(safeStereoWidth - 1.0f) > 0.05f)
+        // (identical channels of a mono source have no side signal to widen)
+        if (buffer.getNumChannels() >= 2 && ! monoPath && std::abs(safeStereoWidth - 1.0f) > 0.05f)
         {
+            StageProfiler::ScopedStage timer(profiler, StageProfiler::Width);
+            
             // Target width evolves with distance instead of collapsing to mono
             const float targetWidth = 1.0f + (safeStereoWidth - 1.0f) * spatialProcessingAmount;
             smoothedStereoWidth.setTargetValue(targetWidth);
@@ -342,97 +587,48 @@ void DistanceProcessor::processDistanceEffects(juce::AudioBuffer<float>& buffer,
         }
         
         // SAFE ROOM-CONNECTED PANNING - Improved artifact elimination
+        StageProfiler::ScopedStage timer(profiler, StageProfiler::Panning);
         smoothedPan.setTargetValue(panValue);
         processPanning(buffer, panValue, numSamples);
-
-        // OPTIONAL: Final HRTF convolution with ultra-safe scaling
-        if (!heavyLoad && spatialProcessingAmount > 0.2f)
-        {
-            hrtfTempBuffer.makeCopyOf (buffer);
-            processHrtfConvolution (hrtfTempBuffer);
-
-            const float ultraSafeHrtfAmount = spatialProcessingAmount * 0.3f; // Max 30%
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            {
-                float* dry = buffer.getWritePointer (ch);
-                const float* wet = hrtfTempBuffer.getReadPointer (ch);
-                for (int n = 0; n < numSamples; ++n)
-                {
-                    float mixed = wet[n] * ultraSafeHrtfAmount + dry[n] * (1.0f - ultraSafeHrtfAmount);
-                    dry[n] = juce::jlimit (-1.2f, 1.2f, mixed);
-                }
-            }
-        }
 }
 
-void DistanceProcessor::processDelayEffect(juce::AudioBuffer<float>& buffer, float distance, int numSamples)
+void DistanceProcessor::processDelayEffect(juce::AudioBuffer<float>& buffer, float distance, bool withReflections, int numSamples)
 {
-    try {
-        // distance is already in meters, use it directly
-        const float actualDistance = distance;
-        
-        // CRITICAL: Complete bypass at 0% distance for perfect transparency
-        if (actualDistance <= 0.0f) {
-            // Ensure smoothed delay is set to zero for perfect bypass
-            smoothedDelayTime.setCurrentAndTargetValue(0.0f);
-            return; // No processing at all - completely transparent
-        }
-        
-        // FIXED: Smooth gradual onset instead of hard cutoff
-        // Calculate smooth transition factor from 0m to 1m
-        float delayStrength = 1.0f;
-        if (actualDistance <= 1.0f) {
-            // Smooth cubic curve from 0 to 1 over 1 meter
-            delayStrength = actualDistance * actualDistance * actualDistance; // cubic ease-in
-            delayStrength = juce::jlimit(0.0f, 1.0f, delayStrength);
-        }
-        
-        // Apply minimal delay even at very close distances for smoothness
-        float minDelayTime = 0.001f; // 1ms minimum delay
-        
-        // FIXED: Calculate delay time using temperature-adjusted speed of sound
-        const float delayTimeSeconds = (actualDistance / speedOfSound) + minDelayTime;
-        const float delayTimeSamples = delayTimeSeconds * static_cast<float>(sampleRate);
-        
-        // Smart delay time handling to prevent artifacts
-        float currentDelayTime = smoothedDelayTime.getCurrentValue();
-        float targetDelayTime = delayTimeSamples;
-        float delayChange = std::abs(targetDelayTime - currentDelayTime);
-        
-        // If change is very small (< 1 sample), apply immediately
-        if (delayChange < 1.0f) {
-            smoothedDelayTime.setCurrentAndTargetValue(targetDelayTime);
-        } else {
-            smoothedDelayTime.setTargetValue(targetDelayTime);
-        }
+    // True propagation delay: the whole signal arrives distance / c later.
+    // The delay ramps across the block, which produces the Doppler shift of a
+    // moving source; a static delay runs as a block copy or fixed-coefficient FIR.
+    // Each ear adds its ITD (set by processPanning) to the same read position
+    const float samplesPerSecond = static_cast<float>(sampleRate);
+    float delaySamples = trueDelayEnabled ? juce::jmax(0.0f, distance) / speedOfSound * samplesPerSecond : 0.0f;
+    
+    // Aligned: the host compensates the reported latency, so render that lead
+    // plus the delay relative to the reference distance. The latency only
+    // covers the capped lead, so a farther reference is held at the cap and
+    // nearer sources keep their delays relative to each other
+    if (alignedDelay)
+    {
+        const float referenceSeconds = juce::jmin(maxAlignedLeadSeconds, referenceDistance / speedOfSound);
+        const float referenceDelay = trueDelayEnabled ? referenceSeconds * samplesPerSecond : 0.0f;
+        delaySamples = static_cast<float>(reportedLatencySamples) + delaySamples - referenceDelay;
+    }
+    
+    propagationDelay.setDelay(delaySamples);
+    
+    if (withReflections)
+    {
+        std::array<float, EarlyReflectionIR::numReflections> reflectionDelays;
         
-        // Process delay with smooth strength factor
-        for (int sample = 0; sample < numSamples; ++sample)
-        {
-            float currentDelayTimeSamples = smoothedDelayTime.getNextValue();
-            
-            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-            {
-                float inputSample = buffer.getSample(channel, sample);
-                
-                // Get delayed sample
-                float delayedSample = delayLine.popSample(channel, currentDelayTimeSamples);
-                
-                // Mix original and delayed signal with smooth strength
-                float mixedSample = inputSample * (1.0f - delayStrength * 0.1f) + delayedSample * delayStrength * 0.1f;
-                
-                // Push input into delay line
-                delayLine.pushSample(channel, inputSample);
-                
-                // Set output sample
-                buffer.setSample(channel, sample, mixedSample);
-            }
-        }
+        for (size_t i = 0; i < reflectionDelays.size(); ++i)
+            reflectionDelays[i] = room->reflectionDelays[i] * samplesPerSecond;
         
+        propagationDelay.setReflections(reflectionDelays.data(), room->reflectionGains.data(), EarlyReflectionIR::numReflections);
     }
-    catch (const std::exception& e) {
-        juce::Logger::writeToLog("processDelayEffect error: " + juce::String(e.what()));
+    else
+    {
+        propagationDelay.setReflections(nullptr, nullptr, 0);
     }
+    
+    propagationDelay.process(buffer, buffer.getNumChannels(), numSamples);
 }
 
 void DistanceProcessor::processDistanceGain(juce::AudioBuffer<float>& buffer, float distance, int numSamples)
@@ -447,24 +643,7 @@ void DistanceProcessor::processDistanceGain(juce::AudioBuffer<float>& buffer, fl
             return;
         }
  
-        // Map distance to gain with a smooth transition over the first meter
-        // Start at unity (0 m) and reach the 1/d law by 1 m to avoid abrupt drops
-        const float inverseDistance = 1.0f / juce::jmax(1.0f, actualDistance);
-        const float ramp = juce::jlimit(0.0f, 1.0f, actualDistance); // 0..1 over first meter
-        float finalGain = juce::jmap(ramp, 0.0f, 1.0f, 1.0f, inverseDistance);
- 
-        // Optional volume-compensation curve (0..1)
-        // Instead of forcing the gain toward unity, scale the attenuation
-        // exponent so that higher values reduce the rate at which volume
-        // decreases with distance.
-        if (currentVolumeCompensation > 0.0f)
-        {
-            const float exponent = 1.0f - juce::jlimit(0.0f, 1.0f, currentVolumeCompensation);
-            finalGain = std::pow(finalGain, exponent);
-        }
- 
-        // Floor at −60 dB to avoid denormals
-        finalGain = juce::jmax(finalGain, 0.001f);
+        const float finalGain = computeDistanceGain(actualDistance, currentVolumeCompensation);
  
         smoothedGain.setTargetValue(finalGain);
  
@@ -475,81 +654,67 @@ void DistanceProcessor::processDistanceGain(juce::AudioBuffer<float>& buffer, fl
                 ptr[s] *= smoothedGain.getNextValue();
         }
     }
-    catch (const std::exception& e) {
-        juce::Logger::writeToLog("processDistanceGain error: " + juce::String(e.what()));
+    catch (const std::exception&) {
+        reportStageError(StageProfiler::Gain);
     }
 }
 
 void DistanceProcessor::processAirAbsorption(juce::AudioBuffer<float>& buffer, float distance, int numSamples)
 {
     try {
-        const float actualDistance = distance;
- 
-        if (actualDistance <= 0.0f)
-        {
-            smoothedCutoffFreq.setCurrentAndTargetValue(20000.0f);
-            lowPassFilterLeft.reset();
-            lowPassFilterRight.reset();
-            lastCutoffFreq = 20000.0f;
-            return;
-        }
- 
-        // If the user has set Air Absorption to 0 %, keep the full bandwidth.
-        if (currentAirAbsorption <= 0.0001f)
-        {
-            smoothedCutoffFreq.setCurrentAndTargetValue(20000.0f);
-            lowPassFilterLeft.reset();
-            lowPassFilterRight.reset();
-            lastCutoffFreq = 20000.0f;
-            return; // Bypass filtering entirely
-        }
- 
-        // MUCH MORE SUBTLE air absorption - like dearVR MICRO
-        // Only subtle high-frequency roll-off, never aggressive frequency deletion
-        float targetCutoff = 20000.0f; // Start with full bandwidth
-        
-        // Very gentle distance-based HF roll-off
-        if (actualDistance > 1.0f) {
-            // Gentle logarithmic curve - much more subtle than before
-            float distanceFactor = std::log(actualDistance) / std::log(20.0f); // 0 to 1 over 1m to 20m
-            distanceFactor = juce::jlimit(0.0f, 1.0f, distanceFactor);
-            
-            // Subtle cutoff reduction: 20kHz down to 8kHz maximum
-            targetCutoff = 20000.0f - distanceFactor * 12000.0f;
-        }
-        
-        // User air-absorption parameter adds subtle extra HF roll-off
-        const float userEffect = currentAirAbsorption * 0.3f; // Much more subtle multiplier
-        const float distanceRatio = currentMaxDistance > 0.0f ? juce::jlimit(0.0f, 1.0f, actualDistance / currentMaxDistance) : 0.0f;
-        targetCutoff -= userEffect * 3000.0f * distanceRatio; // Maximum 3kHz reduction instead of 4kHz
-        
-        // CRITICAL: Never go below 5kHz - preserve musical content
-        targetCutoff = juce::jlimit(5000.0f, 20000.0f, targetCutoff);
- 
-        smoothedCutoffFreq.setTargetValue(targetCutoff);
-        const float currentCutoff = smoothedCutoffFreq.getNextValue();
-        if (std::abs(currentCutoff - lastCutoffFreq) > 50.0f) // Less frequent updates
-        {
-            // Use gentler filter slope (0.5 Q instead of 0.707)
-            auto coeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, currentCutoff, 0.5f);
-            *lowPassFilterLeft.coefficients  = *coeffs;
-            *lowPassFilterRight.coefficients = *coeffs;
-            lastCutoffFreq = currentCutoff;
-        }
- 
-        // Apply filter only if cutoff is below 18kHz (avoid unnecessary processing)
-        if (currentCutoff < 18000.0f) {
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            {
-                auto* ptr = buffer.getWritePointer(ch);
-                for (int s = 0; s < numSamples; ++s)
-                    ptr[s] = (ch == 0 ? lowPassFilterLeft : lowPassFilterRight).processSample(ptr[s]);
-            }
-        }
+        // Table and fit are only rebuilt when the atmosphere or path has moved
+        atmosphericAbsorption.setAtmosphere(currentTemperature, currentHumidity, currentPressure);
+        atmosphericAbsorption.setFidelity(currentAirAbsorptionMode == AirAbsorptionB ? AtmosphericAbsorption::Accurate
+                                                                                     : AtmosphericAbsorption::Fast);
+        atmosphericAbsorption.setPathLength(computeAirPathLength(distance, currentAirAbsorption));
+        atmosphericAbsorption.process(buffer, buffer.getNumChannels(), numSamples);
     }
-    catch (const std::exception& e) {
-        juce::Logger::writeToLog("processAirAbsorption error: " + juce::String(e.what()));
+    catch (const std::exception&) {
+        reportStageError(StageProfiler::Air);
+    }
+}
+
+void DistanceProcessor::reportStageError(StageProfiler::Stage stage)
+{
+    // Runs on the audio thread, so it never formats or writes to juce::Logger:
+    // the error goes through the real-time safe ring, or is only counted
+    if (eventLog != nullptr)
+        eventLog->push(AudioThreadLog::StageException, (float) stage);
+    else
+        unreportedStageErrors.fetch_add(1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+float DistanceProcessor::computeDistanceGain(float distance, float volumeCompensation)
+{
+    if (distance <= 0.0f)
+        return 1.0f;
+
+    // Map distance to gain with a smooth transition over the first meter
+    // Start at unity (0 m) and reach the 1/d law by 1 m to avoid abrupt drops
+    const float inverseDistance = 1.0f / juce::jmax(1.0f, distance);
+    const float ramp = juce::jlimit(0.0f, 1.0f, distance); // 0..1 over first meter
+    float finalGain = juce::jmap(ramp, 0.0f, 1.0f, 1.0f, inverseDistance);
+
+    // Optional volume-compensation curve (0..1)
+    // Instead of forcing the gain toward unity, scale the attenuation
+    // exponent so that higher values reduce the rate at which volume
+    // decreases with distance.
+    if (volumeCompensation > 0.0f)
+    {
+        const float exponent = 1.0f - juce::jlimit(0.0f, 1.0f, volumeCompensation);
+        finalGain = std::pow(finalGain, exponent);
     }
+
+    // Floor at −60 dB to avoid denormals
+    return juce::jmax(finalGain, 0.001f);
+}
+
+float DistanceProcessor::computeAirPathLength(float distance, float airAbsorption)
+{
+    // Air Absorption scales the ISO attenuation: 50 % is the standard
+    // atmosphere's real loss, 100 % doubles it for small rooms
+    return airAbsorption > 0.0001f ? juce::jmax(0.0f, distance) * airAbsorption * 2.0f : 0.0f;
 }
 
 void DistanceProcessor::processStereoWidth(juce::AudioBuffer<float>& buffer, float distance, int numSamples)
@@ -608,8 +773,8 @@ void DistanceProcessor::processStereoWidth(juce::AudioBuffer<float>& buffer, flo
         }
         
     }
-    catch (const std::exception& e) {
-        juce::Logger::writeToLog("processStereoWidth error: " + juce::String(e.what()));
+    catch (const std::exception&) {
+        reportStageError(StageProfiler::Width);
     }
 }
 
@@ -691,17 +856,17 @@ void DistanceProcessor::processPanning(juce::AudioBuffer<float>& buffer, float p
             
             // Smooth cutoff changes to prevent artifacts
             smoothedShadowCutoff.setTargetValue(shadowCutoff);
-            const float currentShadowCutoff = smoothedShadowCutoff.getNextValue();
+            const float currentShadowCutoff = smoothedShadowCutoff.skip(numSamples);
             
             // Update head shadow filters only when needed and with smooth transitions
             if (std::abs(currentShadowCutoff - lastShadowCutoff) > 200.0f) // Less frequent updates
             {
-                // Very gentle high-shelf reduction with room-aware intensity
+                // Very gentle high-shelf reduction with room-aware intensity. The array
+                // form is computed in place; the ref-counted factory would allocate
                 const float attenuationDb = -2.0f * roomAwareShadowIntensity; // Max -2dB, room-aware
-                auto shadowCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, currentShadowCutoff, 0.707f, 
-                                                                                       juce::Decibels::decibelsToGain(attenuationDb));
-                *backFilterLeft.coefficients = *shadowCoeffs;
-                *backFilterRight.coefficients = *shadowCoeffs;
+                const auto shadowCoeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf(sampleRate, currentShadowCutoff, 0.707f,
+                                                                                                  juce::Decibels::decibelsToGain(attenuationDb));
+                backFilterCoefficients.assign(shadowCoeffs);
                 lastShadowCutoff = currentShadowCutoff;
             }
             
@@ -711,8 +876,8 @@ void DistanceProcessor::processPanning(juce::AudioBuffer<float>& buffer, float p
             
             for (int n = 0; n < numSamples; ++n)
             {
-                left[n] = backFilterLeft.processSample(left[n]);
-                right[n] = backFilterRight.processSample(right[n]);
+                left[n] = backFilterLeft.processSample(backFilterCoefficients, left[n]);
+                right[n] = backFilterRight.processSample(backFilterCoefficients, right[n]);
             }
         }
         
@@ -763,42 +928,11 @@ void DistanceProcessor::processPanning(juce::AudioBuffer<float>& buffer, float p
         smoothedBrightness.setTargetValue(brightnessFactor);
         
         // PROCESS ROOM-AWARE SPATIAL EFFECTS
-        for (int n = 0; n < numSamples; ++n)
-        {
-            float leftSample = buffer.getSample(0, n);
-            float rightSample = buffer.getSample(1, n);
-            
-            // Apply smooth room-aware front/back stereo width
-            const float currentWidth = smoothedFrontBackWidth.getNextValue();
-            float midSample = (leftSample + rightSample) * 0.5f;
-            float sideSample = (leftSample - rightSample) * 0.5f;
-            sideSample *= currentWidth;
-            
-            // Apply smooth room-aware phase effects for back sources - FIXED artifacts
-            const float currentPhaseShift = smoothedPhaseShift.getNextValue();
-            if (currentPhaseShift > 0.001f) {
-                // SAFE phase accumulation with proper bounds
-                phaseAccumulator += currentPhaseShift * 0.005f; // Even slower accumulation
-                phaseAccumulator = std::fmod(phaseAccumulator, 1.0f); // Safe modulo
-                phaseAccumulator = juce::jlimit(0.0f, 1.0f, phaseAccumulator); // Safety bounds
-                
-                // SAFE phase effect - much more conservative
-                const float safePhaseEffect = phaseAccumulator * 0.05f; // Reduced from 0.1f
-                sideSample = sideSample * (1.0f - safePhaseEffect);
-                sideSample = juce::jlimit(-2.0f, 2.0f, sideSample); // Safety bounds
-            }
-            
-            // Apply smooth room-aware brightness changes
-            const float currentBrightness = smoothedBrightness.getNextValue();
-            leftSample = leftSample * currentBrightness;
-            rightSample = rightSample * currentBrightness;
-            
-            // SAFE stereo reconstruction with bounds checking
-            const float newLeft = juce::jlimit(-2.0f, 2.0f, midSample + sideSample);
-            const float newRight = juce::jlimit(-2.0f, 2.0f, midSample - sideSample);
-            buffer.setSample(0, n, newLeft);
-            buffer.setSample(1, n, newRight);
-        }
+        // The phase effect only runs while its smoother is above threshold
+        if (smoothedPhaseShift.isSmoothing() || smoothedPhaseShift.getTargetValue() > 0.001f)
+            runPanningKernel<true>(buffer, numSamples);
+        else
+            runPanningKernel<false>(buffer, numSamples);
 
         // ROOM-AWARE ILD/ITD PROCESSING
         // Inter-aural level difference (ILD) using equal-power law with room scaling
@@ -826,43 +960,30 @@ void DistanceProcessor::processPanning(juce::AudioBuffer<float>& buffer, float p
         const float delayLeftSamples  = delayLeftSec  * static_cast<float> (sampleRate);
         const float delayRightSamples = delayRightSec * static_cast<float> (sampleRate);
 
-        // Smooth ITD changes to prevent artifacts
-        smoothedEarDelayLeft.setTargetValue (delayLeftSamples);
-        smoothedEarDelayRight.setTargetValue(delayRightSamples);
+        // The ITD is read from the per-ear propagation delay line, ramped per block
+        propagationDelay.setEarOffsets (delayLeftSamples, delayRightSamples);
 
         auto* left  = buffer.getWritePointer (0);
         auto* right = buffer.getWritePointer (1);
 
-        // Process with smooth room-aware ITD + ILD
+        // Apply smooth room-aware ILD gains
         for (int n = 0; n < numSamples; ++n)
         {
-            const float delayL = smoothedEarDelayLeft.getNextValue();
-            const float delayR = smoothedEarDelayRight.getNextValue();
-            
-            const float currentGainL = smoothedIldGainL.getNextValue();
-            const float currentGainR = smoothedIldGainR.getNextValue();
-
-            // Apply ITD via delay lines
-            earDelayLeft.pushSample (0, left[n]);
-            earDelayRight.pushSample(0, right[n]);
-
-            const float delayedL = earDelayLeft.popSample (0, delayL);
-            const float delayedR = earDelayRight.popSample(0, delayR);
-
-            // Apply smooth room-aware ILD gains
-            left[n]  = delayedL * currentGainL;
-            right[n] = delayedR * currentGainR;
+            left[n]  *= smoothedIldGainL.getNextValue();
+            right[n] *= smoothedIldGainR.getNextValue();
         }
     }
-    catch (const std::exception& e) {
-        juce::Logger::writeToLog("DistanceProcessor processPanning error: " + juce::String(e.what()));
+    catch (const std::exception&) {
+        reportStageError(StageProfiler::Panning);
     }
 }
 
 void DistanceProcessor::processHeightEffects(juce::AudioBuffer<float>& buffer, int numSamples)
 {
     try {
-        if (buffer.getNumChannels() < 2 || numSamples <= 0) return;
+        // A single channel is only processed for the mono-in/stereo-out path
+        const bool stereo = buffer.getNumChannels() >= 2;
+        if ((! stereo && ! monoInput) || numSamples <= 0) return;
         
         
         // Calculate height position with room connection
@@ -883,28 +1004,23 @@ void DistanceProcessor::processHeightEffects(juce::AudioBuffer<float>& buffer, i
         
         // Smooth tilt gain changes
         smoothedTiltGain.setTargetValue(dramaticTiltGain);
-        const float currentTiltGain = smoothedTiltGain.getNextValue();
+        const float currentTiltGain = smoothedTiltGain.skip(numSamples);
         
         // Update filter coefficients when needed
         if (std::abs(currentTiltGain - lastTiltGain) > 0.5f) {
             try {
                 if (sampleRate > 0.0 && tiltFreq > 0.0f && tiltFreq < sampleRate * 0.5f) {
+                    // Array coefficients: no allocation on the audio thread
                     if (currentTiltGain > 0) {
                         // Above center: high-shelf boost
-                        auto tiltCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
+                        const auto tiltCoeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf(
                             sampleRate, tiltFreq, 0.707f, juce::Decibels::decibelsToGain(currentTiltGain));
-                        if (tiltCoeffs != nullptr) {
-                            *heightTiltFilterLeft.coefficients = *tiltCoeffs;
-                            *heightTiltFilterRight.coefficients = *tiltCoeffs;
-                        }
+                        heightTiltCoefficients.assign(tiltCoeffs); // shared by both ears
                     } else if (currentTiltGain < 0) {
                         // Below center: low-pass filtering
-                        auto tiltCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
+                        const auto tiltCoeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeLowShelf(
                             sampleRate, tiltFreq, 0.707f, juce::Decibels::decibelsToGain(-currentTiltGain));
-                        if (tiltCoeffs != nullptr) {
-                            *heightTiltFilterLeft.coefficients = *tiltCoeffs;
-                            *heightTiltFilterRight.coefficients = *tiltCoeffs;
-                        }
+                        heightTiltCoefficients.assign(tiltCoeffs); // shared by both ears
                     }
                     lastTiltGain = currentTiltGain;
                 }
@@ -925,107 +1041,211 @@ void DistanceProcessor::processHeightEffects(juce::AudioBuffer<float>& buffer, i
         const float heightGainModulation = 1.0f + clampedHeightDeviation * 0.05f;
         
         // Process height effects with dramatic changes
-        for (int sample = 0; sample < numSamples; ++sample)
+        int kernel = 0;
+        if (stereo)
+            kernel |= stereoKernel;
+        if (std::abs(currentTiltGain) > 0.1f)
+            kernel |= tiltKernel;
+        if (stereo && std::abs(phaseShiftAmount) > 0.03f)
+            kernel |= sideBlendKernel;
+        
+        (this->*heightKernels[(size_t) kernel])(buffer, numSamples, std::cos(phaseShiftRadians), heightGainModulation);
+    }
+    catch (const std::exception&) {
+        reportStageError(StageProfiler::Height);
+        // Clear buffer on error to prevent further issues
+        buffer.clear();
+    }
+}
+
+//==============================================================================
+template <bool stereo, bool tilt, bool sideBlend>
+void DistanceProcessor::runHeightKernel(juce::AudioBuffer<float>& buffer, int numSamples, float sideBlendCos, float heightGain)
+{
+    float* left = buffer.getWritePointer(0);
+    
+    if constexpr (! stereo)
+    {
+        // Mono source: no side signal, so only tilt and gain apply
+        for (int n = 0; n < numSamples; ++n)
         {
-            float leftSample = buffer.getSample(0, sample);
-            float rightSample = buffer.getSample(1, sample);
+            float monoSample = left[n];
+            if constexpr (tilt)
+                monoSample = heightTiltFilterLeft.processSample(heightTiltCoefficients, monoSample);
             
-            if (std::abs(currentTiltGain) > 0.1f) {
-                leftSample = heightTiltFilterLeft.processSample(leftSample);
-                rightSample = heightTiltFilterRight.processSample(rightSample);
+            left[n] = juce::jlimit(-2.0f, 2.0f, monoSample * heightGain);
+        }
+        
+        smoothedHeightWidth.skip(numSamples);
+    }
+    else
+    {
+        float* right = buffer.getWritePointer(1);
+        
+        for (int n = 0; n < numSamples; ++n)
+        {
+            float leftSample = left[n];
+            float rightSample = right[n];
+            
+            if constexpr (tilt)
+            {
+                leftSample = heightTiltFilterLeft.processSample(heightTiltCoefficients, leftSample);
+                rightSample = heightTiltFilterRight.processSample(heightTiltCoefficients, rightSample);
             }
             
             // Apply dramatic height-based stereo width
             const float currentWidthFactor = smoothedHeightWidth.getNextValue();
-            float midSample = (leftSample + rightSample) * 0.5f;
+            const float midSample = (leftSample + rightSample) * 0.5f;
             float sideSample = (leftSample - rightSample) * 0.5f;
             sideSample *= currentWidthFactor;
             
-            if (std::abs(phaseShiftAmount) > 0.03f) {
-                float phaseShiftedSide = sideSample * std::cos(phaseShiftRadians);
+            if constexpr (sideBlend)
+            {
+                const float phaseShiftedSide = sideSample * sideBlendCos;
                 sideSample = sideSample * 0.8f + phaseShiftedSide * 0.2f;
             }
             
-            // Reconstruct left/right with dramatic changes
-            leftSample = midSample + sideSample;
-            rightSample = midSample - sideSample;
-            
-            // Apply dramatic height-based gain modulation
-            leftSample *= heightGainModulation;
-            rightSample *= heightGainModulation;
-            
-            // Apply safe output limiting
-            leftSample = juce::jlimit(-2.0f, 2.0f, leftSample);
-            rightSample = juce::jlimit(-2.0f, 2.0f, rightSample);
-            
-            buffer.setSample(0, sample, leftSample);
-            buffer.setSample(1, sample, rightSample);
+            // Reconstruct, apply the height gain and limit
+            left[n]  = juce::jlimit(-2.0f, 2.0f, (midSample + sideSample) * heightGain);
+            right[n] = juce::jlimit(-2.0f, 2.0f, (midSample - sideSample) * heightGain);
         }
-        
-    }
-    catch (const std::exception& e) {
-        juce::Logger::writeToLog("processHeightEffects error: " + juce::String(e.what()));
-        // Clear buffer on error to prevent further issues
-        buffer.clear();
     }
 }
 
-void DistanceProcessor::updateEnvironmentParameters (Environment env)
+template <bool rearPhase>
+void DistanceProcessor::runPanningKernel(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    EnvironmentParams params{};
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
+    
+    for (int n = 0; n < numSamples; ++n)
+    {
+        // Apply smooth room-aware front/back stereo width
+        const float currentWidth = smoothedFrontBackWidth.getNextValue();
+        const float midSample = (left[n] + right[n]) * 0.5f;
+        float sideSample = (left[n] - right[n]) * 0.5f;
+        sideSample *= currentWidth;
+        
+        // Apply smooth room-aware phase effects for back sources - FIXED artifacts
+        if constexpr (rearPhase)
+        {
+            const float currentPhaseShift = smoothedPhaseShift.getNextValue();
+            if (currentPhaseShift > 0.001f) {
+                // SAFE phase accumulation with proper bounds
+                phaseAccumulator += currentPhaseShift * 0.005f; // Even slower accumulation
+                phaseAccumulator = std::fmod(phaseAccumulator, 1.0f); // Safe modulo
+                phaseAccumulator = juce::jlimit(0.0f, 1.0f, phaseAccumulator); // Safety bounds
+                
+                // SAFE phase effect - much more conservative
+                const float safePhaseEffect = phaseAccumulator * 0.05f; // Reduced from 0.1f
+                sideSample = sideSample * (1.0f - safePhaseEffect);
+                sideSample = juce::jlimit(-2.0f, 2.0f, sideSample); // Safety bounds
+            }
+        }
+        
+        // SAFE stereo reconstruction with bounds checking
+        left[n]  = juce::jlimit(-2.0f, 2.0f, midSample + sideSample);
+        right[n] = juce::jlimit(-2.0f, 2.0f, midSample - sideSample);
+    }
+    
+    if constexpr (! rearPhase)
+        smoothedPhaseShift.skip(numSamples);
+    
+    // The output is rebuilt from mid and side alone, so brightness only
+    // advances its smoother
+    smoothedBrightness.skip(numSamples);
+}
 
-    // Calculate room volume and surface area for realistic acoustics
-    const float roomVolume  = currentRoomWidth * currentRoomLength * currentRoomHeight;
-    const float surfaceArea = 2.0f * (currentRoomWidth * currentRoomLength +
-                                     currentRoomWidth * currentRoomHeight +
-                                     currentRoomLength * currentRoomHeight);
+const std::array<DistanceProcessor::HeightKernel, DistanceProcessor::numHeightKernels> DistanceProcessor::heightKernels
+{
+    &DistanceProcessor::runHeightKernel<false, false, false>,
+    &DistanceProcessor::runHeightKernel<true,  false, false>,
+    &DistanceProcessor::runHeightKernel<false, true,  false>,
+    &DistanceProcessor::runHeightKernel<true,  true,  false>,
+    &DistanceProcessor::runHeightKernel<false, false, true>,  // unused: mono has no side blend
+    &DistanceProcessor::runHeightKernel<true,  false, true>,
+    &DistanceProcessor::runHeightKernel<false, true,  true>,  // unused: mono has no side blend
+    &DistanceProcessor::runHeightKernel<true,  true,  true>
+};
+
+RoomModel::Inputs DistanceProcessor::getEnvironmentPreset (Environment environment)
+{
+    RoomModel::Inputs preset;
 
-    const float avgAbsorption = 0.1f + currentAirAbsorption * 0.4f; // 0.1 .. 0.5
-    const float rt60 = 0.161f * roomVolume / juce::jmax (0.0001f, surfaceArea * avgAbsorption);
+    switch (environment)
+    {
+        case Room:   preset.width = 6.0f;  preset.height = 3.0f;  preset.length = 8.0f;  preset.maxDistance = 20.0f; preset.airAbsorption = 0.3f; break;
+        case Studio: preset.width = 8.0f;  preset.height = 3.0f;  preset.length = 10.0f; preset.maxDistance = 25.0f; preset.airAbsorption = 0.2f; break;
+        case Hall:   preset.width = 20.0f; preset.height = 10.0f; preset.length = 30.0f; preset.maxDistance = 60.0f; preset.airAbsorption = 0.1f; break;
+        case Cave:   preset.width = 15.0f; preset.height = 6.0f;  preset.length = 25.0f; preset.maxDistance = 40.0f; preset.airAbsorption = 0.05f; break;
+        case numEnvironments:
+        default:     break;
+    }
 
-    params.roomSize = juce::jlimit (0.1f, 4.0f, std::pow (roomVolume / 150.0f, 0.33f));
-    params.decayTime = juce::jlimit (0.2f, 8.0f, rt60);
+    return preset;
+}
 
-    const float hfAbsorption = avgAbsorption * (1.0f + currentAirAbsorption * 2.0f);
-    params.damping = juce::jlimit (0.02f, 0.95f, hfAbsorption);
+void DistanceProcessor::setEnvironmentType (Environment envType)
+{
+    envType = static_cast<Environment> (juce::jlimit (0, numEnvironments - 1, (int) envType));
+    currentEnvironment = envType;
 
-    const float reverbFactor = (1.0f - avgAbsorption) * params.roomSize * 0.15f;
-    params.reverbLevel = juce::jlimit (0.0f, 0.4f, reverbFactor);
+    // The room model follows at the next block, like any other room change
+    const auto preset = getEnvironmentPreset (envType);
+    currentRoomWidth     = preset.width;
+    currentRoomHeight    = preset.height;
+    currentRoomLength    = preset.length;
+    currentMaxDistance   = preset.maxDistance;
+    currentAirAbsorption = preset.airAbsorption;
+}
 
-    const float maxDimension = juce::jmax (currentRoomWidth, currentRoomLength, currentRoomHeight);
-    params.preDelay = juce::jlimit (1.0f, 100.0f, maxDimension * 2.9f);
+float DistanceProcessor::getMaxDistanceForEnvironment (Environment envType) const
+{
+    return getEnvironmentPreset (envType).maxDistance;
+}
 
-    const float aspectRatio = juce::jmax (currentRoomWidth, currentRoomLength) /
-                              juce::jmin (currentRoomWidth, currentRoomLength);
-    params.diffusion = juce::jlimit (0.1f, 1.0f, 1.0f / aspectRatio);
+void DistanceProcessor::setAlignedDelay(bool shouldAlign, float referenceDistanceMeters)
+{
+    alignedDelay = shouldAlign;
+    referenceDistance = juce::jmax(0.0f, referenceDistanceMeters);
+}
 
-    params.airAbsorptionCoeff = currentAirAbsorption;
-    params.maxDistance        = currentMaxDistance;
+int DistanceProcessor::getRequiredLatency() const
+{
+    if (! alignedDelay)
+        return 0;
+    
+    // Nominal speed of sound keeps the latency fixed while temperature changes;
+    // the lead is capped so a far reference cannot demand a huge buffer
+    const float leadSeconds = juce::jmin(maxAlignedLeadSeconds, referenceDistance / nominalSpeedOfSound);
+    return juce::roundToInt(leadSeconds * static_cast<float>(sampleRate) + propagationDelay.getMinimumDelay());
+}
 
-    environmentSettings[env] = params;
+juce::Reverb::Parameters DistanceProcessor::getLateReverbParameters() const
+{
+    return room->lateReverb;
 }
 
-void DistanceProcessor::setEnvironmentType (Environment envType)
+void DistanceProcessor::updateRoomModel()
 {
-    envType = static_cast<Environment> (juce::jlimit (0, numEnvironments - 1, (int) envType));
-    currentEnvironment = envType;
+    const RoomModel::Inputs inputs { currentRoomWidth, currentRoomHeight, currentRoomLength,
+                                     currentMaxDistance, currentAirAbsorption, currentTemperature };
 
-    switch (envType)
+    // Room changes cost the audio thread a comparison and a request; the model
+    // itself is built on the worker
+    if (inputs != requestedRoom)
     {
-        case Room:   currentRoomWidth = 6.0f;  currentRoomHeight = 3.0f;  currentRoomLength = 8.0f;  currentMaxDistance = 20.0f; currentAirAbsorption = 0.3f; break;
-        case Studio: currentRoomWidth = 8.0f;  currentRoomHeight = 3.0f;  currentRoomLength = 10.0f; currentMaxDistance = 25.0f; currentAirAbsorption = 0.2f; break;
-        case Hall:   currentRoomWidth = 20.0f; currentRoomHeight = 10.0f; currentRoomLength = 30.0f; currentMaxDistance = 60.0f; currentAirAbsorption = 0.1f; break;
-        case Cave:   currentRoomWidth = 15.0f; currentRoomHeight = 6.0f;  currentRoomLength = 25.0f; currentMaxDistance = 40.0f; currentAirAbsorption = 0.05f; break;
-        default:     break;
+        requestedRoom = inputs;
+        roomModels.request (inputs);
+        workerPool->trigger (roomModelTask);
     }
 
-    earlyReflection.setRoomDimensions (currentRoomWidth, currentRoomHeight, currentRoomLength);
-    updateEnvironmentParameters (envType);
+    room = &roomModels.acquire();
 }
 
-float DistanceProcessor::getMaxDistanceForEnvironment (Environment envType) const
+void DistanceProcessor::buildRoomModel()
 {
-    return environmentSettings[envType].maxDistance;
+    roomModels.publish (std::make_unique<RoomModel> (roomModels.getRequest()));
 }
 
 //==============================================================================
@@ -1037,16 +1257,12 @@ void DistanceProcessor::setDistance(float distanceMeters)
 
 void DistanceProcessor::setMaxDistance(float maxDistanceMeters)
 {
-    currentMaxDistance = juce::jlimit(5.0f, 100.0f, maxDistanceMeters);
-    // Update the current environment's max distance
-    environmentSettings[currentEnvironment].maxDistance = currentMaxDistance;
+    currentMaxDistance = juce::jlimit(5.0f, getRangeLimit(), maxDistanceMeters);
 }
 
 void DistanceProcessor::setAirAbsorption(float absorption)
 {
     currentAirAbsorption = juce::jlimit(0.0f, 1.0f, absorption);
-    // Update the current environment's air absorption
-    environmentSettings[currentEnvironment].airAbsorptionCoeff = currentAirAbsorption;
 }
 
 void DistanceProcessor::setVolumeCompensation(float compensation)
@@ -1056,52 +1272,17 @@ void DistanceProcessor::setVolumeCompensation(float compensation)
 
 void DistanceProcessor::setRoomWidth(float roomWidthMeters)
 {
-    currentRoomWidth = juce::jlimit(2.0f, 100.0f, roomWidthMeters);
-
-    float widthFactor = juce::jlimit(0.5f, 1.5f, currentRoomWidth / 6.0f);
-
-    environmentSettings[currentEnvironment].diffusion   = juce::jlimit(0.1f, 1.0f, widthFactor);
-    environmentSettings[currentEnvironment].reverbLevel = juce::jlimit(0.05f, 0.5f, widthFactor * 0.2f);
-    earlyReflection.setRoomDimensions (currentRoomWidth, currentRoomHeight, currentRoomLength);
+    currentRoomWidth = juce::jlimit(2.0f, getRangeLimit(), roomWidthMeters);
 }
 
 void DistanceProcessor::setRoomHeight(float roomHeightMeters)
 {
     currentRoomHeight = juce::jlimit(2.0f, 20.0f, roomHeightMeters);
-    
-    float heightFactor = juce::jlimit(0.5f, 3.0f, currentRoomHeight / 3.0f);
-
-    float roomSizeFactor = juce::jlimit(0.5f, 2.0f, heightFactor);
-    environmentSettings[currentEnvironment].roomSize = roomSizeFactor;
-
-    float decayTimeFactor = juce::jlimit(0.5f, 6.0f, heightFactor * 2.5f);
-    environmentSettings[currentEnvironment].decayTime = decayTimeFactor;
-    
-    float heightReverbBoost = juce::jlimit(0.0f, 0.6f, (heightFactor - 0.5f) * 0.1f);
-    environmentSettings[currentEnvironment].reverbLevel = juce::jmax(environmentSettings[currentEnvironment].reverbLevel, heightReverbBoost);
-    
-    float preDelay = juce::jlimit(2.0f, 80.0f, currentRoomHeight * 4.0f);
-
-    float damping = juce::jlimit(0.2f, 0.8f, 1.0f - (heightFactor * 0.1f));
-    environmentSettings[currentEnvironment].damping = damping;
-
-    earlyReflection.setRoomDimensions (currentRoomWidth, currentRoomHeight, currentRoomLength);
 }
 
 void DistanceProcessor::setRoomLength(float roomLengthMeters)
 {
-    currentRoomLength = juce::jlimit(2.0f, 100.0f, roomLengthMeters);
-    
-    float lengthFactor = juce::jlimit(0.5f, 3.0f, currentRoomLength / 10.0f);
-    float sizeMultiplier = juce::jlimit(0.7f, 1.5f, lengthFactor);
-    environmentSettings[currentEnvironment].roomSize *= sizeMultiplier;
-
-    float lateReverbLevel = juce::jlimit(0.1f, 0.6f, lengthFactor * 0.1f);
-
-    // DRAMATIC frequency response - longer rooms have more low-end buildup
-
-    environmentSettings[currentEnvironment].reverbLevel = juce::jmax(environmentSettings[currentEnvironment].reverbLevel, lateReverbLevel);
-    earlyReflection.setRoomDimensions (currentRoomWidth, currentRoomHeight, currentRoomLength);
+    currentRoomLength = juce::jlimit(2.0f, getRangeLimit(), roomLengthMeters);
 }
 
 void DistanceProcessor::setTemperature(float temperatureCelsius)
@@ -1110,11 +1291,16 @@ void DistanceProcessor::setTemperature(float temperatureCelsius)
     // Standard speed of sound calculation
     float adjustedSpeedOfSound = 331.3f * std::sqrt(1.0f + currentTemperature / 273.15f);
     speedOfSound = juce::jlimit(330.0f, 360.0f, adjustedSpeedOfSound);
-    
-    // Temperature also affects damping characteristics
-    float temperatureNorm  = juce::jlimit(-1.0f, 1.0f, currentTemperature / 50.0f); // −1..+1 for −50..50 °C
-    float tempDamping = juce::jlimit(0.2f, 0.8f, 0.7f - temperatureNorm * 0.2f);
-    environmentSettings[currentEnvironment].damping = tempDamping;
+}
+
+void DistanceProcessor::setHumidity(float humidityPercent)
+{
+    currentHumidity = juce::jlimit(0.0f, 100.0f, humidityPercent);
+}
+
+void DistanceProcessor::setAtmosphericPressure(float pressureKPa)
+{
+    currentPressure = juce::jlimit(50.0f, 110.0f, pressureKPa);
 }
 
 void DistanceProcessor::setSourceHeight(float heightPercent)
@@ -1139,6 +1325,37 @@ void DistanceProcessor::updateHrirFilters(float azDeg, float elDeg)
     lastAzimuthDeg   = azDeg;
     lastElevationDeg = elDeg;
 
+    // Interpolation allocates, so it runs on the shared worker pool. Requests
+    // made before the previous one was served are coalesced into one build.
+    requestedAzimuthDeg   = azDeg;
+    requestedElevationDeg = elDeg;
+    workerPool->trigger (hrirUpdateTask);
+}
+
+void DistanceProcessor::loadHrirAssets()
+{
+    if (hrirDatabasePending)
+    {
+        // Default SOFA database next to the plugin binary, then in the working
+        // directory (fallback to the head model if not found)
+        const juce::String sofaPath ("libs/libmysofa/share/default.sofa");
+        auto sofaFile = juce::File::getSpecialLocation (juce::File::currentExecutableFile).getSiblingFile (sofaPath);
+        
+        if (! sofaFile.existsAsFile())
+            sofaFile = juce::File::getCurrentWorkingDirectory().getChildFile (sofaPath);
+        
+        hrirDatabase.loadSofaFile (sofaFile.getFullPathName());
+        hrirDatabasePending = false;
+    }
+    
+    buildHrirFilters();
+}
+
+void DistanceProcessor::buildHrirFilters()
+{
+    const float azDeg = requestedAzimuthDeg.load();
+    const float elDeg = requestedElevationDeg.load();
+
     // DearVR-style HRTF interpolation
     // Instead of nearest neighbor, interpolate between 4 surrounding positions
     
@@ -1193,41 +1410,14 @@ void DistanceProcessor::updateHrirFilters(float azDeg, float elDeg)
         interpRight[i] = bottomR * (1.0f - elWeight) + topR * elWeight;
     }
     
-    // Create buffers and load interpolated HRIRs
-    auto makeBuffer = [len](const std::vector<float>& data) {
-        juce::AudioBuffer<float> buf;
-        buf.setSize(1, len);
-        std::memcpy(buf.getWritePointer(0), data.data(), sizeof(float) * len);
-        return buf;
-    };
-
-    hrtfLeft.loadImpulseResponse(makeBuffer(interpLeft), sampleRate,
-                                 juce::dsp::Convolution::Stereo::no,
-                                 juce::dsp::Convolution::Trim::no,
-                                 juce::dsp::Convolution::Normalise::no);
-    hrtfRight.loadImpulseResponse(makeBuffer(interpRight), sampleRate,
-                                  juce::dsp::Convolution::Stereo::no,
-                                  juce::dsp::Convolution::Trim::no,
-                                  juce::dsp::Convolution::Normalise::no);
+    // Publish the interpolated HRIRs to the audio thread
+    hrtfFilter.setImpulseResponses(interpLeft.data(), len, interpRight.data(), len);
 }
 
 void DistanceProcessor::processHrtfConvolution(juce::AudioBuffer<float>& buffer)
 {
     // DearVR-style HRTF processing with subtle crosstalk cancellation
-    juce::dsp::AudioBlock<float> block (buffer);
-    
-    // Process left channel
-    auto blockL = block.getSingleChannelBlock (0);
-    juce::dsp::ProcessContextReplacing<float> ctxL (blockL);
-    hrtfLeft.process (ctxL);
-
-    // Process right channel
-    if (buffer.getNumChannels() > 1)
-    {
-        auto blockR = block.getSingleChannelBlock (1);
-        juce::dsp::ProcessContextReplacing<float> ctxR (blockR);
-        hrtfRight.process (ctxR);
-    }
+    hrtfFilter.process (buffer, buffer.getNumSamples());
     
     // Apply subtle crosstalk cancellation for better externalization
     // This helps move the sound outside the head when using headphones
@@ -1238,30 +1428,25 @@ void DistanceProcessor::processHrtfConvolution(juce::AudioBuffer<float>& buffer)
         
         // Crosstalk cancellation parameters
         const float crossfeedAmount = 0.15f; // Subtle amount
-        const float crossfeedDelay = 0.0003f; // 0.3ms delay
-        const int delaySamples = static_cast<int>(crossfeedDelay * sampleRate);
         
-        // Simple delay-based crosstalk cancellation
-        juce::AudioBuffer<float> crossfeedBuffer(2, delaySamples + buffer.getNumSamples());
-        crossfeedBuffer.clear();
+        // Simple delay-based crosstalk cancellation; the 0.3 ms history
+        // carries across blocks so the result does not depend on block size
+        auto* historyL = crossfeedHistory.getWritePointer(0);
+        auto* historyR = crossfeedHistory.getWritePointer(1);
+        const int delaySamples = crossfeedHistory.getNumSamples();
         
         const int numSamples = buffer.getNumSamples();
         
         for (int i = 0; i < numSamples; ++i)
         {
             // Get delayed crossfeed signals
-            float delayedLeft = 0.0f;
-            float delayedRight = 0.0f;
-            
-            if (i >= delaySamples)
-            {
-                delayedLeft = crossfeedBuffer.getSample(0, i - delaySamples);
-                delayedRight = crossfeedBuffer.getSample(1, i - delaySamples);
-            }
+            const float delayedLeft = historyL[crossfeedPosition];
+            const float delayedRight = historyR[crossfeedPosition];
             
             // Store current samples for future crossfeed
-            crossfeedBuffer.setSample(0, i, left[i]);
-            crossfeedBuffer.setSample(1, i, right[i]);
+            historyL[crossfeedPosition] = left[i];
+            historyR[crossfeedPosition] = right[i];
+            crossfeedPosition = crossfeedPosition + 1 < delaySamples ? crossfeedPosition + 1 : 0;
             
             // Apply inverted crossfeed (cancellation)
             left[i] -= delayedRight * crossfeedAmount;
@@ -1274,5 +1459,3 @@ void DistanceProcessor::processHrtfConvolution(juce::AudioBuffer<float>& buffer)
         
     }
 }
-
- 
\ No newline at end of file
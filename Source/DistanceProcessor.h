@@ -1,9 +1,18 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
 #include <limits>
+#include <memory>
 #include "MySofaHRIR.h"
-#include "EarlyReflectionIR.h"
+#include "RoomModel.h"
+#include "BackgroundWorkerPool.h"
+#include "HrtfFirFilter.h"
+#include "PropagationDelay.h"
+#include "AtmosphericAbsorption.h"
+#include "StageProfiler.h"
+#include "AudioThreadLog.h"
 
 //==============================================================================
 /**
@@ -26,11 +35,11 @@ public:
         numEnvironments
     };
     
-    // Air Absorption modes (TDR research)
+    // Air Absorption modes: fidelity of the ISO 9613-1 shelf fit
     enum AirAbsorptionMode
     {
-        AirAbsorptionA = 0,  // Gentle high-shelf filter (6 dB/octave)
-        AirAbsorptionB       // Aggressive low-pass filter (12 dB/octave)
+        AirAbsorptionA = 0,  // Fast: one high shelf matched at 16 kHz
+        AirAbsorptionB       // Accurate: three high shelves matched at 4, 8 and 16 kHz
     };
     
     // Proximity Effect modes (TDR research)
@@ -42,7 +51,7 @@ public:
 
     //==============================================================================
     DistanceProcessor();
-    ~DistanceProcessor() = default;
+    ~DistanceProcessor();
 
     //==============================================================================
     void prepare(double sampleRate, int samplesPerBlock);
@@ -50,8 +59,10 @@ public:
     void processBlock(juce::AudioBuffer<float>& buffer, float distance, float panValue, Environment environment);
 
     //==============================================================================
+    // Rewrites the room inputs, so it runs on the audio thread between blocks
     void setEnvironmentType(Environment envType);
-    float getMaxDistanceForEnvironment(Environment envType) const;
+    float getMaxDistanceForEnvironment(Environment envType) const; // of the preset
+    static RoomModel::Inputs getEnvironmentPreset(Environment environment); // room, range and air of the preset
     
     // Real-time parameter updates from UI
     // Simplified parameter setters
@@ -63,8 +74,42 @@ public:
     void setAirAbsorption(float absorption);
     void setVolumeCompensation(float compensation);
     void setTemperature(float temperatureCelsius);
+    void setHumidity(float humidityPercent);
+    void setAtmosphericPressure(float pressureKPa);
     void setSourceHeight(float heightPercent);
     void setClarity(float clarity);
+    
+    // Fractional interpolation used by the propagation delay
+    void setDelayInterpolation(PropagationDelay::Interpolation interpolation) { propagationDelay.setInterpolation(interpolation); }
+    
+    // Aligned mode: the propagation delay at the reference distance is reported
+    // as latency, so only the difference from the reference is heard
+    void setAlignedDelay(bool shouldAlign, float referenceDistanceMeters);
+    void setReportedLatency(int latencySamples) { reportedLatencySamples = juce::jmax(0, latencySamples); }
+    int getRequiredLatency() const;
+    
+    // Long range lifts the room and distance limit from 100 m to 1 km. The delay
+    // memory is sized for the active range, so switching reallocates it: call
+    // only before prepare() or while the owning processor is suspended
+    static constexpr float roomRangeLimit = 100.0f;
+    static constexpr float longRangeLimit = 1000.0f;
+    void setLongRange(bool shouldUseLongRange);
+    bool isLongRange() const { return longRange; }
+    float getRangeLimit() const { return longRange ? longRangeLimit : roomRangeLimit; }
+    
+    // Longest a source can take to arrive, plus its reflections and late reverb
+    double getTailLengthSeconds() const;
+    
+    // Mono-in/stereo-out: channel 0 carries the source, channel 1 is filled at the binaural split
+    void setMonoInput(bool shouldUseMonoPath) { monoInput = shouldUseMonoPath; }
+    
+    // Per-stage timing of this processor's audio thread, off until enabled
+    StageProfiler& getStageProfiler() { return profiler; }
+    
+    // Stage errors on the audio thread are reported through this log; without
+    // one they are only counted
+    void setEventLog(AudioThreadLog* logToUse) { eventLog = logToUse; }
+    int getUnreportedStageErrors() const { return unreportedStageErrors.load(std::memory_order_relaxed); }
 
     // TDR Proximity research-based parameters
     float originalDistance = 1.0f;  // Reference distance for gain calibration
@@ -76,18 +121,64 @@ public:
     
     float speedOfSound = 343.0f; // m/s at 20°C (now mutable for temperature adjustments)
 
+    //==============================================================================
+    // Distance laws shared with MultiObjectRenderer
+    static float computeDistanceGain(float distanceMeters, float volumeCompensation);
+    static float computeAirPathLength(float distanceMeters, float airAbsorption); // for AtmosphericAbsorption
+    
+    // Late reverb settings of the room model the last block used (rendered by SharedRoomBus)
+    juce::Reverb::Parameters getLateReverbParameters() const;
+
 private:
     //==============================================================================
     // Advanced processing pipeline
     void processDistanceEffects(juce::AudioBuffer<float>& buffer, float distance, float panValue, int numSamples);
-    void processDelayEffect(juce::AudioBuffer<float>& buffer, float distance, int numSamples);
+    
+    // Where the source sits in the room, shared by every stage of one block
+    struct SourceGeometry
+    {
+        float distanceFactor = 0.0f;    // distance / max distance
+        float panRad = 0.0f;
+        float true3DDistance = 0.0f;    // metres
+        float effectiveDistance = 0.0f; // perceptually scaled
+        bool heavyLoad = false;
+    };
+    
+    SourceGeometry computeSourceGeometry(float distanceFactor, float panValue) const;
+    void processSourceStages(juce::AudioBuffer<float>& buffer, const SourceGeometry& geometry, float panValue, bool monoPath, int numSamples);
+    void processDelayEffect(juce::AudioBuffer<float>& buffer, float distance, bool withReflections, int numSamples);
     void processDistanceGain(juce::AudioBuffer<float>& buffer, float distance, int numSamples);
     void processAirAbsorption(juce::AudioBuffer<float>& buffer, float distance, int numSamples);
     void processStereoWidth(juce::AudioBuffer<float>& buffer, float distance, int numSamples);
     void processPanning(juce::AudioBuffer<float>& buffer, float panValue, int numSamples);
     void processHeightEffects(juce::AudioBuffer<float>& buffer, int numSamples);
     
-    void updateEnvironmentParameters(Environment environment);
+    // Per-sample loops of the height and panning stages, specialised at compile
+    // time on channel count and on the features a block needs, so the loops
+    // never test either. The stages pick an instantiation once per block
+    enum KernelFeatures
+    {
+        stereoKernel     = 1 << 0, // two channels rather than a mono source
+        tiltKernel       = 1 << 1, // height tilt shelf engaged
+        sideBlendKernel  = 1 << 2, // height phase blend on the side signal
+        numHeightKernels = 1 << 3
+    };
+    
+    template <bool stereo, bool tilt, bool sideBlend>
+    void runHeightKernel(juce::AudioBuffer<float>& buffer, int numSamples, float sideBlendCos, float heightGain);
+    
+    template <bool rearPhase>
+    void runPanningKernel(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    using HeightKernel = void (DistanceProcessor::*)(juce::AudioBuffer<float>&, int, float, float);
+    static const std::array<HeightKernel, numHeightKernels> heightKernels;
+    
+    void reportStageError(StageProfiler::Stage stage);
+    
+    void preparePropagationDelay();
+    double getMaxDelaySeconds() const;
+    void allocateScratch();
+    void prepareBlockSize(int newSamplesPerBlock);  // re-prepare at an unchanged sample rate
 
     //==============================================================================
     // Core audio processing parameters
@@ -99,11 +190,9 @@ private:
     juce::SmoothedValue<float> smoothedDistance{0.0f};
     juce::SmoothedValue<float> smoothedPan{0.0f};
     juce::SmoothedValue<float> smoothedGain{1.0f};
-    juce::SmoothedValue<float> smoothedCutoffFreq{20000.0f};
     juce::SmoothedValue<float> smoothedStereoWidth{1.0f};
     juce::SmoothedValue<float> smoothedLeftPanGain{0.707f};
     juce::SmoothedValue<float> smoothedRightPanGain{0.707f};
-    juce::SmoothedValue<float> smoothedDelayTime{0.0f};
     juce::SmoothedValue<float> smoothedHeight{0.5f};
     juce::SmoothedValue<float> smoothedClarity{1.0f}; // wet mix factor
     
@@ -118,22 +207,56 @@ private:
     juce::SmoothedValue<float> smoothedBrightness{1.0f};
     juce::SmoothedValue<float> smoothedIldGainL{0.707f};
     juce::SmoothedValue<float> smoothedIldGainR{0.707f};
-    juce::SmoothedValue<float> smoothedEarDelayLeft{0.0f};
-    juce::SmoothedValue<float> smoothedEarDelayRight{0.0f};
     
     //==============================================================================
-    // Advanced filter chain - separate filters for perfect stereo balance
-    juce::dsp::IIR::Filter<float> lowPassFilterLeft;
-    juce::dsp::IIR::Filter<float> lowPassFilterRight;
-    juce::dsp::IIR::Filter<float> backFilterLeft;
-    juce::dsp::IIR::Filter<float> backFilterRight;
-    juce::dsp::IIR::Filter<float> heightTiltFilterLeft;
-    juce::dsp::IIR::Filter<float> heightTiltFilterRight;
-    juce::dsp::DelayLine<float> delayLine;
+    // Second-order shelf kept inline: the arithmetic of juce::dsp::IIR::Filter
+    // (transposed direct form II) without its ref-counted coefficient object
+    struct BiquadCoefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+        
+        // { b0, b1, b2, a0, a1, a2 } from ArrayCoefficients, normalised by a0
+        // the way IIR::Coefficients does it
+        void assign(const std::array<float, 6>& values) noexcept
+        {
+            const float a0Inv = ! juce::approximatelyEqual(values[3], 0.0f) ? 1.0f / values[3] : 0.0f;
+            b0 = values[0] * a0Inv;
+            b1 = values[1] * a0Inv;
+            b2 = values[2] * a0Inv;
+            a1 = values[4] * a0Inv;
+            a2 = values[5] * a0Inv;
+        }
+    };
+    
+    struct BiquadState
+    {
+        float s1 = 0.0f, s2 = 0.0f;
+        
+        float processSample(const BiquadCoefficients& c, float input) noexcept
+        {
+            const float output = (c.b0 * input) + s1;
+            s1 = (c.b1 * input) - (c.a1 * output) + s2;
+            s2 = (c.b2 * input) - (c.a2 * output);
+            return output;
+        }
+        
+        void reset() noexcept { s1 = s2 = 0.0f; }
+    };
+    
+    //==============================================================================
+    // Advanced filter chain - separate filter state per ear for perfect stereo
+    // balance, one coefficient set per pair
+    BiquadCoefficients backFilterCoefficients;
+    BiquadCoefficients heightTiltCoefficients;
+    BiquadState backFilterLeft;
+    BiquadState backFilterRight;
+    BiquadState heightTiltFilterLeft;
+    BiquadState heightTiltFilterRight;
+    PropagationDelay propagationDelay; // per ear: distance / c + ITD, plus reflection taps
+    AtmosphericAbsorption atmosphericAbsorption;
     juce::dsp::Gain<float> gainProcessor;
     
     // Cache last applied cutoff to avoid per-sample coefficient churn
-    float lastCutoffFreq = 20000.0f;
     float lastShadowCutoff = 12000.0f;
     float lastTiltGain = 0.0f;
     float phaseAccumulator = 0.0f;
@@ -155,35 +278,70 @@ private:
     float currentAirAbsorption = 0.5f;
     float currentVolumeCompensation = 0.3f;
     float currentTemperature = 20.0f;
+    float currentHumidity = 50.0f;
+    float currentPressure = 101.325f; // kPa
     float currentHeightPercent = 0.5f; // 0-1
     float currentClarity = 1.0f; // 0=dry 1=wet
+    bool monoInput = false;
+    bool longRange = false;
+    bool isPrepared = false;
     
-    // Scientific parameters (configurable per environment)
-    struct EnvironmentParams
-    {
-        float maxDistance;            // Maximum realistic distance for this environment
-        float roomSize;               // Room size factor
-        float decayTime;              // Reverb decay time
-        float damping;                // Reverb damping
-        float reverbLevel;            // Reverb strength
-        float airAbsorptionCoeff;     // Air absorption coefficient
-        float diffusion;              // Diffusion amount
-        float preDelay;               // Pre-delay in ms
-    };
+    // Aligned delay mode (latency is independent of room size and temperature)
+    static constexpr float nominalSpeedOfSound = 343.0f;
+    static constexpr float maxAlignedLeadSeconds = 0.1f;
+    static constexpr double maxSpreadSeconds = 0.15; // ITD plus the wall reflections of a 100 m room
+    bool alignedDelay = false;
+    float referenceDistance = 5.0f;
+    int reportedLatencySamples = 0;
     
-    EnvironmentParams environmentSettings[numEnvironments];
+    StageProfiler profiler;
+    AudioThreadLog* eventLog = nullptr;
+    std::atomic<int> unreportedStageErrors { 0 };   // stage errors while no log was set
 
     static constexpr float listenerEarHeight = 1.7f; // metres above floor – average ear height when seated/standing
 
-    // Early reflection processor
-    EarlyReflectionIR earlyReflection;
+    // Room model: reverb settings and early reflection taps, which are read from
+    // the propagation delay history. Rebuilt on the worker pool whenever the
+    // room inputs change; the audio thread only picks up the latest snapshot
+    struct RoomModelTask : public BackgroundWorkerPool::Task
+    {
+        explicit RoomModelTask (DistanceProcessor& processor)
+            : Task (BackgroundWorkerPool::High), owner (processor) {}
+        void run() override { owner.buildRoomModel(); }
+        DistanceProcessor& owner;
+    };
+    
+    void updateRoomModel();    // audio thread, once per block
+    void buildRoomModel();     // worker pool
+    
+    RoomModelStore roomModels;
+    const RoomModel* room = nullptr;   // the snapshot the current block renders
+    RoomModel::Inputs requestedRoom;   // audio thread: inputs of the last request
 
-    // HRTF binaural convolution
+    // HRTF binaural filtering - IRs are interpolated on the shared worker pool
+    // and handed to the audio thread without locks
     MySofaHrirDatabase hrirDatabase;
-    juce::dsp::Convolution hrtfLeft { juce::dsp::Convolution::NonUniform { 128 } };
-    juce::dsp::Convolution hrtfRight{ juce::dsp::Convolution::NonUniform { 128 } };
+    HrtfFirFilter hrtfFilter;
+    juce::HeapBlock<float> scratchArena;       // backs the two buffers below
     juce::AudioBuffer<float> hrtfTempBuffer;
+    juce::AudioBuffer<float> crossfeedHistory; // one delay line per ear
+    int crossfeedPosition = 0;
     float lastAzimuthDeg = 0.0f, lastElevationDeg = 0.0f;
+    
+    struct HrirUpdateTask : public BackgroundWorkerPool::Task
+    {
+        explicit HrirUpdateTask (DistanceProcessor& processor)
+            : Task (BackgroundWorkerPool::High), owner (processor) {}
+        void run() override { owner.loadHrirAssets(); }
+        DistanceProcessor& owner;
+    };
+    
+    juce::SharedResourcePointer<BackgroundWorkerPool> workerPool;
+    HrirUpdateTask hrirUpdateTask { *this };
+    RoomModelTask roomModelTask { *this };
+    std::atomic<float> requestedAzimuthDeg { 0.0f };
+    std::atomic<float> requestedElevationDeg { 0.0f };
+    bool hrirDatabasePending = true; // set by prepare, cleared by the first HRIR update
 
     // Cache last geometry state to avoid expensive updates each block
     float lastGeomRoomWidth  = -1.0f;
@@ -194,11 +352,9 @@ private:
     float lastGeomSrcZ       = std::numeric_limits<float>::infinity();
 
     void updateHrirFilters(float azimuthDeg, float elevationDeg);
+    void loadHrirAssets();     // worker pool: pending SOFA lookup, then the HRIR pair
+    void buildHrirFilters();
     void processHrtfConvolution(juce::AudioBuffer<float>& buffer);
 
-    // Ear-specific micro-delay lines for ITD (inter-aural time difference)
-    juce::dsp::DelayLine<float> earDelayLeft { 480 };  // ≈10 ms @ 48 kHz max
-    juce::dsp::DelayLine<float> earDelayRight{ 480 };
-
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DistanceProcessor)
 };
\ No newline at end of file
@@ -40,6 +40,40 @@ public:
         roomLength = length;
     }
 
+    static constexpr int numReflections = 6;
+
+    /**
+     * First-order wall reflections of a source placed at the room centre:
+     * delay (seconds after the direct sound) and gain of each tap. Shared by
+     * process() and by delay lines that read the taps from their own history.
+     */
+    void getReflections (std::array<float, numReflections>& delaysSeconds,
+                         std::array<float, numReflections>& gains) const noexcept
+    {
+        getReflections (roomWidth, roomHeight, roomLength, delaysSeconds, gains);
+    }
+
+    static void getReflections (float width, float height, float length,
+                                std::array<float, numReflections>& delaysSeconds,
+                                std::array<float, numReflections>& gains) noexcept
+    {
+        const float c = 343.0f; // speed of sound (m/s)
+
+        // Distances to six walls from the source placed at centre
+        const float distX = width  * 0.5f;
+        const float distY = height * 0.5f;
+        const float distZ = length * 0.5f;
+
+        delaysSeconds = { distX / c,   // left wall
+                          distX / c,   // right wall
+                          distY / c,   // floor
+                          distY / c,   // ceiling
+                          distZ / c,   // front wall
+                          distZ / c }; // back wall
+
+        gains = { 0.5f, 0.5f, 0.5f, 0.5f, 0.4f, 0.4f };
+    }
+
     /**
      * Add a crude set of first‑order reflections. This is intentionally simple
      * but provides noticeably more spatial impression than the previous stub.
@@ -47,7 +81,10 @@ public:
     void process (juce::AudioBuffer<float>& buffer)
     {
         const int numSamples = buffer.getNumSamples();
-        const float c = 343.0f; // speed of sound (m/s)
+        const int maxDelaySamples = reflectionBuffer.getNumSamples() - numSamples;
+
+        if (maxDelaySamples < 0)
+            return;
 
         reflectionBuffer.clear();
 
@@ -55,25 +92,13 @@ public:
         for (int ch = 0; ch < juce::jmin (numChannels, buffer.getNumChannels()); ++ch)
             reflectionBuffer.copyFrom (ch, 0, buffer, ch, 0, numSamples);
 
-        // Distances to six walls from the source placed at centre
-        const float distX = roomWidth  * 0.5f;
-        const float distY = roomHeight * 0.5f;
-        const float distZ = roomLength * 0.5f;
-
-        const std::array<float,6> delays {
-            distX / c,  // left wall
-            distX / c,  // right wall
-            distY / c,  // floor
-            distY / c,  // ceiling
-            distZ / c,  // front wall
-            distZ / c   // back wall
-        };
-
-        const std::array<float,6> gains { 0.5f, 0.5f, 0.5f, 0.5f, 0.4f, 0.4f };
+        std::array<float, numReflections> delays, gains;
+        getReflections (delays, gains);
 
         for (size_t i = 0; i < delays.size(); ++i)
         {
-            const int delaySamples = static_cast<int> (delays[i] * currentSampleRate);
+            // Large rooms must not write past the preallocated headroom
+            const int delaySamples = juce::jmin (maxDelaySamples, static_cast<int> (delays[i] * currentSampleRate));
             for (int ch = 0; ch < juce::jmin (numChannels, buffer.getNumChannels()); ++ch)
                 reflectionBuffer.addFrom (ch, delaySamples, buffer, ch, 0, numSamples, gains[i]);
         }
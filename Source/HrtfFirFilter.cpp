@@ -0,0 +1,110 @@
+#include "HrtfFirFilter.h"
+#include <cmath>
+#include <cstring>
+
+//==============================================================================
+void HrtfFirFilter::prepare (int samplesPerBlock)
+{
+    maxBlockSize = juce::jmax (1, samplesPerBlock);
+    history.setSize (2, maxTaps - 1 + maxBlockSize);
+    fadeBuffer.setSize (1, maxBlockSize);
+    reset();
+}
+
+void HrtfFirFilter::reset()
+{
+    history.clear();
+    fadeBuffer.clear();
+}
+
+//==============================================================================
+void HrtfFirFilter::toSparse (const float* ir, int length, SparseIr& sparse) noexcept
+{
+    sparse.numTaps = 0;
+
+    for (int t = 0; t < juce::jmin (length, maxTaps); ++t)
+    {
+        if (std::abs (ir[t]) <= 1.0e-6f)
+            continue;
+
+        sparse.taps[(size_t) sparse.numTaps]  = t;
+        sparse.gains[(size_t) sparse.numTaps] = ir[t];
+        ++sparse.numTaps;
+    }
+}
+
+void HrtfFirFilter::setImpulseResponses (const float* left, int leftLength, const float* right, int rightLength) noexcept
+{
+    auto& pair = slots[(size_t) writeSlot];
+    toSparse (left,  leftLength,  pair.ears[0]);
+    toSparse (right, rightLength, pair.ears[1]);
+    pair.valid = true;
+
+    // Hand the written slot over and take back whichever one was in the middle
+    writeSlot = sharedSlot.exchange (writeSlot | freshFlag, std::memory_order_acq_rel) & ~freshFlag;
+}
+
+//==============================================================================
+void HrtfFirFilter::process (juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+{
+    bool crossfade = false;
+
+    if ((sharedSlot.load (std::memory_order_acquire) & freshFlag) != 0)
+    {
+        // The slot we give back may be rewritten at once, so keep a copy to fade from
+        crossfade = slots[(size_t) readSlot].valid;
+        if (crossfade)
+            outgoing = slots[(size_t) readSlot];
+
+        readSlot = sharedSlot.exchange (readSlot, std::memory_order_acq_rel) & ~freshFlag;
+    }
+
+    if (! slots[(size_t) readSlot].valid)
+        return;
+
+    const int numEars = juce::jmin (2, buffer.getNumChannels());
+
+    // Oversized host blocks are split so the history never overflows
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const int chunk = juce::jmin (maxBlockSize, numSamples - start);
+
+        for (int ear = 0; ear < numEars; ++ear)
+            processEar (ear, buffer.getWritePointer (ear, start), chunk, crossfade);
+
+        crossfade = false;
+    }
+}
+
+void HrtfFirFilter::processEar (int ear, float* out, int numSamples, bool crossfade) noexcept
+{
+    const int historyOffset = maxTaps - 1;
+    float* hist = history.getWritePointer (ear);
+
+    juce::FloatVectorOperations::copy (hist + historyOffset, out, numSamples);
+    juce::FloatVectorOperations::clear (out, numSamples);
+    runFilter (slots[(size_t) readSlot].ears[ear], hist, out, numSamples);
+
+    if (crossfade)
+    {
+        // Linear crossfade from the outgoing IR over this block
+        float* faded = fadeBuffer.getWritePointer (0);
+        juce::FloatVectorOperations::clear (faded, numSamples);
+        runFilter (outgoing.ears[ear], hist, faded, numSamples);
+
+        const float rampStep = 1.0f / static_cast<float> (numSamples);
+        for (int n = 0; n < numSamples; ++n)
+            out[n] = faded[n] + (out[n] - faded[n]) * static_cast<float> (n) * rampStep;
+    }
+
+    std::memmove (hist, hist + numSamples, sizeof (float) * (size_t) historyOffset);
+}
+
+void HrtfFirFilter::runFilter (const SparseIr& ir, const float* hist, float* out, int numSamples) const noexcept
+{
+    const int historyOffset = maxTaps - 1;
+
+    for (int i = 0; i < ir.numTaps; ++i)
+        juce::FloatVectorOperations::addWithMultiply (out, hist + historyOffset - ir.taps[(size_t) i],
+                                                      ir.gains[(size_t) i], numSamples);
+}
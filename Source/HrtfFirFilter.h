@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+    Two-ear HRIR filter with a wait-free impulse response handoff
+    A worker thread publishes new left/right impulse responses through a
+    triple buffer; the audio thread picks up the latest pair at the start of
+    a block and crossfades from the previous pair over that block. The IRs
+    are stored as sparse taps, since the head-model HRIRs only have a few
+    non-zero samples, and run as vectorised multiply-adds with no latency.
+*/
+class HrtfFirFilter
+{
+public:
+    //==============================================================================
+    static constexpr int maxTaps = 256;
+
+    HrtfFirFilter() = default;
+    ~HrtfFirFilter() = default;
+
+    void prepare (int samplesPerBlock);
+    void reset();
+
+    /** Publishes a new IR pair. Wait-free; call from one non-audio thread at a time. */
+    void setImpulseResponses (const float* left, int leftLength, const float* right, int rightLength) noexcept;
+
+    /** Filters channel 0 with the left IR and channel 1 with the right IR in place.
+        Passes the signal through until the first IR pair has been published. */
+    void process (juce::AudioBuffer<float>& buffer, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    struct SparseIr
+    {
+        std::array<int, maxTaps>   taps {};
+        std::array<float, maxTaps> gains {};
+        int numTaps = 0;
+    };
+
+    struct IrPair
+    {
+        SparseIr ears[2];
+        bool valid = false;
+    };
+
+    static void toSparse (const float* ir, int length, SparseIr& sparse) noexcept;
+    void processEar (int ear, float* out, int numSamples, bool crossfade) noexcept;
+    void runFilter (const SparseIr& ir, const float* history, float* out, int numSamples) const noexcept;
+
+    //==============================================================================
+    static constexpr int freshFlag = 4;
+
+    std::array<IrPair, 3> slots;
+    std::atomic<int> sharedSlot { 1 };   // middle slot index, plus freshFlag when unread
+    int writeSlot = 0;                   // owned by the publishing thread
+    int readSlot  = 2;                   // owned by the audio thread
+    IrPair outgoing;                     // previous pair while crossfading
+
+    int maxBlockSize = 512;
+    juce::AudioBuffer<float> history;    // per ear: maxTaps - 1 past samples + block
+    juce::AudioBuffer<float> fadeBuffer; // output of the outgoing IR during a crossfade
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HrtfFirFilter)
+};
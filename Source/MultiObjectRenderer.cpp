@@ -0,0 +1,344 @@
+#include "MultiObjectRenderer.h"
+#include "DistanceProcessor.h"
+#include <cmath>
+
+// -------------------------------------------------------------------------
+
+void MultiObjectRenderer::prepare (double newSampleRate, int samplesPerBlock, int numObjects,
+                                   const juce::AudioChannelSet& outputLayout)
+{
+    sampleRate   = newSampleRate;
+    maxBlockSize = juce::jmax (1, samplesPerBlock);
+
+    // Speaker layouts are VBAP-panned, everything else is rendered binaurally
+    speakerOutput = VbapPanner::isSupportedLayout (outputLayout);
+    numOutputChannels = 2;
+
+    if (speakerOutput)
+    {
+        speakerPanner.prepare (outputLayout);
+        numOutputChannels = speakerPanner.getNumOutputs();
+    }
+
+    numObjects = juce::jlimit (0, maxObjects, numObjects);
+    voices.clear();
+    voices.resize ((size_t) numObjects);
+
+    // ITD never exceeds ~2 ms; keep enough history for one block on top of it
+    const int maxItdSamples = static_cast<int> (sampleRate * 0.002);
+    const int historySize   = juce::nextPowerOfTwo (maxBlockSize + maxItdSamples + 2);
+    historyMask = historySize - 1;
+
+    for (auto& voice : voices)
+    {
+        voice.history.assign ((size_t) historySize, 0.0f);
+        voice.air = std::make_unique<AtmosphericAbsorption>();
+        voice.air->prepare (sampleRate, 1);
+    }
+
+    mixBuffer.setSize (numOutputChannels, maxBlockSize);
+    voiceBuffer.setSize (2, maxBlockSize);
+    shBed.setSize (AmbisonicBinauralDecoder::maxChannels, maxBlockSize);
+    roomSend.setSize (1, maxBlockSize);
+    ambisonicDecoder.prepare (sampleRate, maxBlockSize);
+    earlyReflection.prepare (sampleRate, maxBlockSize, speakerOutput ? 1 : 2);
+    earlyReflection.setRoomDimensions (roomWidth, roomHeight, roomLength);
+
+    reset();
+}
+
+void MultiObjectRenderer::reset()
+{
+    for (auto& voice : voices)
+    {
+        voice.air->reset();
+        std::fill (voice.history.begin(), voice.history.end(), 0.0f);
+        voice.shGains.fill (0.0f);
+        voice.speakerGains.fill (0.0f);
+        voice.sendGain = 0.0f;
+        voice.writePos = 0;
+    }
+
+    mixBuffer.clear();
+    voiceBuffer.clear();
+    shBed.clear();
+    roomSend.clear();
+    ambisonicDecoder.reset();
+    earlyReflection.reset();
+}
+
+//==============================================================================
+void MultiObjectRenderer::setObjectPosition (int index, float distanceMeters, float azimuthDeg, float heightPercent)
+{
+    if (! juce::isPositiveAndBelow (index, (int) voices.size()))
+        return;
+
+    auto& voice = voices[(size_t) index];
+    voice.distance = juce::jmax (0.0f, distanceMeters);
+    voice.azimuth  = azimuthDeg;
+    voice.height   = juce::jlimit (0.0f, 1.0f, heightPercent);
+}
+
+void MultiObjectRenderer::setRoomDimensions (float width, float height, float length)
+{
+    roomWidth  = juce::jlimit (2.0f, rangeLimit, width);
+    roomHeight = juce::jlimit (2.0f, 20.0f, height);
+    roomLength = juce::jlimit (2.0f, rangeLimit, length);
+    earlyReflection.setRoomDimensions (roomWidth, roomHeight, roomLength);
+}
+
+void MultiObjectRenderer::setMaxDistance (float maxDistanceMeters)
+{
+    maxDistance = juce::jlimit (5.0f, rangeLimit, maxDistanceMeters);
+}
+
+void MultiObjectRenderer::setAirAbsorption (float absorption)
+{
+    airAbsorption = juce::jlimit (0.0f, 1.0f, absorption);
+}
+
+void MultiObjectRenderer::setAtmosphere (float temperatureCelsius, float humidityPercent, float pressureKPa)
+{
+    temperature = temperatureCelsius;
+    humidity    = humidityPercent;
+    pressure    = pressureKPa;
+}
+
+void MultiObjectRenderer::setVolumeCompensation (float compensation)
+{
+    volumeCompensation = juce::jlimit (0.0f, 1.0f, compensation);
+}
+
+//==============================================================================
+void MultiObjectRenderer::process (juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (numSamples <= 0 || buffer.getNumChannels() < numOutputChannels)
+        return;
+
+    // Hosts occasionally exceed the prepared block size - split rather than
+    // reallocate. Chunks are addressed by offset: a view of up to 64 object
+    // channels would allocate its channel list
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+        processChunk (buffer, start, juce::jmin (maxBlockSize, numSamples - start));
+}
+
+void MultiObjectRenderer::processChunk (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numInputs = juce::jmin ((int) voices.size(), buffer.getNumChannels());
+
+    mixBuffer.clear (0, numSamples);
+
+    if (speakerOutput)
+        roomSend.clear (0, numSamples);
+    else if (renderMode == Ambisonic)
+    {
+        // An order change restarts the higher-order gains from silence
+        if (encodedOrder != ambisonicDecoder.getOrder())
+        {
+            encodedOrder = ambisonicDecoder.getOrder();
+            for (auto& voice : voices)
+                std::fill (voice.shGains.begin() + AmbisonicBinauralDecoder::getNumChannelsForOrder (encodedOrder),
+                           voice.shGains.end(), 0.0f);
+        }
+
+        shBed.clear (0, numSamples);
+    }
+
+    // Direct paths - the only per-object work
+    for (int i = 0; i < numInputs; ++i)
+        renderVoice (voices[(size_t) i], buffer.getReadPointer (i, startSample), numSamples);
+
+    if (speakerOutput)
+    {
+        processSpeakerRoom (numSamples);
+    }
+    else
+    {
+        // One binaural decode for the whole HOA bed
+        if (renderMode == Ambisonic)
+            ambisonicDecoder.process (shBed, mixBuffer, numSamples);
+
+        // Shared room bus - runs once regardless of object count
+        juce::AudioBuffer<float> mixView (mixBuffer.getArrayOfWritePointers(), 2, numSamples);
+        earlyReflection.process (mixView);
+    }
+
+    for (int ch = 0; ch < numOutputChannels; ++ch)
+    {
+        float* out = buffer.getWritePointer (ch, startSample);
+        const float* mixed = mixBuffer.getReadPointer (ch);
+        for (int n = 0; n < numSamples; ++n)
+            out[n] = juce::jlimit (-2.0f, 2.0f, mixed[n]);
+    }
+
+    for (int ch = numOutputChannels; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear (ch, startSample, numSamples);
+}
+
+void MultiObjectRenderer::renderVoice (ObjectVoice& voice, const float* input, int numSamples)
+{
+    // Same room-scaled geometry as DistanceProcessor::processDistanceEffects
+    const float distanceFactor = juce::jlimit (0.0f, 1.0f, voice.distance / maxDistance);
+    const float panRad = voice.azimuth * juce::MathConstants<float>::pi / 180.0f;
+    const float panNorm = juce::jlimit (-1.0f, 1.0f, std::sin (panRad));
+
+    float effectiveDistance = 0.0f;
+    float distanceGain = 1.0f;
+
+    if (distanceFactor > 0.0f)
+    {
+        const float roomDepth = juce::jmax (1.0f, roomLength);
+        const float depthMeters = distanceFactor * roomDepth;
+        const float lateralMeters = std::abs (panNorm) * juce::jmax (0.5f, roomWidth * 0.5f);
+        const float verticalMeters = voice.height * juce::jmax (2.0f, roomHeight) - 1.7f;
+        const float true3DDistance = std::sqrt (depthMeters * depthMeters
+                                                + lateralMeters * lateralMeters
+                                                + verticalMeters * verticalMeters);
+        const float perceptualFactor = juce::jlimit (0.5f, 2.5f, 1.0f + (roomDepth - 3.0f) * 0.15f);
+        effectiveDistance = true3DDistance * perceptualFactor * distanceFactor;
+
+        const float heightDeviation = juce::jlimit (-1.0f, 1.0f, voice.height * 2.0f - 1.0f);
+        distanceGain = DistanceProcessor::computeDistanceGain (effectiveDistance, volumeCompensation)
+                       * (1.0f + heightDeviation * 0.05f);
+    }
+
+    // Air absorption on the mono source (once per object, not per ear), with
+    // the atmosphere and fit of DistanceProcessor::processAirAbsorption
+    const float* source = input;
+    auto& air = *voice.air;
+
+    air.setAtmosphere (temperature, humidity, pressure);
+    air.setFidelity (airFidelity);
+    air.setPathLength (DistanceProcessor::computeAirPathLength (effectiveDistance, airAbsorption));
+
+    if (! air.isTransparent())
+    {
+        voiceBuffer.copyFrom (0, 0, input, numSamples);
+        air.process (voiceBuffer, 1, numSamples);
+        source = voiceBuffer.getReadPointer (0);
+    }
+    else
+    {
+        // Keeps the gain ramp in step, so the next audible block starts from here
+        air.process (voiceBuffer, 1, numSamples);
+    }
+
+    if (speakerOutput)
+        panVoiceToSpeakers (voice, source, distanceGain, numSamples);
+    else if (renderMode == Ambisonic)
+        encodeVoice (voice, source, distanceGain, numSamples);
+    else
+        panVoice (voice, source, panNorm, distanceGain, distanceFactor > 0.0f, numSamples);
+}
+
+void MultiObjectRenderer::panVoice (ObjectVoice& voice, const float* source, float panNorm,
+                                    float distanceGain, bool spatialised, int numSamples)
+{
+    float targetGainL = std::sqrt (0.5f * (1.0f - panNorm));
+    float targetGainR = std::sqrt (0.5f * (1.0f + panNorm));
+    float targetItd   = 0.0f;
+
+    if (spatialised)
+    {
+        // Room-aware ILD/ITD as in processPanning
+        const float roomSizeFactor = juce::jlimit (0.5f, 2.5f, roomWidth / 6.0f);
+        const float ildIntensity = 0.5f + roomSizeFactor * 0.5f;
+        targetGainL = juce::jlimit (0.1f, 1.0f, 0.5f + (targetGainL - 0.5f) * ildIntensity) * distanceGain;
+        targetGainR = juce::jlimit (0.1f, 1.0f, 0.5f + (targetGainR - 0.5f) * ildIntensity) * distanceGain;
+
+        const float roomAwareMaxItd = 0.0007f * (0.8f + roomSizeFactor * 0.4f);
+        targetItd = roomAwareMaxItd * panNorm * static_cast<float> (sampleRate);
+    }
+
+    // Keep the mono history for the lagging ear
+    for (int n = 0; n < numSamples; ++n)
+        voice.history[(size_t) ((voice.writePos + n) & historyMask)] = source[n];
+
+    const float startDelay[2] = { juce::jmax (0.0f,  voice.itdSamples), juce::jmax (0.0f, -voice.itdSamples) };
+    const float endDelay[2]   = { juce::jmax (0.0f,  targetItd),        juce::jmax (0.0f, -targetItd) };
+    const float startGain[2]  = { voice.gainL, voice.gainR };
+    const float endGain[2]    = { targetGainL, targetGainR };
+    const float rampStep = 1.0f / static_cast<float> (numSamples);
+
+    for (int ear = 0; ear < 2; ++ear)
+    {
+        const float* earSignal = source;
+
+        if (startDelay[ear] > 0.0f || endDelay[ear] > 0.0f)
+        {
+            float* delayed = voiceBuffer.getWritePointer (1);
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const float delay = startDelay[ear] + (endDelay[ear] - startDelay[ear]) * (float) n * rampStep;
+                const float readPos = static_cast<float> (voice.writePos + n) - delay;
+                const float floorPos = std::floor (readPos);
+                const float frac = readPos - floorPos;
+                const int index = static_cast<int> (floorPos);
+
+                const float a = voice.history[(size_t) (index & historyMask)];
+                const float b = voice.history[(size_t) ((index + 1) & historyMask)];
+                delayed[n] = a + (b - a) * frac;
+            }
+            earSignal = delayed;
+        }
+
+        mixBuffer.addFromWithRamp (ear, 0, earSignal, numSamples, startGain[ear], endGain[ear]);
+    }
+
+    voice.writePos = (voice.writePos + numSamples) & historyMask;
+    voice.gainL = targetGainL;
+    voice.gainR = targetGainR;
+    voice.itdSamples = targetItd;
+}
+
+void MultiObjectRenderer::encodeVoice (ObjectVoice& voice, const float* source, float distanceGain, int numSamples)
+{
+    // Same elevation mapping as the HRIR lookup in processPanning
+    const float elevationDeg = (voice.height - 0.5f) * 60.0f;
+
+    std::array<float, AmbisonicBinauralDecoder::maxChannels> targetGains {};
+    AmbisonicBinauralDecoder::computeEncodingGains (voice.azimuth, elevationDeg, encodedOrder, targetGains.data());
+
+    for (int k = 0; k < AmbisonicBinauralDecoder::getNumChannelsForOrder (encodedOrder); ++k)
+    {
+        const float target = targetGains[(size_t) k] * distanceGain;
+        shBed.addFromWithRamp (k, 0, source, numSamples, voice.shGains[(size_t) k], target);
+        voice.shGains[(size_t) k] = target;
+    }
+}
+
+void MultiObjectRenderer::panVoiceToSpeakers (ObjectVoice& voice, const float* source, float distanceGain, int numSamples)
+{
+    const float elevationDeg = (voice.height - 0.5f) * 60.0f;
+
+    std::array<float, VbapPanner::maxOutputs> targetGains {};
+    speakerPanner.computeGains (voice.azimuth, elevationDeg, targetGains.data());
+    juce::FloatVectorOperations::multiply (targetGains.data(), distanceGain, numOutputChannels);
+
+    VbapPanner::applyGains (source, mixBuffer, voice.speakerGains.data(), targetGains.data(), numOutputChannels, numSamples);
+    voice.speakerGains = targetGains;
+
+    // Reflections are excited by the distance-attenuated source, once per object
+    roomSend.addFromWithRamp (0, 0, source, numSamples, voice.sendGain, distanceGain);
+    voice.sendGain = distanceGain;
+}
+
+void MultiObjectRenderer::processSpeakerRoom (int numSamples)
+{
+    // Run the reflections once on the mono send and keep only the wet part
+    float* send = roomSend.getWritePointer (0);
+    float* dry  = voiceBuffer.getWritePointer (0);
+    juce::FloatVectorOperations::copy (dry, send, numSamples);
+
+    juce::AudioBuffer<float> sendView (roomSend.getArrayOfWritePointers(), 1, numSamples);
+    earlyReflection.process (sendView);
+    juce::FloatVectorOperations::subtract (send, dry, numSamples);
+
+    // Diffuse reflections: equal power on every main speaker, none on the LFE
+    const float diffuseGain = speakerPanner.getDiffuseGain();
+    for (int ch = 0; ch < numOutputChannels; ++ch)
+        if (speakerPanner.isMainSpeaker (ch))
+            juce::FloatVectorOperations::addWithMultiply (mixBuffer.getWritePointer (ch), send, diffuseGain, numSamples);
+}
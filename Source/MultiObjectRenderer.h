@@ -0,0 +1,143 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include "EarlyReflectionIR.h"
+#include "AtmosphericAbsorption.h"
+#include "AmbisonicBinauralDecoder.h"
+#include "VbapPanner.h"
+
+//==============================================================================
+/**
+    Multi-object renderer
+    Renders many mono sources inside a single SOFAR instance. Each object only
+    runs a lightweight direct path (distance gain, ISO 9613-1 air absorption,
+    ILD/ITD), while early reflections run once on the shared stereo mix so the
+    cost of the room does not grow with the number of objects.
+    In Ambisonic mode the direct paths are encoded into a shared HOA bed and
+    decoded to binaural once per block instead of panned per object.
+    With a loudspeaker output layout (5.1, 7.1, 7.1.4) each object is
+    VBAP-panned instead; the reflections run once on a mono room send and
+    are spread diffusely, so only the final gain matrix scales with the
+    number of speakers.
+*/
+class MultiObjectRenderer
+{
+public:
+    //==============================================================================
+    static constexpr int maxObjects = 64;
+
+    enum RenderMode
+    {
+        Direct = 0,   // per-object ILD/ITD panning
+        Ambisonic     // per-object SH encoding, one binaural decoder
+    };
+
+    MultiObjectRenderer() = default;
+    ~MultiObjectRenderer() = default;
+
+    //==============================================================================
+    void prepare (double sampleRate, int samplesPerBlock, int numObjects,
+                  const juce::AudioChannelSet& outputLayout = juce::AudioChannelSet::stereo());
+    void reset();
+
+    /** Reads one mono object per input channel and writes the binaural mix to
+        channels 0 and 1 of the same buffer (or the speaker feeds to channels
+        0..N-1 when prepared for a speaker layout). */
+    void process (juce::AudioBuffer<float>& buffer);
+
+    int getNumObjects() const noexcept { return (int) voices.size(); }
+    bool isSpeakerOutput() const noexcept { return speakerOutput; }
+
+    //==============================================================================
+    // Per-object position (distance in metres, azimuth in degrees, height 0-1)
+    void setObjectPosition (int index, float distanceMeters, float azimuthDeg, float heightPercent);
+
+    // Shared room / medium parameters
+    void setRoomDimensions (float width, float height, float length);
+    void setMaxDistance (float maxDistanceMeters);
+    void setRangeLimit (float limitMeters) noexcept   { rangeLimit = juce::jmax (5.0f, limitMeters); }
+    void setAirAbsorption (float absorption);
+    void setAtmosphere (float temperatureCelsius, float humidityPercent, float pressureKPa);
+    void setAirAbsorptionFidelity (AtmosphericAbsorption::Fidelity newFidelity) noexcept { airFidelity = newFidelity; }
+    void setVolumeCompensation (float compensation);
+
+    // Spatialisation back-end
+    void setRenderMode (RenderMode newMode) noexcept { renderMode = newMode; }
+    void setAmbisonicOrder (int order) noexcept      { ambisonicDecoder.setOrder (order); }
+    void setSceneRotation (float yawDegrees) noexcept { ambisonicDecoder.setSceneRotation (yawDegrees); }
+    void setSpeakerSpread (float degrees) noexcept    { speakerPanner.setSpread (degrees); }
+
+private:
+    //==============================================================================
+    struct ObjectVoice
+    {
+        float distance = 0.0f;
+        float azimuth  = 0.0f;
+        float height   = 0.5f;
+
+        // Last applied block-rate values, ramped towards the new targets
+        float gainL = 0.707f;
+        float gainR = 0.707f;
+        float itdSamples = 0.0f;
+
+        // Last applied SH gains (Ambisonic mode)
+        std::array<float, AmbisonicBinauralDecoder::maxChannels> shGains {};
+
+        // Last applied speaker gains (speaker output)
+        std::array<float, VbapPanner::maxOutputs> speakerGains {};
+        float sendGain = 0.0f;
+
+        // Mono, the same model as DistanceProcessor's air stage; created in prepare
+        std::unique_ptr<AtmosphericAbsorption> air;
+
+        // Mono history for the lagging ear (power-of-two ring)
+        std::vector<float> history;
+        int writePos = 0;
+    };
+
+    void processChunk (juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void renderVoice (ObjectVoice& voice, const float* input, int numSamples);
+    void panVoice (ObjectVoice& voice, const float* source, float panNorm, float distanceGain, bool spatialised, int numSamples);
+    void encodeVoice (ObjectVoice& voice, const float* source, float distanceGain, int numSamples);
+    void panVoiceToSpeakers (ObjectVoice& voice, const float* source, float distanceGain, int numSamples);
+    void processSpeakerRoom (int numSamples);
+
+    //==============================================================================
+    double sampleRate = 44100.0;
+    int maxBlockSize = 512;
+    int historyMask = 0;
+
+    float roomWidth  = 6.0f;
+    float roomHeight = 3.0f;
+    float roomLength = 8.0f;
+    float maxDistance = 20.0f;
+    float rangeLimit = 100.0f;   // follows the host processor's range mode
+    float airAbsorption = 0.0f;
+    float temperature = 20.0f;
+    float humidity = 50.0f;
+    float pressure = 101.325f;
+    AtmosphericAbsorption::Fidelity airFidelity = AtmosphericAbsorption::Fast;
+    float volumeCompensation = 0.3f;
+
+    std::vector<ObjectVoice> voices;
+    RenderMode renderMode = Direct;
+    int encodedOrder = AmbisonicBinauralDecoder::maxOrder;
+    bool speakerOutput = false;
+    int numOutputChannels = 2;
+
+    juce::AudioBuffer<float> mixBuffer;   // shared output bus (stereo or speaker feeds)
+    juce::AudioBuffer<float> voiceBuffer; // per-object scratch: filtered + delayed ear
+    juce::AudioBuffer<float> shBed;       // shared HOA bed (Ambisonic mode)
+    juce::AudioBuffer<float> roomSend;    // mono reflection send (speaker output)
+
+    AmbisonicBinauralDecoder ambisonicDecoder;
+    VbapPanner speakerPanner;
+
+    // Room stages run once per block on the shared bus
+    EarlyReflectionIR earlyReflection;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiObjectRenderer)
+};
@@ -24,7 +24,8 @@ const std::vector<SOFARAudioProcessorEditor::PresetData>
 
 //==============================================================================
 SOFARAudioProcessorEditor::SOFARAudioProcessorEditor(SOFARAudioProcessor &p)
-    : AudioProcessorEditor(&p), audioProcessor(p), tooltipWindow(this) {
+    : AudioProcessorEditor(&p), audioProcessor(p), tooltipWindow(this),
+      performanceHud(p.getStageProfiler()) {
   // Set larger window size for clean grid layout (4x2 grid for 8 controls +
   // presets)
   setSize(960, 560);
@@ -201,6 +202,69 @@ SOFARAudioProcessorEditor::SOFARAudioProcessorEditor(SOFARAudioProcessor &p)
                          juce::Colour(0xff20b2aa));
   heightSlider.setTooltip(
       "Vertical position of source (0% floor – 100% ceiling).");
+
+  // Performance overlay, added last so it draws above the controls
+  performanceButton.setButtonText("CPU");
+  performanceButton.setClickingTogglesState(true);
+  performanceButton.setColour(juce::TextButton::buttonColourId,
+                              juce::Colour(0xff2a2a2a));
+  performanceButton.setColour(juce::TextButton::buttonOnColourId,
+                              juce::Colour(0xff4a90e2));
+  performanceButton.setTooltip(
+      "Show per-stage audio-thread timings (click the overlay to reset "
+      "worst cases).");
+  performanceButton.onClick = [this] {
+    performanceHud.setActive(performanceButton.getToggleState());
+  };
+  addAndMakeVisible(performanceButton);
+
+  traceButton.setButtonText("TRACE");
+  traceButton.setClickingTogglesState(true);
+  traceButton.setToggleState(audioProcessor.getTraceRecorder().isArmed(),
+                             juce::dontSendNotification);
+  traceButton.setColour(juce::TextButton::buttonColourId,
+                        juce::Colour(0xff2a2a2a));
+  traceButton.setColour(juce::TextButton::buttonOnColourId,
+                        juce::Colour(0xffff7f50));
+  traceButton.setTooltip(
+      "Record audio-thread timings while on; switching off saves the last "
+      "half minute as a Chrome trace (chrome://tracing, Perfetto).");
+  traceButton.onClick = [this] {
+    if (traceButton.getToggleState()) {
+      audioProcessor.getTraceRecorder().arm();
+    } else {
+      audioProcessor.getTraceRecorder().disarm();
+      saveTrace();
+    }
+  };
+  addAndMakeVisible(traceButton);
+
+  addChildComponent(performanceHud);
+}
+
+void SOFARAudioProcessorEditor::saveTrace() {
+  const auto file =
+      juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+          .getNonexistentChildFile(
+              "SOFAR-trace-" +
+                  juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S"),
+              ".json");
+
+  bool saved = false;
+  {
+    juce::FileOutputStream stream(file);
+    saved = stream.openedOk() &&
+            audioProcessor.getTraceRecorder().exportJson(stream);
+  }
+
+  if (saved)
+    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon,
+                                           "Trace saved",
+                                           file.getFullPathName());
+  else
+    juce::AlertWindow::showMessageBoxAsync(
+        juce::MessageBoxIconType::WarningIcon, "Trace not saved",
+        "Could not write " + file.getFullPathName());
 }
 
 SOFARAudioProcessorEditor::~SOFARAudioProcessorEditor() {
@@ -286,6 +350,12 @@ void SOFARAudioProcessorEditor::resized() {
 
   presetsComboBox.setBounds(presetsArea);
 
+  // Overlay and trace toggles in the top-right corner, the overlay beside them
+  performanceButton.setBounds(getWidth() - 48, 8, 44, 24);
+  traceButton.setBounds(getWidth() - 48, 36, 44, 20);
+  performanceHud.setBounds(getWidth() - 406, 40, 350,
+                           PerformanceHud::getPreferredHeight());
+
   // Title area (80px total)
   auto titleArea = bounds.removeFromTop(80);
   titleLabel.setBounds(titleArea.removeFromTop(40));
@@ -423,6 +493,16 @@ void SOFARAudioProcessorEditor::loadPreset(int presetIndex) {
         .setValue(preset.roomWidth);
     audioProcessor.parameters.getParameterAsValue("roomHeight")
         .setValue(preset.roomHeight);
+    // Spaces beyond 100 m need the long-range delay memory, with the
+    // preset's longer side as the extent
+    const float presetExtent = std::max(preset.roomLength, preset.roomWidth);
+    const bool presetIsLongRange =
+        presetExtent > DistanceProcessor::roomRangeLimit;
+    audioProcessor.parameters.getParameterAsValue("rangeMode")
+        .setValue(presetIsLongRange ? 1 : 0);
+    if (presetIsLongRange)
+      audioProcessor.parameters.getParameterAsValue("rangeExtent")
+          .setValue(presetExtent);
     audioProcessor.parameters.getParameterAsValue("airAbsorption")
         .setValue(preset.airAbsorption);
     audioProcessor.parameters.getParameterAsValue("temperature")
@@ -465,4 +545,107 @@ void SOFARAudioProcessorEditor::navigatePreset(int direction) {
   // Update ComboBox without triggering its onChange (we'll load manually)
   presetsComboBox.setSelectedItemIndex(newIndex, juce::dontSendNotification);
   loadPreset(newIndex - 1); // Adjust for "Select Preset..."
-}
\ No newline at end of file
+}
+//==============================================================================
+PerformanceHud::PerformanceHud(StageProfiler &profilerToShow)
+    : profiler(profilerToShow) {
+  setInterceptsMouseClicks(true, false);
+}
+
+PerformanceHud::~PerformanceHud() { profiler.setEnabled(false); }
+
+void PerformanceHud::setActive(bool shouldBeActive) {
+  if (shouldBeActive) {
+    profiler.resetWorstCase();
+    profiler.takeSnapshot(); // discard whatever accumulated while hidden
+    snapshot = {};
+    profiler.setEnabled(true);
+    startTimerHz(15);
+  } else {
+    stopTimer();
+    profiler.setEnabled(false);
+  }
+
+  setVisible(shouldBeActive);
+}
+
+void PerformanceHud::timerCallback() {
+  auto latest = profiler.takeSnapshot();
+
+  // Keep the last reading while the host is not processing
+  if (latest.blocks > 0) {
+    snapshot = latest;
+    repaint();
+  }
+}
+
+void PerformanceHud::mouseDown(const juce::MouseEvent &) {
+  profiler.resetWorstCase();
+}
+
+void PerformanceHud::paint(juce::Graphics &g) {
+  g.setColour(juce::Colours::black.withAlpha(0.85f));
+  g.fillRoundedRectangle(getLocalBounds().toFloat(), 6.0f);
+  g.setColour(juce::Colour(0xff4a90e2).withAlpha(0.6f));
+  g.drawRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), 6.0f,
+                         1.0f);
+
+  g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f,
+                       juce::Font::plain));
+
+  auto area = getLocalBounds().reduced(10, 6);
+  const auto drawRow = [&](const juce::String &name, const juce::String &average,
+                           const juce::String &percent,
+                           const juce::String &worst, juce::Colour colour) {
+    auto row = area.removeFromTop(rowHeight);
+    g.setColour(colour);
+    g.drawText(name, row.removeFromLeft(120), juce::Justification::centredLeft);
+    g.drawText(average, row.removeFromLeft(70), juce::Justification::centredRight);
+    g.drawText(percent, row.removeFromLeft(70), juce::Justification::centredRight);
+    g.drawText(worst, row, juce::Justification::centredRight);
+  };
+
+  const auto micros = [](double value) { return juce::String(value, 1); };
+  const auto percent = [](double value) { return juce::String(value, 2) + "%"; };
+
+  drawRow("Stage", "us/block", "deadline", "worst us", juce::Colours::lightgrey);
+
+  if (snapshot.blocks == 0) {
+    drawRow("waiting for audio", {}, {}, {}, juce::Colours::grey);
+    return;
+  }
+
+  for (int i = 0; i < StageProfiler::numStages; ++i) {
+    const auto stage = static_cast<StageProfiler::Stage>(i);
+    const bool idle = snapshot.averageMicros[(size_t)i] <= 0.0 &&
+                      snapshot.worstMicros[(size_t)i] <= 0.0;
+    drawRow(StageProfiler::getStageName(stage),
+            micros(snapshot.averageMicros[(size_t)i]),
+            percent(snapshot.deadlinePercent[(size_t)i]),
+            micros(snapshot.worstMicros[(size_t)i]),
+            idle ? juce::Colours::grey : juce::Colours::white);
+  }
+
+  area.removeFromTop(rowHeight / 2);
+  drawRow("Block total", micros(snapshot.blockAverageMicros),
+          percent(snapshot.blockDeadlinePercent),
+          micros(snapshot.blockWorstMicros),
+          snapshot.blockDeadlinePercent > 50.0 ? juce::Colour(0xffff7f50)
+                                               : juce::Colour(0xff7bd389));
+
+  drawRow("p50/p99/p99.9", micros(snapshot.blockP50Micros),
+          micros(snapshot.blockP99Micros), micros(snapshot.blockP999Micros),
+          juce::Colours::white);
+
+  const auto overBudgetShare =
+      snapshot.histogramBlocks > 0
+          ? 100.0 * (double)snapshot.overBudgetBlocks /
+                (double)snapshot.histogramBlocks
+          : 0.0;
+  drawRow("Over " + juce::String(juce::roundToInt(profiler.getBudgetPercent())) +
+              "% budget",
+          juce::String(snapshot.overBudgetBlocks), percent(overBudgetShare),
+          "of " + juce::String(snapshot.histogramBlocks),
+          snapshot.overBudgetBlocks > 0 ? juce::Colour(0xffff7f50)
+                                        : juce::Colour(0xff7bd389));
+}
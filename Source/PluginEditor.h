@@ -3,6 +3,38 @@
 #include "PluginProcessor.h"
 #include <JuceHeader.h>
 
+//==============================================================================
+/**
+    Performance overlay
+    Per-stage audio-thread timings: average per block, share of the block's
+    deadline and worst case, then the block-time tail percentiles and the
+    blocks over the profiler's budget. Profiling runs only while the overlay
+    is shown, polled at 15 Hz; a click resets the worst cases and the tail.
+*/
+class PerformanceHud : public juce::Component, private juce::Timer {
+public:
+  explicit PerformanceHud(StageProfiler &profilerToShow);
+  ~PerformanceHud() override;
+
+  void setActive(bool shouldBeActive);
+
+  void paint(juce::Graphics &) override;
+  void mouseDown(const juce::MouseEvent &) override;
+
+  static constexpr int rowHeight = 16;
+  static int getPreferredHeight() {
+    return (StageProfiler::numStages + 5) * rowHeight + 12;
+  }
+
+private:
+  void timerCallback() override;
+
+  StageProfiler &profiler;
+  StageProfiler::Snapshot snapshot;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceHud)
+};
+
 //==============================================================================
 /**
     Simplified SOFAR Audio Processor Editor
@@ -93,6 +125,14 @@ private:
   // Add TooltipWindow for hover descriptions
   juce::TooltipWindow tooltipWindow;
 
+  // Performance overlay toggle
+  juce::TextButton performanceButton;
+  PerformanceHud performanceHud;
+
+  // Trace capture: armed while on, saved as trace-event JSON when switched off
+  juce::TextButton traceButton;
+  void saveTrace();
+
   // Cached background to avoid recreating gradient every paint
   juce::Image backgroundImage;
   void updateBackgroundImage();
@@ -12,7 +12,7 @@ SOFARAudioProcessor::SOFARAudioProcessor()
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        ),
-      parameters(*this, nullptr),
+      parameters(*this, nullptr, juce::Identifier("SOFAR"), createParameterLayout()),
       currentRoomType(0),
       isInitialized(false)
 #else
@@ -23,12 +23,36 @@ SOFARAudioProcessor::SOFARAudioProcessor()
 {
     // Optimized constructor - minimal work, thread-safe initialization
     juce::Logger::writeToLog("SOFAR plugin constructor - optimized version");
+    
+    for (int i = 0; i < MultiObjectRenderer::maxObjects; ++i)
+    {
+        const juce::String suffix (i + 1);
+        objectDistanceParams[(size_t) i] = parameters.getRawParameterValue("objDistance" + suffix);
+        objectAzimuthParams[(size_t) i]  = parameters.getRawParameterValue("objAzimuth" + suffix);
+        objectHeightParams[(size_t) i]   = parameters.getRawParameterValue("objHeight" + suffix);
+    }
+    
+    sharedRoomParam = parameters.getRawParameterValue("sharedRoom");
+    roomSendParam = parameters.getRawParameterValue("roomSend");
+    roomRoleParam = parameters.getRawParameterValue("roomRole");
+    rangeModeParam = parameters.getRawParameterValue("rangeMode");
+    rangeExtentParam = parameters.getRawParameterValue("rangeExtent");
+    
+    distanceProcessor.setEventLog(&audioThreadLog);
+    distanceProcessor.getStageProfiler().setTraceRecorder(&traceRecorder);
+    
+    // Posting a message from the audio thread can allocate and lock, so the
+    // audio thread only raises a flag and this timer picks it up
+    startTimerHz(30);
 }
 
 SOFARAudioProcessor::~SOFARAudioProcessor()
 {
     // Optimized destructor with proper cleanup order
+    stopTimer();
+    cancelPendingUpdate();
     isInitialized = false;
+    sharedRoom.leave();
     distanceProcessor.reset();
 }
 
@@ -67,7 +91,8 @@ bool SOFARAudioProcessor::isMidiEffect() const
 
 double SOFARAudioProcessor::getTailLengthSeconds() const
 {
-    return 2.0; // Optimized: Reduced tail time for better performance
+    // A far source is still in flight when its input stops
+    return distanceProcessor.getTailLengthSeconds();
 }
 
 int SOFARAudioProcessor::getNumPrograms()
@@ -118,8 +143,39 @@ void SOFARAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     }
     
     try {
-        // Thread-safe preparation with new interface
+        // Thread-safe preparation with new interface; the delay memory is
+        // sized for the selected range only
+        // Nothing is processing, so changes queued while stopped apply now
+        jassert(! processingBlock.load());
+        if (! processingBlock.load())
+            applyPendingCommands();
+        distanceProcessor.setLongRange(rangeModeParam->load() > 0.5f);
         distanceProcessor.prepare(sampleRate, samplesPerBlock);
+        doublePrecisionChannels = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+        doublePrecisionBlockSize = samplesPerBlock;
+        doublePrecisionBridge.setSize(doublePrecisionChannels, doublePrecisionBlockSize);
+        
+        // Mono-in/stereo-out: pre-spatialisation runs once on the mono source
+        distanceProcessor.setMonoInput(getMainBusNumInputChannels() == 1 && getMainBusNumOutputChannels() == 2);
+        
+        // Multi-object mode: one mono object per input channel
+        numObjects = isMultiObjectMode() ? juce::jmin(getMainBusNumInputChannels(), MultiObjectRenderer::maxObjects) : 0;
+        
+        // Speaker layouts: a single source is rendered as one mono object
+        speakerOutput = isSpeakerOutput();
+        objectRenderer.prepare(sampleRate, samplesPerBlock,
+                               numObjects > 0 ? numObjects : (speakerOutput ? 1 : 0),
+                               getChannelLayoutOfBus(false, 0));
+        
+        // Aligned delay mode: latency is reported before playback starts
+        const int latency = numObjects > 0 || speakerOutput ? 0 : applyDelaySettings();
+        requiredLatency = latency;
+        reportedLatency = latency;
+        setLatencySamples(latency);
+        
+        // Shared room: rejoin with the new sample rate and block size
+        sharedRoom.leave();
+        joinSharedRoom();
         
         // Mark as successfully initialized
         isInitialized = true;
@@ -140,6 +196,8 @@ void SOFARAudioProcessor::releaseResources()
     // Optimized cleanup sequence
     isInitialized = false;
     distanceProcessor.reset();
+    objectRenderer.reset();
+    sharedRoom.leave();
     juce::Logger::writeToLog("SOFAR resources released");
 }
 
@@ -154,12 +212,25 @@ bool SOFARAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
     const auto& mainOutput = layouts.getMainOutputChannelSet();
     const auto& mainInput = layouts.getMainInputChannelSet();
     
+    // Multi-object mode: N discrete mono objects rendered to stereo or speakers
+    if (mainInput.isDiscreteLayout())
+        return (mainOutput == juce::AudioChannelSet::stereo() || VbapPanner::isSupportedLayout(mainOutput))
+            && mainInput.size() >= 1
+            && mainInput.size() <= MultiObjectRenderer::maxObjects;
+    
+    // Speaker output: a mono or stereo source panned with VBAP
+    if (VbapPanner::isSupportedLayout(mainOutput))
+        return mainInput == juce::AudioChannelSet::mono()
+            || mainInput == juce::AudioChannelSet::stereo();
+    
     if (mainOutput != juce::AudioChannelSet::mono() && 
         mainOutput != juce::AudioChannelSet::stereo())
         return false;
 
    #if ! JucePlugin_IsSynth
-    if (mainOutput != mainInput)
+    // Mono sources may be rendered straight to stereo
+    if (mainOutput != mainInput
+        && ! (mainInput == juce::AudioChannelSet::mono() && mainOutput == juce::AudioChannelSet::stereo()))
         return false;
    #endif
 
@@ -170,8 +241,17 @@ bool SOFARAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
 
 void SOFARAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    // Marks the command queue's consumer as busy for the whole block
+    struct ProcessingScope
+    {
+        explicit ProcessingScope(std::atomic<bool>& f) : flag(f) { flag = true; }
+        ~ProcessingScope() { flag = false; }
+        std::atomic<bool>& flag;
+    } processingScope(processingBlock);
+    
     try {
         juce::ScopedNoDenormals noDenormals;
+        applyPendingCommands();
         
         auto totalNumInputChannels  = getTotalNumInputChannels();
         auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -180,25 +260,31 @@ void SOFARAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
         for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
             buffer.clear (i, 0, buffer.getNumSamples());
         
+        if (numObjects > 0)
+        {
+            processObjects(buffer);
+            processSharedRoom(buffer);
+            return;
+        }
+        
+        if (speakerOutput)
+        {
+            processSpeakerSource(buffer);
+            return;
+        }
+        
         // Get parameter values including new room dimensions
         float distance = *parameters.getRawParameterValue("distance");
         float panning = *parameters.getRawParameterValue("panning");
         float heightPct = *parameters.getRawParameterValue("height");
-        float roomLength = *parameters.getRawParameterValue("roomLength");
-        float roomWidth = *parameters.getRawParameterValue("roomWidth");
+        float roomLength, roomWidth;
+        getRenderedRoomSize(roomLength, roomWidth);
         float roomHeight = *parameters.getRawParameterValue("roomHeight");
         float airAbsorption = *parameters.getRawParameterValue("airAbsorption");
         float volumeCompensation = *parameters.getRawParameterValue("volumeCompensation");
         float temperature = *parameters.getRawParameterValue("temperature");
         
-        // Convert azimuth to lateral factor (|sin| gives 0–1 based on side offset)
-        const float panAmount = std::abs(std::sin(panning * juce::MathConstants<float>::pi / 180.0f));
-        
-        // Calculate effective max distance based on panning and room dimensions
-        // When centered (pan=0): use room length
-        // When panned left/right: interpolate between length and width
-        float effectiveMaxDistance = roomLength + panAmount * (roomWidth - roomLength);
-        effectiveMaxDistance = juce::jmax(effectiveMaxDistance, 2.0f); // Minimum 2m
+        const float effectiveMaxDistance = computeEffectiveMaxDistance(panning, roomLength, roomWidth);
         
         // Convert distance from percentage to actual meters based on current room size
         float actualDistance = distance * effectiveMaxDistance;
@@ -212,20 +298,283 @@ void SOFARAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
         distanceProcessor.setAirAbsorption(airAbsorption);
         distanceProcessor.setVolumeCompensation(volumeCompensation);
         distanceProcessor.setTemperature(temperature);
+        distanceProcessor.setHumidity(*parameters.getRawParameterValue("humidity"));
+        distanceProcessor.setAtmosphericPressure(*parameters.getRawParameterValue("pressure"));
+        distanceProcessor.currentAirAbsorptionMode = parameters.getRawParameterValue("airAbsorptionModel")->load() > 0.5f
+                                                         ? DistanceProcessor::AirAbsorptionB
+                                                         : DistanceProcessor::AirAbsorptionA;
         distanceProcessor.setSourceHeight(heightPct);
         
+        // Latency changes are reported from the message thread; until the host
+        // has the new value the delay keeps rendering against the old one
+        const int latency = applyDelaySettings();
+        distanceProcessor.setReportedLatency(reportedLatency.load());
+        if (latency != requiredLatency.load())
+        {
+            requiredLatency = latency;
+            hostUpdatePending = true;
+        }
+        
         // Process with actual distance in meters (not percentage)
-        auto env = static_cast<DistanceProcessor::Environment> (currentRoomType);
-        distanceProcessor.processBlock(buffer, actualDistance, panning, env);
+        distanceProcessor.processBlock(buffer, actualDistance, panning, activeEnvironment);
+        processSharedRoom(buffer);
         
-    } catch (const std::exception& e) {
-        juce::Logger::writeToLog("Exception in processBlock: " + juce::String(e.what()));
+    } catch (const std::exception&) {
+        audioThreadLog.push(AudioThreadLog::ProcessException);
         // Continue with unprocessed audio rather than crash
     } catch (...) {
-        juce::Logger::writeToLog("Unknown exception in processBlock");
+        audioThreadLog.push(AudioThreadLog::ProcessUnknownException);
     }
 }
 
+void SOFARAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Every stage renders in float, so the double buffer is converted into a
+    // scratch buffer sized in prepareToPlay and back, with no second DSP path
+    const int numChannels = juce::jmin(buffer.getNumChannels(), doublePrecisionChannels);
+    const int maxBlockSize = doublePrecisionBlockSize;
+    
+    if (numChannels <= 0 || maxBlockSize <= 0)
+        return;
+    
+    for (int start = 0; start < buffer.getNumSamples(); start += maxBlockSize)
+    {
+        const int chunk = juce::jmin(maxBlockSize, buffer.getNumSamples() - start);
+        
+        // Shrinking in place never reallocates, where a view would allocate
+        // its channel list above 32 channels
+        auto& bridge = doublePrecisionBridge;
+        bridge.setSize(numChannels, chunk, false, false, true);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const double* source = buffer.getReadPointer(ch, start);
+            float* destination = bridge.getWritePointer(ch);
+            for (int n = 0; n < chunk; ++n)
+                destination[n] = static_cast<float>(source[n]);
+        }
+        
+        processBlock(bridge, midiMessages);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* source = bridge.getReadPointer(ch);
+            double* destination = buffer.getWritePointer(ch, start);
+            for (int n = 0; n < chunk; ++n)
+                destination[n] = static_cast<double>(source[n]);
+        }
+    }
+}
+
+bool SOFARAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+float SOFARAudioProcessor::computeEffectiveMaxDistance(float azimuthDeg, float roomLength, float roomWidth)
+{
+    // Convert azimuth to lateral factor (|sin| gives 0–1 based on side offset)
+    const float panAmount = std::abs(std::sin(azimuthDeg * juce::MathConstants<float>::pi / 180.0f));
+    
+    // Calculate effective max distance based on panning and room dimensions
+    // When centered (pan=0): use room length
+    // When panned left/right: interpolate between length and width
+    const float effectiveMaxDistance = roomLength + panAmount * (roomWidth - roomLength);
+    return juce::jmax(effectiveMaxDistance, 2.0f); // Minimum 2m
+}
+
+void SOFARAudioProcessor::getRenderedRoomSize(float& roomLength, float& roomWidth)
+{
+    roomLength = *parameters.getRawParameterValue("roomLength");
+    roomWidth = *parameters.getRawParameterValue("roomWidth");
+    
+    // Until a range change has been applied the current limit holds
+    if ((rangeModeParam->load() > 0.5f) != distanceProcessor.isLongRange())
+        hostUpdatePending = true;
+    
+    // Long range keeps the room's proportions and stretches its longer side
+    // out to the extent
+    if (distanceProcessor.isLongRange())
+    {
+        const float scale = juce::jmax(1.0f, rangeExtentParam->load() / juce::jmax(roomLength, roomWidth));
+        roomLength *= scale;
+        roomWidth *= scale;
+    }
+    
+    const float rangeLimit = distanceProcessor.getRangeLimit();
+    roomLength = juce::jmin(rangeLimit, roomLength);
+    roomWidth = juce::jmin(rangeLimit, roomWidth);
+}
+
+void SOFARAudioProcessor::updateObjectRendererParameters()
+{
+    // Room parameters are shared by every object
+    float roomLength, roomWidth;
+    getRenderedRoomSize(roomLength, roomWidth);
+    const float roomHeight = *parameters.getRawParameterValue("roomHeight");
+    
+    objectRenderer.setRangeLimit(distanceProcessor.getRangeLimit());
+    objectRenderer.setRoomDimensions(roomWidth, roomHeight, roomLength);
+    objectRenderer.setMaxDistance(juce::jmax(roomLength, roomWidth));
+    objectRenderer.setAirAbsorption(*parameters.getRawParameterValue("airAbsorption"));
+    objectRenderer.setAtmosphere(*parameters.getRawParameterValue("temperature"),
+                                 *parameters.getRawParameterValue("humidity"),
+                                 *parameters.getRawParameterValue("pressure"));
+    objectRenderer.setAirAbsorptionFidelity(parameters.getRawParameterValue("airAbsorptionModel")->load() > 0.5f
+                                                ? AtmosphericAbsorption::Accurate
+                                                : AtmosphericAbsorption::Fast);
+    objectRenderer.setVolumeCompensation(*parameters.getRawParameterValue("volumeCompensation"));
+    
+    // Spatialisation back-end: per-object panning or shared HOA bed + one binaural decoder
+    const int renderMode = static_cast<int>(parameters.getRawParameterValue("objectRenderMode")->load());
+    objectRenderer.setRenderMode(static_cast<MultiObjectRenderer::RenderMode>(renderMode));
+    objectRenderer.setAmbisonicOrder(static_cast<int>(parameters.getRawParameterValue("hoaOrder")->load()));
+    objectRenderer.setSceneRotation(*parameters.getRawParameterValue("sceneRotation"));
+    objectRenderer.setSpeakerSpread(*parameters.getRawParameterValue("speakerSpread"));
+}
+
+void SOFARAudioProcessor::processObjects(juce::AudioBuffer<float>& buffer)
+{
+    updateObjectRendererParameters();
+    
+    float roomLength, roomWidth;
+    getRenderedRoomSize(roomLength, roomWidth);
+    
+    for (int i = 0; i < numObjects; ++i)
+    {
+        const float azimuth = objectAzimuthParams[(size_t) i]->load();
+        const float maxDistance = computeEffectiveMaxDistance(azimuth, roomLength, roomWidth);
+        
+        objectRenderer.setObjectPosition(i,
+                                         objectDistanceParams[(size_t) i]->load() * maxDistance,
+                                         azimuth,
+                                         objectHeightParams[(size_t) i]->load());
+    }
+    
+    objectRenderer.process(buffer);
+}
+
+void SOFARAudioProcessor::processSpeakerSource(juce::AudioBuffer<float>& buffer)
+{
+    updateObjectRendererParameters();
+    
+    const int numSamples = buffer.getNumSamples();
+    const int numInputs = juce::jmin(getTotalNumInputChannels(), buffer.getNumChannels());
+    
+    // Fold the input to mono: distance, air and reflections then run once
+    // instead of once per speaker
+    if (numInputs > 1)
+    {
+        for (int ch = 1; ch < numInputs; ++ch)
+            buffer.addFrom(0, 0, buffer, ch, 0, numSamples);
+        buffer.applyGain(0, 0, numSamples, 1.0f / static_cast<float>(numInputs));
+    }
+    
+    const float panning = *parameters.getRawParameterValue("panning");
+    float roomLength, roomWidth;
+    getRenderedRoomSize(roomLength, roomWidth);
+    const float effectiveMaxDistance = computeEffectiveMaxDistance(panning, roomLength, roomWidth);
+    
+    objectRenderer.setObjectPosition(0,
+                                     *parameters.getRawParameterValue("distance") * effectiveMaxDistance,
+                                     panning,
+                                     *parameters.getRawParameterValue("height"));
+    objectRenderer.process(buffer);
+}
+
+void SOFARAudioProcessor::processSharedRoom(juce::AudioBuffer<float>& buffer)
+{
+    // The room bus is stereo; speaker layouts keep their local reflections only
+    if (speakerOutput)
+        return;
+    
+    const int roomId = static_cast<int>(sharedRoomParam->load());
+    const bool asReturn = roomRoleParam->load() > 0.5f;
+    if (roomId != requestedRoomId || asReturn != requestedRoomReturn)
+    {
+        requestedRoomId = roomId;
+        requestedRoomReturn = asReturn;
+        hostUpdatePending = true;
+    }
+    
+    if (sharedRoom.getRoomId() == 0)
+        return;
+    
+    // Only the rendering return's settings reach the shared reverb
+    if (sharedRoom.isOwner())
+        sharedRoom.setReverbParameters(distanceProcessor.getLateReverbParameters());
+    
+    if (! sharedRoom.process(buffer, buffer.getNumSamples(), roomSendParam->load()))
+        audioThreadLog.push(AudioThreadLog::RoomSendDropped, static_cast<float>(sharedRoom.getRoomId()));
+}
+
+int SOFARAudioProcessor::applyDelaySettings()
+{
+    distanceProcessor.setDelayInterpolation(static_cast<PropagationDelay::Interpolation>(
+        static_cast<int>(parameters.getRawParameterValue("delayInterpolation")->load())));
+    
+    // The reference is in metres, so room and max-distance changes never move the latency
+    distanceProcessor.setAlignedDelay(parameters.getRawParameterValue("delayMode")->load() > 0.5f,
+                                      *parameters.getRawParameterValue("referenceDistance"));
+    
+    return distanceProcessor.getRequiredLatency();
+}
+
+void SOFARAudioProcessor::joinSharedRoom()
+{
+    const int roomId = speakerOutput ? 0 : static_cast<int>(sharedRoomParam->load());
+    const bool asReturn = roomRoleParam->load() > 0.5f;
+    requestedRoomId = static_cast<int>(sharedRoomParam->load());
+    requestedRoomReturn = asReturn;
+    
+    if (roomId == sharedRoom.getRoomId() && (roomId == 0 || asReturn == sharedRoom.isReturn()))
+        return;
+    
+    if (! sharedRoom.join(roomId, asReturn, getSampleRate(), getBlockSize()))
+        juce::Logger::writeToLog("Shared room " + juce::String(roomId) + " unavailable - using local room only");
+}
+
+void SOFARAudioProcessor::handleAsyncUpdate()
+{
+    // A room type restored on a host thread is queued from here
+    const int roomType = pendingRoomType.exchange(-1);
+    if (roomType >= 0)
+        pushRoomType(roomType);
+    
+    if (! isInitialized)
+        return;
+    
+    // Coalesced: a dragged reference distance only reports its latest latency
+    const int latency = requiredLatency.load();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+    reportedLatency = latency;
+    
+    // Delay memory and room membership must not change under this instance's own processBlock
+    const bool longRange = rangeModeParam->load() > 0.5f;
+    const bool rangeChanged = longRange != distanceProcessor.isLongRange();
+    
+    if (! rangeChanged && requestedRoomId.load() == sharedRoom.getRoomId()
+        && (sharedRoom.getRoomId() == 0 || requestedRoomReturn.load() == sharedRoom.isReturn()))
+        return;
+    
+    const bool wasSuspended = isSuspended();
+    suspendProcessing(true);
+    distanceProcessor.setLongRange(longRange);
+    joinSharedRoom();
+    suspendProcessing(wasSuspended);
+    
+    // The tail follows the range
+    if (rangeChanged)
+        updateHostDisplay();
+}
+
+void SOFARAudioProcessor::timerCallback()
+{
+    if (hostUpdatePending.exchange(false))
+        handleAsyncUpdate();
+}
+
 //==============================================================================
 bool SOFARAudioProcessor::hasEditor() const
 {
@@ -250,7 +599,7 @@ void SOFARAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
         auto state = parameters.copyState();
         
         // Add room type to state
-        state.setProperty("roomType", currentRoomType, nullptr);
+        state.setProperty("roomType", currentRoomType.load(), nullptr);
         
         std::unique_ptr<juce::XmlElement> xml (state.createXml());
         if (xml != nullptr)
@@ -297,7 +646,46 @@ void SOFARAudioProcessor::setStateInformation (const void* data, int sizeInBytes
 void SOFARAudioProcessor::setRoomType(int roomType)
 {
     currentRoomType = juce::jlimit(0, DistanceProcessor::numEnvironments - 1, roomType);
-    distanceProcessor.setEnvironmentType (static_cast<DistanceProcessor::Environment>(currentRoomType));
+    
+    // Hosts may restore state on any thread; the queue takes one producer,
+    // so everything else is marshalled onto the message thread
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        pendingRoomType = -1;
+        pushRoomType(currentRoomType);
+        return;
+    }
+    
+    pendingRoomType = currentRoomType.load();
+    triggerAsyncUpdate();
+}
+
+void SOFARAudioProcessor::pushRoomType(int roomType)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    
+    // The environment rewrites room dimensions the audio thread reads mid-block,
+    // so it is handed over rather than set here
+    if (! commandQueue.push(AudioCommandQueue::SetEnvironment, roomType))
+        juce::Logger::writeToLog("Command queue full - room type change dropped");
+}
+
+void SOFARAudioProcessor::applyPendingCommands()
+{
+    commandQueue.apply([this] (AudioCommandQueue::Command command, int value)
+    {
+        switch (command)
+        {
+            case AudioCommandQueue::SetEnvironment:
+                activeEnvironment = static_cast<DistanceProcessor::Environment>(value);
+                distanceProcessor.setEnvironmentType(activeEnvironment);
+                break;
+                
+            case AudioCommandQueue::numCommands:
+            default:
+                break;
+        }
+    });
 }
 
 int SOFARAudioProcessor::getCurrentRoomType() const
@@ -310,6 +698,21 @@ bool SOFARAudioProcessor::isPluginInitialized() const
     return isInitialized;
 }
 
+bool SOFARAudioProcessor::isSpeakerOutput() const
+{
+    return getBusCount(false) > 0 && VbapPanner::isSupportedLayout(getChannelLayoutOfBus(false, 0));
+}
+
+bool SOFARAudioProcessor::isMultiObjectMode() const
+{
+    return getBusCount(true) > 0 && getChannelLayoutOfBus(true, 0).isDiscreteLayout();
+}
+
+int SOFARAudioProcessor::getNumObjects() const
+{
+    return numObjects;
+}
+
 //==============================================================================
 // Parameter layout creation
 juce::AudioProcessorValueTreeState::ParameterLayout SOFARAudioProcessor::createParameterLayout()
@@ -329,13 +732,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout SOFARAudioProcessor::createP
     // Room Dimensions Controls
     layout.add(std::make_unique<juce::AudioParameterFloat>(
         "roomLength", "Room Length", 
-        juce::NormalisableRange<float>(2.0f, 100.0f, 0.5f), 8.0f,
+        juce::NormalisableRange<float>(2.0f, DistanceProcessor::roomRangeLimit, 0.5f), 8.0f,
         juce::String(), juce::AudioProcessorParameter::genericParameter,
         [](float value, int) { return juce::String(value, 1) + "m"; }));
         
     layout.add(std::make_unique<juce::AudioParameterFloat>(
         "roomWidth", "Room Width", 
-        juce::NormalisableRange<float>(2.0f, 100.0f, 0.5f), 6.0f,
+        juce::NormalisableRange<float>(2.0f, DistanceProcessor::roomRangeLimit, 0.5f), 6.0f,
         juce::String(), juce::AudioProcessorParameter::genericParameter,
         [](float value, int) { return juce::String(value, 1) + "m"; }));
         
@@ -366,6 +769,23 @@ juce::AudioProcessorValueTreeState::ParameterLayout SOFARAudioProcessor::createP
         juce::String(), juce::AudioProcessorParameter::genericParameter,
         [](float value, int) { return juce::String(value, 1) + "°C"; }));
     
+    // Atmosphere for the ISO 9613-1 air absorption model
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "humidity", "Humidity",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f), 50.0f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(value, 0) + "%"; }));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "pressure", "Pressure",
+        juce::NormalisableRange<float>(50.0f, 110.0f, 0.1f), 101.3f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(value, 1) + " kPa"; }));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "airAbsorptionModel", "Air Absorption Model",
+        juce::StringArray { "Fast", "Accurate" }, 1));
+    
     // Now a 360° azimuth control (0° = front, 90° = right, 180° = back, 270° = left)
     layout.add(std::make_unique<juce::AudioParameterFloat>(
         "panning", "Panning",
@@ -389,6 +809,99 @@ juce::AudioProcessorValueTreeState::ParameterLayout SOFARAudioProcessor::createP
         juce::String(), juce::AudioProcessorParameter::genericParameter,
         [](float value, int) { return juce::String(value * 100.0f, 1) + "%"; }));
     
+    // Propagation delay interpolation (quality vs. CPU)
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "delayInterpolation", "Delay Interpolation",
+        juce::StringArray { "Lagrange-3", "Thiran", "Windowed Sinc" }, 0));
+    
+    // Natural: the full propagation delay is heard. Aligned: the delay at the
+    // reference distance is reported as latency and compensated by the host
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "delayMode", "Delay Mode",
+        juce::StringArray { "Natural", "Aligned" }, 0));
+    
+    // Room: 100 m limit. Long Range: 1 km for outdoor and stadium work
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "rangeMode", "Range Mode",
+        juce::StringArray { "Room", "Long Range" }, 0));
+    
+    // Long Range only: the length of the room's longer side out of doors
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "rangeExtent", "Long Range Extent",
+        juce::NormalisableRange<float>(DistanceProcessor::roomRangeLimit, DistanceProcessor::longRangeLimit, 1.0f), 500.0f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(value, 0) + "m"; }));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "referenceDistance", "Reference Distance",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 0.5f), 5.0f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(value, 1) + "m"; }));
+    
+    // Multi-object spatialisation back-end
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "objectRenderMode", "Object Render Mode",
+        juce::StringArray { "Direct", "Ambisonic" }, 0));
+    
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        "hoaOrder", "Ambisonic Order", 1, AmbisonicBinauralDecoder::maxOrder, AmbisonicBinauralDecoder::maxOrder));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "sceneRotation", "Scene Rotation",
+        juce::NormalisableRange<float>(-180.0f, 180.0f, 1.0f), 0.0f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(int(std::round(value))) + juce::String("°"); }));
+    
+    // MDAP spread for speaker layouts (0 = plain VBAP)
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "speakerSpread", "Speaker Spread",
+        juce::NormalisableRange<float>(0.0f, 90.0f, 1.0f), 0.0f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(int(std::round(value))) + juce::String("°"); }));
+    
+    // Cross-instance shared room: 0 = private, otherwise instances with the
+    // same ID share one late reverb
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        "sharedRoom", "Shared Room", 0, SharedRoomBus::maxRooms, 0,
+        juce::String(),
+        [](int value, int) { return value == 0 ? juce::String("Off") : "Room " + juce::String(value); }));
+    
+    // Return: this instance renders the room's late reverb on its own track,
+    // typically an aux; a room without a return has no shared reverb
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "roomRole", "Room Role",
+        juce::StringArray { "Source", "Return" }, 0));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "roomSend", "Room Send",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.25f,
+        juce::String(), juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(value * 100.0f, 1) + "%"; }));
+    
+    // Multi-object positions (used when the input is a discrete N-channel bus)
+    for (int i = 1; i <= MultiObjectRenderer::maxObjects; ++i)
+    {
+        const juce::String index (i);
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "objDistance" + index, "Object " + index + " Distance",
+            juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.1f,
+            juce::String(), juce::AudioProcessorParameter::genericParameter,
+            [](float value, int) { return juce::String(value * 100.0f, 1) + "%"; }));
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "objAzimuth" + index, "Object " + index + " Azimuth",
+            juce::NormalisableRange<float>(0.0f, 360.0f, 1.0f), 0.0f,
+            juce::String(), juce::AudioProcessorParameter::genericParameter,
+            [](float value, int) { return juce::String(int(std::round(value))) + juce::String("°"); }));
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "objHeight" + index, "Object " + index + " Height",
+            juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.5f,
+            juce::String(), juce::AudioProcessorParameter::genericParameter,
+            [](float value, int) { return juce::String(value * 100.0f, 1) + "%"; }));
+    }
+    
     return layout;
 }
 
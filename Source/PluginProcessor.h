@@ -2,13 +2,19 @@
 
 #include <JuceHeader.h>
 #include "DistanceProcessor.h"
+#include "MultiObjectRenderer.h"
+#include "SharedRoomBus.h"
+#include "AudioCommandQueue.h"
+#include <array>
 
 //==============================================================================
 /**
     SOFAR - Spatial Distance Effect Plugin Processor
     High-performance, crash-proof, thread-safe implementation
 */
-class SOFARAudioProcessor  : public juce::AudioProcessor
+class SOFARAudioProcessor  : public juce::AudioProcessor,
+                             private juce::AsyncUpdater,
+                             private juce::Timer
 {
 public:
     //==============================================================================
@@ -24,6 +30,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -55,6 +63,22 @@ public:
     
     // Plugin state queries
     bool isPluginInitialized() const;
+    
+    // Multi-object mode is active when the main input is a discrete N-channel bus
+    bool isMultiObjectMode() const;
+    int getNumObjects() const;
+    
+    // Speaker output is active when the main output is 5.1, 7.1 or 7.1.4
+    bool isSpeakerOutput() const;
+    
+    // Stage timings of the single-source chain, for the editor's overlay
+    StageProfiler& getStageProfiler() { return distanceProcessor.getStageProfiler(); }
+    
+    // Flight recorder of the same chain, armed and exported from the editor
+    TraceRecorder& getTraceRecorder() { return traceRecorder; }
+    
+    // Blocks whose shared-room send was dropped because the room's return fell behind
+    int getDroppedRoomSends() const { return sharedRoom.getDroppedSends(); }
 
     //==============================================================================
     // Public parameter access for UI
@@ -63,13 +87,84 @@ public:
 private:
     // Parameter layout creation
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    
+    // Room-bounded distance range for a source at the given azimuth
+    static float computeEffectiveMaxDistance(float azimuthDeg, float roomLength, float roomWidth);
+    
+    // Room length and width as rendered: stretched to the extent in Long
+    // Range mode and never past the range that has been applied
+    void getRenderedRoomSize(float& roomLength, float& roomWidth);
+    
+    void updateObjectRendererParameters();
+    void processObjects(juce::AudioBuffer<float>& buffer);
+    void processSpeakerSource(juce::AudioBuffer<float>& buffer);
+    void processSharedRoom(juce::AudioBuffer<float>& buffer);
+    
+    // Delay interpolation and aligned mode; returns the latency they require
+    int applyDelaySettings();
+    
+    // Shared-room membership and latency changes run on the message thread;
+    // the audio thread only raises hostUpdatePending, which the timer polls
+    void joinSharedRoom();
+    void handleAsyncUpdate() override;
+    void timerCallback() override;
+    
+    // Audio thread, or prepareToPlay: applies the queued non-parameter state
+    void applyPendingCommands();
+    
+    // Message thread only: the command queue's single producer
+    void pushRoomType(int roomType);
     //==============================================================================
+    // Audio-thread errors, formatted and logged from the message thread;
+    // declared first so it outlives everything that reports to it
+    AudioThreadLog audioThreadLog;
+    TraceRecorder traceRecorder;
+    
     // Core audio processing
     DistanceProcessor distanceProcessor;
+    MultiObjectRenderer objectRenderer;
+    
+    // Multi-object state (cached parameter pointers avoid per-block string lookups)
+    int numObjects = 0;
+    bool speakerOutput = false;
+    std::array<std::atomic<float>*, MultiObjectRenderer::maxObjects> objectDistanceParams {};
+    std::array<std::atomic<float>*, MultiObjectRenderer::maxObjects> objectAzimuthParams {};
+    std::array<std::atomic<float>*, MultiObjectRenderer::maxObjects> objectHeightParams {};
+    
+    // Shared room: direct path stays local, late reverb runs once per room
+    SharedRoomBus::Member sharedRoom;
+    std::atomic<float>* sharedRoomParam = nullptr;
+    std::atomic<float>* roomSendParam = nullptr;
+    std::atomic<float>* roomRoleParam = nullptr;
+    std::atomic<int> requestedRoomId { 0 };         // last room ID handed to the message thread
+    std::atomic<bool> requestedRoomReturn { false };
+    std::atomic<bool> hostUpdatePending { false };  // audio thread -> timerCallback
+    
+    // Long range resizes the delay memory, so it is applied on the message thread
+    std::atomic<float>* rangeModeParam = nullptr;
+    std::atomic<float>* rangeExtentParam = nullptr;
+    
+    // Double-precision hosts are rendered through the float chain, one
+    // prepared block at a time. The bridge is resized in place per chunk,
+    // so its prepared size is kept apart
+    juce::AudioBuffer<float> doublePrecisionBridge;
+    int doublePrecisionChannels = 0;
+    int doublePrecisionBlockSize = 0;
+    
+    // Aligned delay mode: the audio thread requests, the message thread reports
+    std::atomic<int> requiredLatency { 0 };
+    std::atomic<int> reportedLatency { 0 };
+    
+    // Non-parameter state changes from the message thread, applied at block start
+    AudioCommandQueue commandQueue;
+    DistanceProcessor::Environment activeEnvironment = DistanceProcessor::Room; // audio thread
+    std::atomic<int> pendingRoomType { -1 };        // set off the message thread, pushed from it
+    std::atomic<bool> processingBlock { false };    // prepareToPlay only consumes the queue while clear
     
-    // Plugin state
-    int currentRoomType;
-    bool isInitialized;
+    // Plugin state; the room type is what was last requested, for saving
+    // and the UI, and reaches the DSP through the command queue
+    std::atomic<int> currentRoomType;
+    std::atomic<bool> isInitialized;
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SOFARAudioProcessor)
@@ -0,0 +1,407 @@
+#include "PropagationDelay.h"
+#include <cmath>
+#include <cstring>
+
+//==============================================================================
+PropagationDelay::PropagationDelay()
+{
+    // Blackman-windowed sinc, one row per fractional phase plus a closing row
+    // so the phase interpolation never reads past the table
+    sincTable.resize ((size_t) (sincPhases + 1) * sincTaps);
+    const float halfSpan = static_cast<float> (sincTaps / 2);
+
+    for (int row = 0; row <= sincPhases; ++row)
+    {
+        const float t = static_cast<float> (row) / static_cast<float> (sincPhases);
+        float* coeffs = sincTable.data() + (size_t) row * sincTaps;
+        float sum = 0.0f;
+
+        for (int j = 0; j < sincTaps; ++j)
+        {
+            const float offset = static_cast<float> (j - (sincTaps / 2 - 1)) - t;
+            const float x = juce::MathConstants<float>::pi * offset;
+            const float sinc = std::abs (offset) < 1.0e-6f ? 1.0f : std::sin (x) / x;
+            const float w = offset / halfSpan;
+            const float window = 0.42f + 0.5f * std::cos (juce::MathConstants<float>::pi * w)
+                                       + 0.08f * std::cos (juce::MathConstants<float>::twoPi * w);
+            coeffs[j] = sinc * window;
+            sum += coeffs[j];
+        }
+
+        // Unity DC gain at every phase
+        for (int j = 0; j < sincTaps; ++j)
+            coeffs[j] /= sum;
+    }
+}
+
+void PropagationDelay::prepare (double sampleRate, int samplesPerBlock, int numChannels,
+                                double maxDelaySeconds, double maxSpreadSeconds)
+{
+    maxBlockSize = juce::jmax (1, samplesPerBlock);
+    maxDelay = juce::jmax (sincTaps, static_cast<int> (std::ceil (sampleRate * maxDelaySeconds)));
+    maxSpread = juce::jmax (0, static_cast<int> (std::ceil (sampleRate * maxSpreadSeconds)));
+
+    // Oldest tap of the first sample to newest write of the last one must fit;
+    // a reflection may sit on top of an ear offset, hence two spreads
+    const int historySize = maxDelay + 2 * maxSpread + maxBlockSize + sincTaps + 2;
+    const int pagesNeeded = (historySize + pageSize - 1) / pageSize;
+    const int channelsNeeded = juce::jlimit (1, maxChannels, numChannels);
+
+    // Only reallocate when the configured range actually changed. All pages
+    // share one cache-line-aligned block; the stride keeps every page aligned
+    if (pagesNeeded != numPages || channelsNeeded != numRingChannels)
+    {
+        numPages = pagesNeeded;
+        numRingChannels = channelsNeeded;
+        historyStorage.malloc ((size_t) (numPages * numRingChannels) * pageStride + cacheLineFloats);
+        history = juce::snapPointerToAlignment (historyStorage.get(), (size_t) cacheLineFloats * sizeof (float));
+
+        samplesSinceClear = numPages * pageSize;
+    }
+
+    ringSize = numPages * pageSize;
+    reset();
+}
+
+void PropagationDelay::reset()
+{
+    // Writing starts at the head of the ring after a reset, so only the pages
+    // written since then hold signal, plus the last page's guard, which
+    // mirrors the head. Hosts re-preparing a large session clear kilobytes
+    // rather than the whole history
+    const int dirtyPages = juce::jmin (numPages, (samplesSinceClear + pageSize - 1) / pageSize);
+
+    for (int channel = 0; channel < numRingChannels; ++channel)
+    {
+        for (int page = 0; page < dirtyPages; ++page)
+            juce::FloatVectorOperations::clear (pageAt (channel, page << pageShift), pageStride);
+
+        if (numPages > 0)
+            juce::FloatVectorOperations::clear (pageAt (channel, (numPages - 1) << pageShift) + pageSize, guardSize);
+    }
+
+    samplesSinceClear = 0;
+    writePos = 0;
+    thiranState.fill (0.0f);
+    currentOffset = targetOffset;
+    setDelayImmediate (targetDelay);
+}
+
+//==============================================================================
+void PropagationDelay::setInterpolation (Interpolation newInterpolation) noexcept
+{
+    if (interpolation == newInterpolation)
+        return;
+
+    interpolation = newInterpolation;
+    thiranState.fill (0.0f);
+
+    // Each interpolator needs a different number of future taps
+    currentDelay = juce::jmax (currentDelay, getMinimumDelay());
+    targetDelay  = juce::jmax (targetDelay,  getMinimumDelay());
+}
+
+float PropagationDelay::getMinimumDelay() const noexcept
+{
+    switch (interpolation)
+    {
+        case Thiran:       return 1.0f;
+        case WindowedSinc: return static_cast<float> (sincTaps / 2);
+        case Lagrange3:
+        default:           return 2.0f;
+    }
+}
+
+void PropagationDelay::setDelay (float delaySamples) noexcept
+{
+    targetDelay = juce::jlimit (getMinimumDelay(), static_cast<float> (juce::jmax (2, maxDelay)), delaySamples);
+}
+
+void PropagationDelay::setDelayImmediate (float delaySamples) noexcept
+{
+    setDelay (delaySamples);
+    currentDelay = targetDelay;
+}
+
+void PropagationDelay::setEarOffsets (float leftSamples, float rightSamples) noexcept
+{
+    const float limit = static_cast<float> (maxSpread);
+    targetOffset[0] = juce::jlimit (0.0f, limit, leftSamples);
+    targetOffset[1] = juce::jlimit (0.0f, limit, rightSamples);
+}
+
+void PropagationDelay::setReflections (const float* delaysSamples, const float* gains, int numTaps) noexcept
+{
+    numReflectionTaps = juce::jlimit (0, maxReflections, numTaps);
+
+    for (int i = 0; i < numReflectionTaps; ++i)
+    {
+        reflectionDelays[(size_t) i] = juce::jlimit (0.0f, static_cast<float> (maxSpread), delaysSamples[i]);
+        reflectionGains[(size_t) i]  = gains[i];
+    }
+}
+
+float PropagationDelay::slew (float current, float target, int numSamples) const noexcept
+{
+    const float maxChange = maxSlewRate * static_cast<float> (numSamples);
+    const float change = target - current;
+    return std::abs (change) <= maxChange ? target : current + std::copysign (maxChange, change);
+}
+
+//==============================================================================
+void PropagationDelay::process (juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept
+{
+    const int channels = juce::jmin (numChannels, buffer.getNumChannels(), numRingChannels);
+
+    if (ringSize == 0 || channels <= 0)
+        return;
+
+    // Oversized host blocks are split so the ring never overflows
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const int chunk = juce::jmin (maxBlockSize, numSamples - start);
+
+        // Linear ramp over the chunk = constant source speed = correct Doppler
+        const float endDelay = slew (currentDelay, targetDelay, chunk);
+
+        for (int ch = 0; ch < channels; ++ch)
+            writeBlock (ch, buffer.getReadPointer (ch, start), chunk);
+
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            // Each ear reads at the common delay plus its own offset
+            const float endOffset = slew (currentOffset[(size_t) ch], targetOffset[(size_t) ch], chunk);
+            const float startEarDelay = currentDelay + currentOffset[(size_t) ch];
+            const float delayStep = (endDelay + endOffset - startEarDelay) / static_cast<float> (chunk);
+            float* output = buffer.getWritePointer (ch, start);
+
+            if (delayStep == 0.0f)
+                readStatic (ch, output, chunk, startEarDelay);
+            else
+                readRamped (ch, output, chunk, startEarDelay, delayStep);
+
+            if (numReflectionTaps > 0)
+                addReflections (ch, output, chunk, startEarDelay, delayStep);
+
+            currentOffset[(size_t) ch] = endOffset;
+        }
+
+        writePos = wrap (writePos + chunk);
+        samplesSinceClear = juce::jmin (ringSize, samplesSinceClear + chunk);
+        currentDelay = endDelay;
+    }
+}
+
+void PropagationDelay::bypass (const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept
+{
+    const int channels = juce::jmin (numChannels, buffer.getNumChannels(), numRingChannels);
+
+    if (ringSize == 0 || channels <= 0)
+        return;
+
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const int chunk = juce::jmin (maxBlockSize, numSamples - start);
+
+        for (int ch = 0; ch < channels; ++ch)
+            writeBlock (ch, buffer.getReadPointer (ch, start), chunk);
+
+        writePos = wrap (writePos + chunk);
+        samplesSinceClear = juce::jmin (ringSize, samplesSinceClear + chunk);
+    }
+
+    setDelayImmediate (0.0f);
+    currentOffset.fill (0.0f);
+    targetOffset.fill (0.0f);
+}
+
+void PropagationDelay::writeBlock (int channel, const float* input, int numSamples) noexcept
+{
+    int position = writePos;
+
+    while (numSamples > 0)
+    {
+        const int offset = position & pageMask;
+        const int count = juce::jmin (numSamples, pageSize - offset);
+        float* page = pageAt (channel, position - offset);
+
+        std::memcpy (page + offset, input, sizeof (float) * (size_t) count);
+
+        // A write into a page's head is mirrored into the previous page's
+        // guard, so tap reads that run off a page never need to wrap
+        if (offset < guardSize)
+            std::memcpy (pageAt (channel, wrap (position - offset - pageSize)) + pageSize, page, sizeof (float) * (size_t) guardSize);
+
+        input += count;
+        numSamples -= count;
+        position = wrap (position + count);
+    }
+}
+
+void PropagationDelay::readBlock (int channel, int position, float* output, int numSamples) const noexcept
+{
+    while (numSamples > 0)
+    {
+        const int count = juce::jmin (numSamples, pageSize - (position & pageMask));
+
+        std::memcpy (output, pageAt (channel, position), sizeof (float) * (size_t) count);
+
+        output += count;
+        numSamples -= count;
+        position = wrap (position + count);
+    }
+}
+
+//==============================================================================
+void PropagationDelay::readStatic (int channel, float* output, int numSamples, float delay) noexcept
+{
+    const int wholeDelay = static_cast<int> (std::ceil (delay));
+    const float t = static_cast<float> (wholeDelay) - delay;
+
+    // Fast path: an integer delay is a straight block copy
+    if (t == 0.0f)
+    {
+        readBlock (channel, wrap (writePos - wholeDelay), output, numSamples);
+
+        if (channel < maxChannels)
+            thiranState[(size_t) channel] = output[numSamples - 1];
+
+        return;
+    }
+
+    // Fractional but static: one set of coefficients for the whole block
+    if (interpolation == Thiran)
+    {
+        const int m = static_cast<int> (std::floor (delay - 0.5f));
+        const float d = delay - static_cast<float> (m);
+        const float a = (1.0f - d) / (1.0f + d);
+        float y1 = thiranState[(size_t) channel];
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            const float* taps = pageAt (channel, wrap (writePos + n - m - 1));
+            y1 = a * (taps[1] - y1) + taps[0];
+            output[n] = y1;
+        }
+
+        thiranState[(size_t) channel] = y1;
+        return;
+    }
+
+    const bool sinc = interpolation == WindowedSinc;
+    const int numTaps = sinc ? sincTaps : 4;
+    const int leftTaps = sinc ? sincTaps / 2 - 1 : 1;
+
+    alignas (16) float coeffs[sincTaps];
+    if (sinc)
+        sincCoefficients (t, coeffs);
+    else
+        lagrangeCoefficients (t, coeffs);
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const float* taps = pageAt (channel, wrap (writePos + n - wholeDelay - leftTaps));
+        float sum = 0.0f;
+
+        for (int j = 0; j < numTaps; ++j)
+            sum += taps[j] * coeffs[j];
+
+        output[n] = sum;
+    }
+}
+
+void PropagationDelay::readRamped (int channel, float* output, int numSamples, float startDelay, float delayStep) noexcept
+{
+    if (interpolation == Thiran)
+    {
+        float y1 = thiranState[(size_t) channel];
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            const float delay = startDelay + delayStep * static_cast<float> (n + 1);
+            const int m = static_cast<int> (std::floor (delay - 0.5f));
+            const float d = delay - static_cast<float> (m);
+            const float a = (1.0f - d) / (1.0f + d);
+
+            const float* taps = pageAt (channel, wrap (writePos + n - m - 1));
+            y1 = a * (taps[1] - y1) + taps[0];
+            output[n] = y1;
+        }
+
+        thiranState[(size_t) channel] = y1;
+        return;
+    }
+
+    const bool sinc = interpolation == WindowedSinc;
+    const int numTaps = sinc ? sincTaps : 4;
+    const int leftTaps = sinc ? sincTaps / 2 - 1 : 1;
+    alignas (16) float coeffs[sincTaps];
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const float delay = startDelay + delayStep * static_cast<float> (n + 1);
+        const int wholeDelay = static_cast<int> (std::ceil (delay));
+        const float t = static_cast<float> (wholeDelay) - delay;
+
+        if (sinc)
+            sincCoefficients (t, coeffs);
+        else
+            lagrangeCoefficients (t, coeffs);
+
+        const float* taps = pageAt (channel, wrap (writePos + n - wholeDelay - leftTaps));
+        float sum = 0.0f;
+
+        for (int j = 0; j < numTaps; ++j)
+            sum += taps[j] * coeffs[j];
+
+        output[n] = sum;
+    }
+}
+
+void PropagationDelay::addReflections (int channel, float* output, int numSamples, float startDelay, float delayStep) const noexcept
+{
+    // Reflections are diffuse enough for linear interpolation
+    for (int i = 0; i < numReflectionTaps; ++i)
+    {
+        const float gain = reflectionGains[(size_t) i];
+        const float tapDelay = startDelay + reflectionDelays[(size_t) i];
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            const float delay = tapDelay + delayStep * static_cast<float> (n + 1);
+            const int wholeDelay = static_cast<int> (delay);
+            const float frac = delay - static_cast<float> (wholeDelay);
+            const float* taps = pageAt (channel, wrap (writePos + n - wholeDelay - 1));
+
+            output[n] += gain * (taps[1] + frac * (taps[0] - taps[1]));
+        }
+    }
+}
+
+//==============================================================================
+void PropagationDelay::lagrangeCoefficients (float t, float* coeffs) noexcept
+{
+    // Taps x[k-1], x[k], x[k+1], x[k+2] around the read position k + t
+    const float tm1 = t - 1.0f;
+    const float tm2 = t - 2.0f;
+    const float tp1 = t + 1.0f;
+
+    coeffs[0] = -t * tm1 * tm2 * (1.0f / 6.0f);
+    coeffs[1] = tp1 * tm1 * tm2 * 0.5f;
+    coeffs[2] = -tp1 * t * tm2 * 0.5f;
+    coeffs[3] = tp1 * t * tm1 * (1.0f / 6.0f);
+}
+
+void PropagationDelay::sincCoefficients (float t, float* coeffs) const noexcept
+{
+    const float phase = t * static_cast<float> (sincPhases);
+    const int row = juce::jlimit (0, sincPhases - 1, static_cast<int> (phase));
+    const float frac = phase - static_cast<float> (row);
+
+    const float* a = sincTable.data() + (size_t) row * sincTaps;
+    const float* b = a + sincTaps;
+
+    // Contiguous rows of fixed length: the compiler vectorises this blend
+    for (int j = 0; j < sincTaps; ++j)
+        coeffs[j] = a[j] + frac * (b[j] - a[j]);
+}
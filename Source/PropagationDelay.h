@@ -0,0 +1,146 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+    Per-ear propagation delay line
+    One ring buffer per ear, read at a fractional delay of distance / c plus
+    that ear's interaural offset (ITD), so distance delay and ITD come from a
+    single write and read and always stay sample-consistent. Early
+    reflections are extra taps on the same history, offset from each ear's
+    direct read, which replaces a separate reflection buffer copy.
+    The delay ramps linearly across each block from the previous target to
+    the new one, which is exactly the Doppler shift of a source moving at
+    constant speed over that block; the ramp rate is capped so a sudden
+    jump never exceeds a set source speed. A static integer delay is a
+    plain block copy, and a static fractional delay reuses one set of
+    interpolation coefficients for the whole block.
+    The history is a paged ring: fixed-size pages in one block allocated at
+    prepare() for the configured maximum delay only, so a short room never
+    pays for long-range memory. Each page carries a guard that mirrors the head of
+    the next page, so every interpolator reads its taps contiguously from
+    a single page, however far back the delay reaches.
+*/
+class PropagationDelay
+{
+public:
+    //==============================================================================
+    enum Interpolation
+    {
+        Lagrange3 = 0,  // 4-point third-order Lagrange FIR
+        Thiran,         // first-order allpass, flat magnitude
+        WindowedSinc    // 16-tap Blackman-windowed sinc from a phase table
+    };
+
+    static constexpr int maxChannels = 2;
+    static constexpr int maxReflections = 8;
+    static constexpr int sincTaps = 16;
+    static constexpr int sincPhases = 256;
+    static constexpr int pageShift = 12;
+    static constexpr int pageSize = 1 << pageShift; // samples per page and channel
+
+    PropagationDelay();
+    ~PropagationDelay() = default;
+
+    /** maxSpreadSeconds bounds both the ear offsets and the reflection taps. */
+    void prepare (double sampleRate, int samplesPerBlock, int numChannels,
+                  double maxDelaySeconds, double maxSpreadSeconds = 0.0);
+    void reset();
+
+    void setInterpolation (Interpolation newInterpolation) noexcept;
+    Interpolation getInterpolation() const noexcept { return interpolation; }
+
+    /** Largest delay change per sample, i.e. source speed as a fraction of c. */
+    void setMaxSlewRate (float samplesPerSample) noexcept { maxSlewRate = juce::jmax (0.0f, samplesPerSample); }
+
+    /** Target delay in samples, reached by the end of the next processed block. */
+    void setDelay (float delaySamples) noexcept;
+
+    /** Jumps straight to the given delay with no Doppler ramp. */
+    void setDelayImmediate (float delaySamples) noexcept;
+
+    /** Extra per-ear delay in samples (ITD), ramped like the main delay. */
+    void setEarOffsets (float leftSamples, float rightSamples) noexcept;
+
+    /** Reflection taps relative to each ear's direct read; pass 0 taps to disable. */
+    void setReflections (const float* delaysSamples, const float* gains, int numTaps) noexcept;
+
+    float getCurrentDelay() const noexcept { return currentDelay; }
+    float getMinimumDelay() const noexcept;
+    float getMaximumDelay() const noexcept { return static_cast<float> (maxDelay); }
+    size_t getAllocatedBytes() const noexcept { return (size_t) (numPages * numRingChannels) * pageStride * sizeof (float); }
+
+    /** Delays the first numChannels channels of the buffer in place. */
+    void process (juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept;
+
+    /** Writes the block into the history without reading it back, for a caller
+        that renders it undelayed: the delay and ear offsets jump to their
+        minimum, so a later process() carries on from what was actually heard. */
+    void bypass (const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    void writeBlock (int channel, const float* input, int numSamples) noexcept;
+    void readBlock (int channel, int position, float* output, int numSamples) const noexcept;
+    void readStatic (int channel, float* output, int numSamples, float delay) noexcept;
+    void readRamped (int channel, float* output, int numSamples, float startDelay, float delayStep) noexcept;
+    void addReflections (int channel, float* output, int numSamples, float startDelay, float delayStep) const noexcept;
+    float slew (float current, float target, int numSamples) const noexcept;
+
+    static void lagrangeCoefficients (float t, float* coeffs) noexcept;
+    void sincCoefficients (float t, float* coeffs) const noexcept;
+
+    //==============================================================================
+    static constexpr int guardSize = sincTaps;
+    static constexpr int pageMask = pageSize - 1;
+    static constexpr int cacheLineFloats = 16;
+    static constexpr size_t pageStride = pageSize + guardSize; // a whole number of cache lines
+
+    // Ring positions stay within one ring length of the valid range
+    int wrap (int position) const noexcept
+    {
+        return position < 0 ? position + ringSize : (position >= ringSize ? position - ringSize : position);
+    }
+
+    const float* pageAt (int channel, int position) const noexcept
+    {
+        return history + (size_t) (channel * numPages + (position >> pageShift)) * pageStride + (position & pageMask);
+    }
+
+    float* pageAt (int channel, int position) noexcept
+    {
+        return history + (size_t) (channel * numPages + (position >> pageShift)) * pageStride + (position & pageMask);
+    }
+
+    Interpolation interpolation = Lagrange3;
+
+    int numRingChannels = 0;
+    int numPages = 0;
+    int ringSize = 0;                  // numPages * pageSize
+    int writePos = 0;
+    int samplesSinceClear = 0;         // bounds what reset() has to clear
+    int maxBlockSize = 512;
+    int maxDelay = 0;
+    int maxSpread = 0;
+    juce::HeapBlock<float> historyStorage;
+    float* history = nullptr;          // channel-major pages, pageSize + guardSize samples each
+
+    float currentDelay = 0.0f;
+    float targetDelay = 0.0f;
+    float maxSlewRate = 0.5f;
+
+    std::array<float, maxChannels> currentOffset {};
+    std::array<float, maxChannels> targetOffset {};
+
+    std::array<float, maxReflections> reflectionDelays {};
+    std::array<float, maxReflections> reflectionGains {};
+    int numReflectionTaps = 0;
+
+    std::array<float, maxChannels> thiranState {}; // previous allpass output
+    std::vector<float> sincTable;                  // (sincPhases + 1) rows of sincTaps
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PropagationDelay)
+};
@@ -0,0 +1,140 @@
+#include "RoomModel.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+RoomModel::RoomModel (const Inputs& roomInputs)
+    : inputs (roomInputs)
+{
+    // Width sets the diffusion and the base reverb level
+    const float widthFactor = juce::jlimit (0.5f, 1.5f, inputs.width / 6.0f);
+    diffusion   = juce::jlimit (0.1f, 1.0f, widthFactor);
+    reverbLevel = juce::jlimit (0.05f, 0.5f, widthFactor * 0.2f);
+
+    // Height sets the size and the decay; taller rooms ring longer
+    const float heightFactor = juce::jlimit (0.5f, 3.0f, inputs.height / 3.0f);
+    roomSize    = juce::jlimit (0.5f, 2.0f, heightFactor);
+    decayTime   = juce::jlimit (0.5f, maxDecayTime, heightFactor * 2.5f);
+    reverbLevel = juce::jmax (reverbLevel, juce::jlimit (0.0f, 0.6f, (heightFactor - 0.5f) * 0.1f));
+
+    // Longer rooms are bigger and build up more late energy
+    const float lengthFactor = juce::jlimit (0.5f, 3.0f, inputs.length / 10.0f);
+    roomSize   *= juce::jlimit (0.7f, 1.5f, lengthFactor);
+    reverbLevel = juce::jmax (reverbLevel, juce::jlimit (0.1f, 0.6f, lengthFactor * 0.1f));
+
+    // Warm air damps less
+    const float temperatureNorm = juce::jlimit (-1.0f, 1.0f, inputs.temperature / 50.0f); // -1..+1 for -50..50 degrees
+    damping = juce::jlimit (0.2f, 0.8f, 0.7f - temperatureNorm * 0.2f);
+
+    const float maxDimension = juce::jmax (inputs.width, inputs.length, inputs.height);
+    preDelayMs = juce::jlimit (1.0f, 100.0f, maxDimension * 2.9f);
+
+    EarlyReflectionIR::getReflections (inputs.width, inputs.height, inputs.length, reflectionDelays, reflectionGains);
+
+    // Freeverb's room size is a feedback amount: map RT60 0.2..8 s onto it logarithmically
+    const float decayNorm = juce::jlimit (0.0f, 1.0f, std::log (juce::jmax (0.2f, decayTime) / 0.2f) / std::log (40.0f));
+
+    lateReverb.roomSize = juce::jmap (decayNorm, 0.3f, 0.98f);
+    lateReverb.damping  = juce::jlimit (0.0f, 1.0f, damping);
+    lateReverb.width    = juce::jlimit (0.0f, 1.0f, diffusion);
+    lateReverb.wetLevel = 0.33f;
+    lateReverb.dryLevel = 0.0f;
+}
+
+//==============================================================================
+RoomModelStore::~RoomModelStore()
+{
+    for (auto* model : retired)
+        delete model;
+
+    delete current.load();
+}
+
+void RoomModelStore::publish (std::unique_ptr<RoomModel> model)
+{
+    if (auto* previous = current.exchange (model.release()))
+        retired.push_back (previous);
+
+    // A snapshot the audio thread announced before the swap stays until it moves on;
+    // one it loaded but had not announced yet is never used, since it checks again
+    auto* inUse = reading.load();
+
+    retired.erase (std::remove_if (retired.begin(), retired.end(), [inUse] (RoomModel* retiredModel)
+                                   {
+                                       if (retiredModel == inUse)
+                                           return false;
+
+                                       delete retiredModel;
+                                       return true;
+                                   }),
+                   retired.end());
+}
+
+const RoomModel& RoomModelStore::acquire() noexcept
+{
+    auto* model = current.load (std::memory_order_acquire);
+    jassert (model != nullptr);
+
+    if (model != held)
+    {
+        // Announce it, then make sure it was not replaced, and so possibly reclaimed, meanwhile
+        for (;;)
+        {
+            reading.store (model);
+            auto* latest = current.load();
+
+            if (latest == model)
+                break;
+
+            model = latest;
+        }
+
+        held = model;
+    }
+
+    return *model;
+}
+
+//==============================================================================
+void RoomModelStore::request (const RoomModel::Inputs& inputs) noexcept
+{
+    const auto sequence = requestSequence.load (std::memory_order_relaxed);
+    requestSequence.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    requestWidth.store (inputs.width, std::memory_order_relaxed);
+    requestHeight.store (inputs.height, std::memory_order_relaxed);
+    requestLength.store (inputs.length, std::memory_order_relaxed);
+    requestMaxDistance.store (inputs.maxDistance, std::memory_order_relaxed);
+    requestAirAbsorption.store (inputs.airAbsorption, std::memory_order_relaxed);
+    requestTemperature.store (inputs.temperature, std::memory_order_relaxed);
+
+    requestSequence.store (sequence + 2, std::memory_order_release);
+}
+
+RoomModel::Inputs RoomModelStore::getRequest() const noexcept
+{
+    for (;;)
+    {
+        const auto before = requestSequence.load (std::memory_order_acquire);
+
+        if ((before & 1) != 0)
+        {
+            juce::Thread::yield();
+            continue;
+        }
+
+        RoomModel::Inputs inputs;
+        inputs.width         = requestWidth.load (std::memory_order_relaxed);
+        inputs.height        = requestHeight.load (std::memory_order_relaxed);
+        inputs.length        = requestLength.load (std::memory_order_relaxed);
+        inputs.maxDistance   = requestMaxDistance.load (std::memory_order_relaxed);
+        inputs.airAbsorption = requestAirAbsorption.load (std::memory_order_relaxed);
+        inputs.temperature   = requestTemperature.load (std::memory_order_relaxed);
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (requestSequence.load (std::memory_order_relaxed) == before)
+            return inputs;
+    }
+}
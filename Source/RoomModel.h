@@ -0,0 +1,104 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "EarlyReflectionIR.h"
+
+//==============================================================================
+/**
+    Immutable snapshot of the room the renderer places sources in
+    Everything derived from the room parameters - reverb decay, damping,
+    diffusion and pre-delay, the late reverb settings and the first-order
+    wall reflections - is computed once per change of the inputs, off the
+    audio thread, and never modified after it has been published.
+*/
+struct RoomModel
+{
+    struct Inputs
+    {
+        float width = 6.0f, height = 3.0f, length = 8.0f;   // metres
+        float maxDistance = 20.0f;
+        float airAbsorption = 0.5f;
+        float temperature = 20.0f;                          // degrees Celsius
+
+        auto tie() const { return std::tie (width, height, length, maxDistance, airAbsorption, temperature); }
+
+        bool operator== (const Inputs& other) const { return tie() == other.tie(); }
+        bool operator!= (const Inputs& other) const { return tie() != other.tie(); }
+    };
+
+    static constexpr float maxDecayTime = 6.0f;
+
+    explicit RoomModel (const Inputs& roomInputs);
+
+    Inputs inputs;
+
+    float roomSize = 1.0f;       // size factor
+    float decayTime = 1.0f;      // RT60, seconds
+    float damping = 0.5f;
+    float reverbLevel = 0.0f;
+    float diffusion = 1.0f;
+    float preDelayMs = 0.0f;
+
+    // Seconds after the direct sound, and gains
+    std::array<float, EarlyReflectionIR::numReflections> reflectionDelays {};
+    std::array<float, EarlyReflectionIR::numReflections> reflectionGains {};
+
+    juce::Reverb::Parameters lateReverb;
+
+    JUCE_LEAK_DETECTOR (RoomModel)
+};
+
+//==============================================================================
+/**
+    Hands RoomModel snapshots from a publishing thread to the audio thread
+    The current snapshot sits behind an atomic pointer. The audio thread
+    acquires it at the start of a block - one load while nothing changed -
+    and announces the snapshot it holds through a second pointer, so the
+    publisher can reclaim every snapshot the audio thread has moved past,
+    RCU style, without the audio thread ever freeing, waiting or locking.
+    The room inputs travel the other way through a sequence lock, written
+    by the audio thread only.
+*/
+class RoomModelStore
+{
+public:
+    //==============================================================================
+    RoomModelStore() = default;
+    ~RoomModelStore();
+
+    //==============================================================================
+    // Publishing thread, one at a time
+
+    /** Makes the model current; snapshots no longer in use are deleted here. */
+    void publish (std::unique_ptr<RoomModel> model);
+
+    /** The inputs last requested by the audio thread. */
+    RoomModel::Inputs getRequest() const noexcept;
+
+    //==============================================================================
+    // Audio thread
+
+    /** The current snapshot, valid until the next call. One has to have been published. */
+    const RoomModel& acquire() noexcept;
+
+    /** Wait-free; readers retry while it is in progress. */
+    void request (const RoomModel::Inputs& inputs) noexcept;
+
+private:
+    //==============================================================================
+    std::atomic<RoomModel*> current { nullptr };
+    std::atomic<RoomModel*> reading { nullptr };    // the snapshot the audio thread holds
+    RoomModel* held = nullptr;                      // audio thread only
+    std::vector<RoomModel*> retired;                // publishing thread only
+
+    std::atomic<juce::uint32> requestSequence { 0 }; // odd while the audio thread writes
+    std::atomic<float> requestWidth { 6.0f }, requestHeight { 3.0f }, requestLength { 8.0f };
+    std::atomic<float> requestMaxDistance { 20.0f }, requestAirAbsorption { 0.5f }, requestTemperature { 20.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RoomModelStore)
+};
@@ -0,0 +1,287 @@
+#include "SharedRoomBus.h"
+#include <algorithm>
+
+namespace
+{
+    // Each slot buffers a few host blocks so members on other audio threads
+    // can run ahead of or behind the owner without dropping sends
+    constexpr int slotBlocks = 4;
+}
+
+//==============================================================================
+class SharedRoomBus::Room
+{
+public:
+    struct Slot
+    {
+        bool used = false;                   // message thread, under roomsLock
+        bool isReturn = false;               // message thread, under roomsLock
+        std::atomic<bool> active { false };  // producer may push, owner may read
+        std::atomic<bool> reading { false }; // owner is mixing this slot
+        juce::AbstractFifo fifo { 1 };
+        juce::AudioBuffer<float> ring;
+    };
+
+    Room (double rate, int samplesPerBlock)
+        : sampleRate (rate), chunkSize (juce::jmax (1, samplesPerBlock))
+    {
+        sendMix.setSize (2, chunkSize);
+        reverb.setSampleRate (sampleRate);
+
+        appliedParameters.dryLevel = 0.0f;
+        reverb.setParameters (appliedParameters);
+    }
+
+    //==============================================================================
+    bool push (int slotIndex, const juce::AudioBuffer<float>& buffer, int numSamples, float sendLevel) noexcept
+    {
+        auto& slot = slots[(size_t) slotIndex];
+
+        // The owner has stalled (bypassed, not scheduled): drop rather than wait
+        if (slot.fifo.getFreeSpace() < numSamples)
+            return false;
+
+        const int right = buffer.getNumChannels() > 1 ? 1 : 0;
+        const auto scope = slot.fifo.write (numSamples);
+
+        if (scope.blockSize1 > 0)
+        {
+            slot.ring.copyFrom (0, scope.startIndex1, buffer.getReadPointer (0),     scope.blockSize1, sendLevel);
+            slot.ring.copyFrom (1, scope.startIndex1, buffer.getReadPointer (right), scope.blockSize1, sendLevel);
+        }
+
+        if (scope.blockSize2 > 0)
+        {
+            slot.ring.copyFrom (0, scope.startIndex2, buffer.getReadPointer (0,     scope.blockSize1), scope.blockSize2, sendLevel);
+            slot.ring.copyFrom (1, scope.startIndex2, buffer.getReadPointer (right, scope.blockSize1), scope.blockSize2, sendLevel);
+        }
+
+        return true;
+    }
+
+    void render (juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+    {
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int chunk = juce::jmin (chunkSize, numSamples - start);
+            sendMix.clear (0, chunk);
+
+            for (auto& slot : slots)
+            {
+                // Paired with releaseSlot(): a slot is never torn down mid-read
+                slot.reading.store (true);
+
+                if (slot.active.load())
+                    mixSlot (slot, chunk);
+
+                slot.reading.store (false);
+            }
+
+            auto* wetL = sendMix.getWritePointer (0);
+            auto* wetR = sendMix.getWritePointer (1);
+            reverb.processStereo (wetL, wetR, chunk);
+
+            if (buffer.getNumChannels() > 1)
+            {
+                buffer.addFrom (0, start, wetL, chunk);
+                buffer.addFrom (1, start, wetR, chunk);
+            }
+            else
+            {
+                buffer.addFrom (0, start, wetL, chunk, 0.5f);
+                buffer.addFrom (0, start, wetR, chunk, 0.5f);
+            }
+        }
+    }
+
+    void setReverbParameters (const juce::Reverb::Parameters& newParameters) noexcept
+    {
+        if (newParameters.roomSize == appliedParameters.roomSize
+            && newParameters.damping == appliedParameters.damping
+            && newParameters.wetLevel == appliedParameters.wetLevel
+            && newParameters.width == appliedParameters.width)
+            return;
+
+        appliedParameters = newParameters;
+        appliedParameters.dryLevel = 0.0f;
+        reverb.setParameters (appliedParameters);
+    }
+
+    //==============================================================================
+    const double sampleRate;
+    const int chunkSize;
+    int numMembers = 0;
+
+    std::array<Slot, maxMembers> slots;
+    std::atomic<int> ownerSlot { -1 };
+
+private:
+    void mixSlot (Slot& slot, int chunk) noexcept
+    {
+        // Keep a lagging member's extra latency bounded to half its FIFO
+        const int maxBacklog = juce::jmax (chunk, slot.fifo.getTotalSize() / 2);
+        const int ready = slot.fifo.getNumReady();
+
+        if (ready > maxBacklog)
+            slot.fifo.finishedRead (ready - maxBacklog);
+
+        // Not processed yet this cycle: its block is mixed on the next one
+        if (ready < chunk)
+            return;
+
+        const auto scope = slot.fifo.read (chunk);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (scope.blockSize1 > 0)
+                sendMix.addFrom (ch, 0, slot.ring, ch, scope.startIndex1, scope.blockSize1);
+
+            if (scope.blockSize2 > 0)
+                sendMix.addFrom (ch, scope.blockSize1, slot.ring, ch, scope.startIndex2, scope.blockSize2);
+        }
+    }
+
+    juce::Reverb reverb;
+    juce::Reverb::Parameters appliedParameters;
+    juce::AudioBuffer<float> sendMix;
+
+    JUCE_DECLARE_NON_COPYABLE (Room)
+};
+
+//==============================================================================
+SharedRoomBus::SharedRoomBus() = default;
+
+SharedRoomBus::~SharedRoomBus()
+{
+    // Every member must have left before the bus goes away
+    jassert (std::all_of (rooms.begin(), rooms.end(), [] (const auto& room) { return room == nullptr; }));
+}
+
+SharedRoomBus::Room* SharedRoomBus::acquireSlot (int roomId, bool asReturn, double sampleRate, int samplesPerBlock, int& slotIndex)
+{
+    const juce::ScopedLock sl (roomsLock);
+    auto& room = rooms[(size_t) (roomId - 1)];
+
+    if (room == nullptr)
+        room = std::make_unique<Room> (sampleRate, samplesPerBlock);
+    else if (room->sampleRate != sampleRate)
+        return nullptr;
+
+    for (int i = 0; i < maxMembers; ++i)
+    {
+        auto& slot = room->slots[(size_t) i];
+
+        if (slot.used)
+            continue;
+
+        // The owner skips inactive slots, so the FIFO can be rebuilt freely
+        const int ringSize = slotBlocks * juce::jmax (samplesPerBlock, room->chunkSize) + 1;
+        slot.ring.setSize (2, ringSize);
+        slot.ring.clear();
+        slot.fifo.setTotalSize (ringSize);
+        slot.fifo.reset();
+        slot.used = true;
+        slot.isReturn = asReturn;
+        slot.active.store (true);
+
+        // Only a return renders the reverb; sources never take it over
+        if (asReturn && room->ownerSlot.load() < 0)
+            room->ownerSlot.store (i);
+
+        ++room->numMembers;
+        slotIndex = i;
+        return room.get();
+    }
+
+    if (room->numMembers == 0)
+        room.reset();
+
+    return nullptr;
+}
+
+void SharedRoomBus::releaseSlot (int roomId, int slotIndex)
+{
+    const juce::ScopedLock sl (roomsLock);
+    auto& room = rooms[(size_t) (roomId - 1)];
+    jassert (room != nullptr);
+
+    auto& slot = room->slots[(size_t) slotIndex];
+    slot.active.store (false);
+
+    while (slot.reading.load())
+        juce::Thread::sleep (1);
+
+    slot.used = false;
+    slot.isReturn = false;
+    --room->numMembers;
+
+    // Hand the reverb to a standby return; it carries on from the same state
+    if (room->ownerSlot.load() == slotIndex)
+    {
+        int nextOwner = -1;
+
+        for (int i = 0; i < maxMembers && nextOwner < 0; ++i)
+            if (room->slots[(size_t) i].used && room->slots[(size_t) i].isReturn)
+                nextOwner = i;
+
+        room->ownerSlot.store (nextOwner);
+    }
+
+    if (room->numMembers == 0)
+        room.reset();
+}
+
+//==============================================================================
+bool SharedRoomBus::Member::join (int newRoomId, bool asReturn, double sampleRate, int samplesPerBlock)
+{
+    leave();
+
+    if (newRoomId <= 0 || newRoomId > maxRooms)
+        return newRoomId == 0;
+
+    droppedSends.store (0, std::memory_order_relaxed);
+    room = bus->acquireSlot (newRoomId, asReturn, sampleRate, samplesPerBlock, slotIndex);
+    roomId = room != nullptr ? newRoomId : 0;
+    returnMember = room != nullptr && asReturn;
+    return room != nullptr;
+}
+
+void SharedRoomBus::Member::leave()
+{
+    if (room == nullptr)
+        return;
+
+    bus->releaseSlot (roomId, slotIndex);
+    room = nullptr;
+    roomId = 0;
+    slotIndex = -1;
+    returnMember = false;
+}
+
+bool SharedRoomBus::Member::isOwner() const noexcept
+{
+    return room != nullptr && room->ownerSlot.load (std::memory_order_relaxed) == slotIndex;
+}
+
+void SharedRoomBus::Member::setReverbParameters (const juce::Reverb::Parameters& newParameters) noexcept
+{
+    if (isOwner())
+        room->setReverbParameters (newParameters);
+}
+
+bool SharedRoomBus::Member::process (juce::AudioBuffer<float>& buffer, int numSamples, float sendLevel) noexcept
+{
+    if (room == nullptr || numSamples <= 0 || buffer.getNumChannels() <= 0)
+        return true;
+
+    const bool sent = room->push (slotIndex, buffer, numSamples, sendLevel);
+
+    if (! sent)
+        droppedSends.fetch_add (1, std::memory_order_relaxed);
+
+    // The return's own send is already queued, so it is always mixed this cycle
+    if (isOwner())
+        room->render (buffer, numSamples);
+
+    return sent;
+}
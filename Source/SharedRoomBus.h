@@ -0,0 +1,90 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/**
+    Cross-instance shared room ("one room, many sources")
+    Process-wide registry reached through juce::SharedResourcePointer.
+    Instances that select the same room ID join one Room: each keeps its own
+    direct path and early reflections, and pushes a stereo send into its
+    slot of the room's accumulation bus. The late reverb then runs once per
+    processing cycle on the room's return - the member that joined as one,
+    typically an instance on an aux track - and is added to that track only.
+    A room without a return renders no shared reverb; a second return stands
+    by and takes over if the first one leaves.
+    Every slot is a single-producer/single-consumer FIFO, so members on
+    different host audio threads never lock or wait for each other. The
+    owner mixes one block from every slot that has a full block ready;
+    a member that has not been processed yet this cycle is picked up on
+    the next one, which only delays its reverb send by one block.
+*/
+class SharedRoomBus
+{
+public:
+    //==============================================================================
+    static constexpr int maxRooms = 16;
+    static constexpr int maxMembers = 64;
+
+    class Room;
+
+    /** One instance's membership. Join and leave only while the owning
+        processor is not processing (prepare, release, or suspended). */
+    class Member
+    {
+    public:
+        Member() = default;
+        ~Member() { leave(); }
+
+        /** Joins room 1..maxRooms as a source or as a return; 0 leaves.
+            Returns false if the room is full or runs at a different sample
+            rate. Message thread. */
+        bool join (int roomId, bool asReturn, double sampleRate, int samplesPerBlock);
+        void leave();
+
+        int getRoomId() const noexcept  { return room != nullptr ? roomId : 0; }
+        bool isReturn() const noexcept  { return room != nullptr && returnMember; }
+
+        /** True for the return currently rendering the room's reverb. */
+        bool isOwner() const noexcept;
+
+        /** Owner only: late reverb settings for the whole room. Audio thread. */
+        void setReverbParameters (const juce::Reverb::Parameters& newParameters) noexcept;
+
+        /** Pushes the buffer, scaled by sendLevel, into the room; the owner
+            then renders the room's late reverb and adds it to the buffer.
+            Returns false if the send was dropped because the slot's FIFO
+            was full. Wait-free. Audio thread. */
+        bool process (juce::AudioBuffer<float>& buffer, int numSamples, float sendLevel) noexcept;
+
+        /** Blocks whose send was dropped since this member joined. Any thread. */
+        int getDroppedSends() const noexcept  { return droppedSends.load (std::memory_order_relaxed); }
+
+    private:
+        juce::SharedResourcePointer<SharedRoomBus> bus;
+        Room* room = nullptr;
+        int roomId = 0;
+        int slotIndex = -1;
+        bool returnMember = false;
+        std::atomic<int> droppedSends { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE (Member)
+    };
+
+    //==============================================================================
+    SharedRoomBus();
+    ~SharedRoomBus();
+
+private:
+    //==============================================================================
+    Room* acquireSlot (int roomId, bool asReturn, double sampleRate, int samplesPerBlock, int& slotIndex);
+    void releaseSlot (int roomId, int slotIndex);
+
+    juce::CriticalSection roomsLock;
+    std::array<std::unique_ptr<Room>, maxRooms> rooms;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedRoomBus)
+};
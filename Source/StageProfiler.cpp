@@ -0,0 +1,163 @@
+#include "StageProfiler.h"
+#include <cmath>
+
+//==============================================================================
+const char* StageProfiler::getStageName (Stage stage) noexcept
+{
+    switch (stage)
+    {
+        case Height:    return "Height";
+        case Gain:      return "Gain";
+        case Air:       return "Air";
+        case Width:     return "Width";
+        case Panning:   return "Panning/ILD";
+        case Delay:     return "Delay/ITD/ER";
+        case Hrtf:      return "HRTF";
+        case numStages:
+        default:        break;
+    }
+
+    return "";
+}
+
+double StageProfiler::getBucketLimitMicros (int bucket) noexcept
+{
+    return std::exp2 ((double) (bucket + 1) / (double) histogramBucketsPerOctave);
+}
+
+//==============================================================================
+void StageProfiler::beginBlock (int numSamples, double sampleRate) noexcept
+{
+    tracing = trace != nullptr && trace->beginBlock();
+    active = tracing || enabled.load (std::memory_order_relaxed);
+    tier = TraceRecorder::Live;
+
+    if (! active)
+        return;
+
+    if (worstResetRequested.exchange (false, std::memory_order_relaxed))
+    {
+        for (auto& counters : stages)
+            counters.worstTicks.store (0, std::memory_order_relaxed);
+
+        block.worstTicks.store (0, std::memory_order_relaxed);
+        overBudget.store (0, std::memory_order_relaxed);
+
+        for (auto& bucket : histogram)
+            bucket.store (0, std::memory_order_relaxed);
+    }
+
+    blockTicks.fill (0);
+    blockSamples = numSamples;
+    blockDeadlineTicks = sampleRate > 0.0 ? (juce::int64) ((double) numSamples / sampleRate
+                                                           * (double) juce::Time::getHighResolutionTicksPerSecond())
+                                          : 0;
+    blockBudgetTicks = (juce::int64) ((double) blockDeadlineTicks * (double) budgetPercent.load (std::memory_order_relaxed) / 100.0);
+    blockMicrosPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    blockStart = juce::Time::getHighResolutionTicks();
+}
+
+void StageProfiler::endBlock() noexcept
+{
+    if (! active)
+        return;
+
+    const auto blockEnd = juce::Time::getHighResolutionTicks();
+    const auto ticks = blockEnd - blockStart;
+    publish (block, ticks);
+
+    const auto micros = (double) ticks * blockMicrosPerTick;
+    const auto bucket = micros > 1.0 ? juce::jmin (numHistogramBuckets - 1, (int) (std::log2 (micros) * histogramBucketsPerOctave))
+                                     : 0;
+    histogram[(size_t) bucket].store (histogram[(size_t) bucket].load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (blockBudgetTicks > 0 && ticks > blockBudgetTicks)
+        overBudget.store (overBudget.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < stages.size(); ++i)
+        publish (stages[i], blockTicks[i]);
+
+    deadlineTicks.store (deadlineTicks.load (std::memory_order_relaxed) + blockDeadlineTicks, std::memory_order_relaxed);
+
+    // Released last, so a snapshot that sees this block also sees its times
+    blocks.store (blocks.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+    active = false;
+
+    if (tracing)
+    {
+        trace->addBlock (blockStart, blockEnd, blockSamples, tier);
+        trace->endBlock();
+        tracing = false;
+    }
+}
+
+void StageProfiler::publish (Counters& counters, juce::int64 ticks) noexcept
+{
+    counters.totalTicks.store (counters.totalTicks.load (std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+
+    if (ticks > counters.worstTicks.load (std::memory_order_relaxed))
+        counters.worstTicks.store (ticks, std::memory_order_relaxed);
+}
+
+//==============================================================================
+StageProfiler::Snapshot StageProfiler::takeSnapshot() noexcept
+{
+    Snapshot snapshot;
+
+    const auto totalBlocks = blocks.load (std::memory_order_acquire);
+    const auto newBlocks = totalBlocks - lastBlocks;
+    const auto totalDeadline = deadlineTicks.load (std::memory_order_relaxed);
+    const auto newDeadline = totalDeadline - lastDeadlineTicks;
+    const double microsPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+
+    const auto summarise = [&] (const Counters& counters, juce::int64& lastTicks,
+                                double& average, double& worst, double& percent)
+    {
+        const auto total = counters.totalTicks.load (std::memory_order_relaxed);
+        const auto ticks = total - lastTicks;
+        lastTicks = total;
+
+        average = newBlocks > 0 ? (double) ticks * microsPerTick / (double) newBlocks : 0.0;
+        worst = (double) counters.worstTicks.load (std::memory_order_relaxed) * microsPerTick;
+        percent = newDeadline > 0 ? 100.0 * (double) ticks / (double) newDeadline : 0.0;
+    };
+
+    for (size_t i = 0; i < stages.size(); ++i)
+        summarise (stages[i], lastStageTicks[i],
+                   snapshot.averageMicros[i], snapshot.worstMicros[i], snapshot.deadlinePercent[i]);
+
+    summarise (block, lastBlockTicks, snapshot.blockAverageMicros, snapshot.blockWorstMicros, snapshot.blockDeadlinePercent);
+
+    // Percentiles from one pass over a copy; a block landing mid-copy only shifts a count by one
+    std::array<juce::int64, numHistogramBuckets> counts;
+    juce::int64 counted = 0;
+
+    for (size_t i = 0; i < counts.size(); ++i)
+        counted += (counts[i] = histogram[i].load (std::memory_order_relaxed));
+
+    const auto percentile = [&] (double fraction)
+    {
+        const auto rank = (juce::int64) std::ceil (fraction * (double) counted);
+        juce::int64 seen = 0;
+
+        for (int i = 0; i < numHistogramBuckets; ++i)
+            if ((seen += counts[(size_t) i]) >= rank)
+                return getBucketLimitMicros (i);
+
+        return getBucketLimitMicros (numHistogramBuckets - 1);
+    };
+
+    if (counted > 0)
+    {
+        snapshot.blockP50Micros = percentile (0.5);
+        snapshot.blockP99Micros = percentile (0.99);
+        snapshot.blockP999Micros = percentile (0.999);
+    }
+
+    snapshot.histogramBlocks = counted;
+    snapshot.overBudgetBlocks = overBudget.load (std::memory_order_relaxed);
+    snapshot.blocks = newBlocks;
+    lastBlocks = totalBlocks;
+    lastDeadlineTicks = totalDeadline;
+    return snapshot;
+}
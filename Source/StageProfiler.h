@@ -0,0 +1,185 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "TraceRecorder.h"
+
+//==============================================================================
+/**
+    Per-stage audio-thread timing
+    The audio thread times each stage of a block with ScopedStage, sums the
+    stage times locally and publishes them once per block into one
+    cache-line-padded set of counters per stage. The audio thread is the
+    only writer, so publishing is plain relaxed loads and stores, no
+    read-modify-write. A reader on the message thread takes snapshots,
+    which average over the blocks since its previous snapshot.
+    While disabled, a block costs one relaxed load and every ScopedStage
+    one predictable branch; no clock is read.
+    Whole-block times also go into a log-spaced histogram, four buckets per
+    octave from 1 us, which gives the tail percentiles that averages hide,
+    and are checked against a budget given as a share of the block's
+    deadline. Both accumulate until the next resetWorstCase().
+    An attached TraceRecorder receives the same timings as trace events,
+    plus each block's size and tier and the parameter changes, whenever
+    it is armed - independently of the counters being enabled.
+*/
+class StageProfiler
+{
+public:
+    //==============================================================================
+    enum Stage
+    {
+        Height = 0,
+        Gain,
+        Air,
+        Width,
+        Panning,     // front/back image, head shadow and ILD
+        Delay,       // propagation delay, ITD and early reflections
+        Hrtf,
+        numStages
+    };
+
+    static constexpr int numHistogramBuckets = 64;     // 1 us to about 65 ms
+    static constexpr int histogramBucketsPerOctave = 4;
+
+    static const char* getStageName (Stage stage) noexcept;
+
+    /** Upper edge of a histogram bucket, in microseconds. */
+    static double getBucketLimitMicros (int bucket) noexcept;
+
+    StageProfiler() = default;
+    ~StageProfiler() = default;
+
+    void setEnabled (bool shouldBeEnabled) noexcept    { enabled.store (shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept                    { return enabled.load (std::memory_order_relaxed); }
+
+    /** Blocks taking longer than this share of their deadline count as over budget. */
+    void setBudgetPercent (float newPercent) noexcept  { budgetPercent.store (newPercent, std::memory_order_relaxed); }
+    float getBudgetPercent() const noexcept            { return budgetPercent.load (std::memory_order_relaxed); }
+
+    /** Set before processing starts; the recorder must outlive the profiler's use. */
+    void setTraceRecorder (TraceRecorder* recorder) noexcept { trace = recorder; }
+
+    //==============================================================================
+    // Audio thread
+
+    /** Latches the enabled flag and claims the trace, if armed, for this block. */
+    void beginBlock (int numSamples, double sampleRate) noexcept;
+
+    /** Publishes the stage times of the block begun last. */
+    void endBlock() noexcept;
+
+    /** True while the current block is being recorded into the trace. */
+    bool isTracing() const noexcept { return tracing; }
+
+    /** Rendering tier of the current block; the last call of a block wins. */
+    void noteTier (TraceRecorder::Tier newTier) noexcept { tier = newTier; }
+
+    void noteParameter (TraceRecorder::Parameter parameter, float value) noexcept
+    {
+        if (tracing)
+            trace->noteParameter (parameter, value);
+    }
+
+    class ScopedStage
+    {
+    public:
+        ScopedStage (StageProfiler& owner, Stage stageToTime) noexcept
+            : profiler (owner.active ? &owner : nullptr), stage (stageToTime)
+        {
+            if (profiler != nullptr)
+                start = juce::Time::getHighResolutionTicks();
+        }
+
+        ~ScopedStage() noexcept
+        {
+            if (profiler != nullptr)
+                profiler->endStage (stage, start);
+        }
+
+    private:
+        StageProfiler* profiler;
+        Stage stage;
+        juce::int64 start = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedStage)
+    };
+
+    //==============================================================================
+    // Message thread
+
+    struct Snapshot
+    {
+        std::array<double, numStages> averageMicros {};   // per block since the last snapshot
+        std::array<double, numStages> worstMicros {};     // since the last resetWorstCase()
+        std::array<double, numStages> deadlinePercent {}; // share of the audio time those blocks covered
+        double blockAverageMicros = 0.0;
+        double blockWorstMicros = 0.0;
+        double blockDeadlinePercent = 0.0;
+        juce::int64 blocks = 0;
+
+        // Whole blocks since the last resetWorstCase(); percentiles are bucket upper edges
+        double blockP50Micros = 0.0;
+        double blockP99Micros = 0.0;
+        double blockP999Micros = 0.0;
+        juce::int64 histogramBlocks = 0;
+        juce::int64 overBudgetBlocks = 0;
+    };
+
+    Snapshot takeSnapshot() noexcept;
+
+    /** Takes effect at the next block the audio thread profiles. */
+    void resetWorstCase() noexcept { worstResetRequested.store (true, std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    struct alignas (64) Counters
+    {
+        std::atomic<juce::int64> totalTicks { 0 };
+        std::atomic<juce::int64> worstTicks { 0 };
+    };
+
+    static void publish (Counters& counters, juce::int64 ticks) noexcept;
+
+    void endStage (Stage stage, juce::int64 start) noexcept
+    {
+        const auto end = juce::Time::getHighResolutionTicks();
+        blockTicks[(size_t) stage] += end - start;
+
+        if (tracing)
+            trace->addStage (stage, start, end);
+    }
+
+    std::atomic<bool> enabled { false };
+    std::atomic<bool> worstResetRequested { false };
+    std::atomic<float> budgetPercent { 70.0f };
+
+    // Audio thread only
+    bool active = false;
+    bool tracing = false;
+    TraceRecorder* trace = nullptr;
+    TraceRecorder::Tier tier = TraceRecorder::Live;
+    int blockSamples = 0;
+    std::array<juce::int64, numStages> blockTicks {};
+    juce::int64 blockStart = 0;
+    juce::int64 blockDeadlineTicks = 0;
+    juce::int64 blockBudgetTicks = 0;
+    double blockMicrosPerTick = 0.0;
+
+    // Written by the audio thread, read by the snapshot
+    std::array<Counters, numStages> stages;
+    Counters block;
+    alignas (64) std::atomic<juce::int64> blocks { 0 };
+    std::atomic<juce::int64> deadlineTicks { 0 };
+    std::atomic<juce::int64> overBudget { 0 };
+    alignas (64) std::array<std::atomic<juce::int64>, numHistogramBuckets> histogram {};
+
+    // Snapshot side only
+    std::array<juce::int64, numStages> lastStageTicks {};
+    juce::int64 lastBlockTicks = 0;
+    juce::int64 lastBlocks = 0;
+    juce::int64 lastDeadlineTicks = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StageProfiler)
+};
@@ -0,0 +1,190 @@
+#include "TraceRecorder.h"
+#include "StageProfiler.h"
+#include <limits>
+
+//==============================================================================
+TraceRecorder::TraceRecorder()
+{
+    lastParameters.fill (std::numeric_limits<float>::quiet_NaN());
+}
+
+//==============================================================================
+void TraceRecorder::arm() noexcept
+{
+    // A fresh capture: nothing reads or writes the ring while disarmed
+    if (state.load (std::memory_order_acquire) != Disarmed)
+        return;
+
+    if (events.empty())
+        events.resize ((size_t) capacity);
+
+    written = 0;
+    lastParameters.fill (std::numeric_limits<float>::quiet_NaN());
+    state.store (Armed, std::memory_order_release);
+}
+
+void TraceRecorder::disarm() noexcept
+{
+    for (;;)
+    {
+        int expected = Armed;
+
+        if (state.compare_exchange_weak (expected, Disarmed, std::memory_order_acq_rel)
+             || expected == Disarmed)
+            return;
+
+        // The audio thread is inside a block, which always finishes
+        juce::Thread::yield();
+    }
+}
+
+bool TraceRecorder::isArmed() const noexcept
+{
+    const auto current = state.load (std::memory_order_relaxed);
+    return current == Armed || current == InBlock;
+}
+
+//==============================================================================
+bool TraceRecorder::beginBlock() noexcept
+{
+    int expected = Armed;
+    return state.compare_exchange_strong (expected, InBlock, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void TraceRecorder::endBlock() noexcept
+{
+    state.store (Armed, std::memory_order_release);
+}
+
+void TraceRecorder::add (const Event& event) noexcept
+{
+    events[(size_t) (written & (juce::uint64) (capacity - 1))] = event;
+    ++written;
+}
+
+void TraceRecorder::addStage (int stage, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    add ({ startTicks, (juce::int32) (endTicks - startTicks), 0.0f, StageEvent, (juce::uint8) stage });
+}
+
+void TraceRecorder::addBlock (juce::int64 startTicks, juce::int64 endTicks, int numSamples, Tier tier) noexcept
+{
+    add ({ startTicks, (juce::int32) (endTicks - startTicks), (float) numSamples, BlockEvent, (juce::uint8) tier });
+}
+
+void TraceRecorder::noteParameter (Parameter parameter, float value) noexcept
+{
+    auto& last = lastParameters[(size_t) parameter];
+
+    if (value == last)
+        return;
+
+    last = value;
+    add ({ juce::Time::getHighResolutionTicks(), 0, value, ParameterEvent, (juce::uint8) parameter });
+}
+
+//==============================================================================
+bool TraceRecorder::exportJson (juce::OutputStream& output, int timeoutMs)
+{
+    // Claim the ring between two blocks
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax (0, timeoutMs);
+    int previous = Disarmed;
+
+    for (;;)
+    {
+        previous = state.load (std::memory_order_acquire);
+
+        if (previous != InBlock)
+        {
+            int expected = previous;
+
+            if (state.compare_exchange_strong (expected, Frozen, std::memory_order_acq_rel))
+                break;
+
+            continue;
+        }
+
+        if (juce::Time::getMillisecondCounter() > deadline)
+            return false;
+
+        juce::Thread::yield();
+    }
+
+    const auto count = (juce::uint64) juce::jmin ((juce::uint64) capacity, written);
+    const auto first = written - count;
+
+    juce::int64 origin = std::numeric_limits<juce::int64>::max();
+    for (auto i = first; i < written; ++i)
+        origin = juce::jmin (origin, events[(size_t) (i & (juce::uint64) (capacity - 1))].startTicks);
+
+    const double microsPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    const auto micros = [&] (juce::int64 ticks) { return juce::String ((double) ticks * microsPerTick, 3); };
+
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Audio thread\"}}";
+
+    for (auto i = first; i < written; ++i)
+    {
+        const auto& event = events[(size_t) (i & (juce::uint64) (capacity - 1))];
+        const auto ts = micros (event.startTicks - origin);
+
+        output << ",\n";
+
+        switch (event.kind)
+        {
+            case BlockEvent:
+                output << "{\"name\":\"Block\",\"cat\":\"block\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ts
+                       << ",\"dur\":" << micros (event.durationTicks)
+                       << ",\"args\":{\"samples\":" << (int) event.value
+                       << ",\"tier\":\"" << getTierName (event.code) << "\"}}";
+                break;
+
+            case StageEvent:
+                output << "{\"name\":\"" << StageProfiler::getStageName ((StageProfiler::Stage) event.code)
+                       << "\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ts
+                       << ",\"dur\":" << micros (event.durationTicks) << "}";
+                break;
+
+            case ParameterEvent:
+            default:
+                output << "{\"name\":\"" << getParameterName (event.code)
+                       << "\",\"cat\":\"parameter\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+                       << ",\"args\":{\"value\":" << juce::String (event.value, 4) << "}}";
+                break;
+        }
+    }
+
+    output << "\n]}\n";
+    output.flush();
+
+    state.store (previous, std::memory_order_release);
+    return true;
+}
+
+//==============================================================================
+const char* TraceRecorder::getTierName (int tier) noexcept
+{
+    switch (tier)
+    {
+        case Transparent:   return "Transparent";
+        case Live:          return "Live";
+        case HeavyLoad:     return "HeavyLoad";
+        default:            return "Unknown";
+    }
+}
+
+const char* TraceRecorder::getParameterName (int parameter) noexcept
+{
+    switch (parameter)
+    {
+        case Distance:      return "distance";
+        case Pan:           return "pan";
+        case Height:        return "height";
+        case RoomWidth:     return "roomWidth";
+        case RoomLength:    return "roomLength";
+        case RoomHeight:    return "roomHeight";
+        case AirAbsorption: return "airAbsorption";
+        case Temperature:   return "temperature";
+        default:            return "unknown";
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+    Flight recorder for the audio thread
+    A fixed ring of compact binary events - blocks with their size and
+    quality tier, stage timings and parameter changes - allocated on the
+    message thread the first time it is armed, so recording never allocates
+    on the audio thread and instances that are never traced, typically all
+    but one in a large session, carry no ring at all. While
+    armed the ring keeps overwriting its oldest events, so it can stay on
+    in a long session and hold the last half minute or so when a dropout
+    is noticed.
+    Export freezes the ring between two blocks, writes it as Chrome
+    trace-event JSON (chrome://tracing, Perfetto) and re-arms. The audio
+    thread claims each block with one compare-and-swap, so the message
+    thread never reads an event that is still being written.
+*/
+class TraceRecorder
+{
+public:
+    //==============================================================================
+    enum Tier
+    {
+        Transparent = 0,    // zero distance: panning only
+        Live,               // full live chain
+        HeavyLoad,          // simplified live chain for far sources
+        numTiers
+    };
+
+    enum Parameter
+    {
+        Distance = 0,
+        Pan,
+        Height,
+        RoomWidth,
+        RoomLength,
+        RoomHeight,
+        AirAbsorption,
+        Temperature,
+        numParameters
+    };
+
+    static constexpr int capacity = 1 << 16;    // about 1.5 MB once armed
+
+    TraceRecorder();
+    ~TraceRecorder() = default;
+
+    //==============================================================================
+    // Message thread
+    void arm() noexcept;
+    void disarm() noexcept;
+    bool isArmed() const noexcept;
+
+    /** Freezes the ring, writes what it holds as trace-event JSON and returns
+        to the previous state. Fails if the audio thread holds the ring for
+        longer than the timeout. */
+    bool exportJson (juce::OutputStream& output, int timeoutMs = 200);
+
+    //==============================================================================
+    // Audio thread, between beginBlock() returning true and endBlock()
+    bool beginBlock() noexcept;
+    void endBlock() noexcept;
+
+    void addStage (int stage, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+    void addBlock (juce::int64 startTicks, juce::int64 endTicks, int numSamples, Tier tier) noexcept;
+    void noteParameter (Parameter parameter, float value) noexcept;
+
+private:
+    //==============================================================================
+    enum Kind : juce::uint8 { BlockEvent, StageEvent, ParameterEvent };
+
+    enum State { Disarmed, Armed, InBlock, Frozen };
+
+    struct Event
+    {
+        juce::int64 startTicks;
+        juce::int32 durationTicks;  // blocks and stages
+        float value;                // samples of a block, new value of a parameter
+        Kind kind;
+        juce::uint8 code;           // stage, tier or parameter
+    };
+
+    void add (const Event& event) noexcept;
+
+    static const char* getTierName (int tier) noexcept;
+    static const char* getParameterName (int parameter) noexcept;
+
+    std::atomic<int> state { Disarmed };
+
+    std::vector<Event> events;      // capacity, allocated by the first arm()
+    juce::uint64 written = 0;       // total events ever added; the ring index is its low bits
+
+    // Last value recorded per parameter; NaN forces the next one through
+    std::array<float, numParameters> lastParameters {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TraceRecorder)
+};
@@ -0,0 +1,304 @@
+#include "VbapPanner.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Directions on the MDAP ring around the panning direction
+    constexpr int numSpreadDirections = 6;
+    constexpr float hullTolerance = 1.0e-4f;
+}
+
+//==============================================================================
+bool VbapPanner::isSupportedLayout (const juce::AudioChannelSet& layout)
+{
+    return layout == juce::AudioChannelSet::create5point1()
+        || layout == juce::AudioChannelSet::create7point1()
+        || layout == juce::AudioChannelSet::create7point1point4();
+}
+
+VbapPanner::Direction VbapPanner::toDirection (float azimuthDeg, float elevationDeg) noexcept
+{
+    // x = right, y = front, z = up; azimuth is clockwise as everywhere in SOFAR
+    const float az = juce::degreesToRadians (azimuthDeg);
+    const float el = juce::degreesToRadians (elevationDeg);
+    return { std::cos (el) * std::sin (az), std::cos (el) * std::cos (az), std::sin (el) };
+}
+
+bool VbapPanner::getSpeakerDirection (juce::AudioChannelSet::ChannelType type, float& azimuthDeg, float& elevationDeg) noexcept
+{
+    using CT = juce::AudioChannelSet::ChannelType;
+
+    elevationDeg = 0.0f;
+
+    switch (type)
+    {
+        case CT::left:              azimuthDeg =  -30.0f; return true;
+        case CT::right:             azimuthDeg =   30.0f; return true;
+        case CT::centre:            azimuthDeg =    0.0f; return true;
+        case CT::leftCentre:        azimuthDeg =  -15.0f; return true;
+        case CT::rightCentre:       azimuthDeg =   15.0f; return true;
+        case CT::wideLeft:          azimuthDeg =  -60.0f; return true;
+        case CT::wideRight:         azimuthDeg =   60.0f; return true;
+        case CT::leftSurroundSide:  azimuthDeg =  -90.0f; return true;
+        case CT::rightSurroundSide: azimuthDeg =   90.0f; return true;
+        case CT::leftSurround:      azimuthDeg = -110.0f; return true;
+        case CT::rightSurround:     azimuthDeg =  110.0f; return true;
+        case CT::leftSurroundRear:  azimuthDeg = -150.0f; return true;
+        case CT::rightSurroundRear: azimuthDeg =  150.0f; return true;
+        case CT::centreSurround:    azimuthDeg =  180.0f; return true;
+
+        case CT::topMiddle:         azimuthDeg =    0.0f; elevationDeg = 90.0f; return true;
+        case CT::topFrontLeft:      azimuthDeg =  -45.0f; elevationDeg = 45.0f; return true;
+        case CT::topFrontCentre:    azimuthDeg =    0.0f; elevationDeg = 45.0f; return true;
+        case CT::topFrontRight:     azimuthDeg =   45.0f; elevationDeg = 45.0f; return true;
+        case CT::topSideLeft:       azimuthDeg =  -90.0f; elevationDeg = 45.0f; return true;
+        case CT::topSideRight:      azimuthDeg =   90.0f; elevationDeg = 45.0f; return true;
+        case CT::topRearLeft:       azimuthDeg = -135.0f; elevationDeg = 45.0f; return true;
+        case CT::topRearCentre:     azimuthDeg =  180.0f; elevationDeg = 45.0f; return true;
+        case CT::topRearRight:      azimuthDeg =  135.0f; elevationDeg = 45.0f; return true;
+
+        default: break; // LFE, ambisonic and discrete channels are not panned to
+    }
+
+    return false;
+}
+
+//==============================================================================
+void VbapPanner::prepare (const juce::AudioChannelSet& layout)
+{
+    numOutputs = juce::jmin (layout.size(), maxOutputs);
+    mainSpeaker.fill (false);
+    speakers.clear();
+    triangles.clear();
+
+    for (int ch = 0; ch < numOutputs; ++ch)
+    {
+        float azimuthDeg = 0.0f, elevationDeg = 0.0f;
+
+        if (! getSpeakerDirection (layout.getTypeOfChannel (ch), azimuthDeg, elevationDeg))
+            continue;
+
+        Speaker speaker;
+        speaker.direction = toDirection (azimuthDeg, elevationDeg);
+        speaker.channel = ch;
+        speakers.push_back (speaker);
+        mainSpeaker[(size_t) ch] = true;
+    }
+
+    const int numMain = (int) speakers.size();
+    diffuseGain = numMain > 0 ? 1.0f / std::sqrt (static_cast<float> (numMain)) : 0.0f;
+
+    if (numMain == 0)
+        return;
+
+    // Virtual zenith/nadir speakers close the hull for layouts without height
+    // (and below the ear plane for all of them); their gain is handed to
+    // the real speakers around them.
+    Speaker top, bottom;
+    top.direction    = { 0.0f, 0.0f,  1.0f };
+    bottom.direction = { 0.0f, 0.0f, -1.0f };
+    speakers.push_back (top);
+    speakers.push_back (bottom);
+
+    triangulate();
+}
+
+void VbapPanner::triangulate()
+{
+    const int numSpeakers = (int) speakers.size();
+
+    // Brute-force convex hull: at most 16 + 2 points, run once at prepare
+    for (int i = 0; i < numSpeakers; ++i)
+    {
+        for (int j = i + 1; j < numSpeakers; ++j)
+        {
+            for (int k = j + 1; k < numSpeakers; ++k)
+            {
+                const auto& a = speakers[(size_t) i].direction;
+                const auto& b = speakers[(size_t) j].direction;
+                const auto& c = speakers[(size_t) k].direction;
+
+                const float abx = b.x - a.x, aby = b.y - a.y, abz = b.z - a.z;
+                const float acx = c.x - a.x, acy = c.y - a.y, acz = c.z - a.z;
+
+                float nx = aby * acz - abz * acy;
+                float ny = abz * acx - abx * acz;
+                float nz = abx * acy - aby * acx;
+                float d  = nx * a.x + ny * a.y + nz * a.z;
+
+                if (d < 0.0f) { nx = -nx; ny = -ny; nz = -nz; d = -d; }
+
+                // Skip degenerate triangles and planes through the listener
+                if (d < hullTolerance)
+                    continue;
+
+                bool isHullFace = true;
+                for (int m = 0; m < numSpeakers && isHullFace; ++m)
+                {
+                    const auto& p = speakers[(size_t) m].direction;
+                    if (nx * p.x + ny * p.y + nz * p.z > d + hullTolerance)
+                        isHullFace = false;
+                }
+
+                if (! isHullFace)
+                    continue;
+
+                // Inverse of the column matrix [a b c]
+                const float det = a.x * (b.y * c.z - c.y * b.z)
+                                - b.x * (a.y * c.z - c.y * a.z)
+                                + c.x * (a.y * b.z - b.y * a.z);
+
+                if (std::abs (det) < 1.0e-6f)
+                    continue;
+
+                const float invDet = 1.0f / det;
+                Triangle triangle;
+                triangle.speakers = { i, j, k };
+                triangle.inverse = { (b.y * c.z - c.y * b.z) * invDet, (b.z * c.x - c.z * b.x) * invDet, (b.x * c.y - c.x * b.y) * invDet,
+                                     (c.y * a.z - a.y * c.z) * invDet, (c.z * a.x - a.z * c.x) * invDet, (c.x * a.y - a.x * c.y) * invDet,
+                                     (a.y * b.z - b.y * a.z) * invDet, (a.z * b.x - b.z * a.x) * invDet, (a.x * b.y - b.x * a.y) * invDet };
+                triangles.push_back (triangle);
+
+                // Record which real speakers surround each virtual one
+                for (int v : triangle.speakers)
+                {
+                    auto& speaker = speakers[(size_t) v];
+                    if (speaker.channel >= 0)
+                        continue;
+
+                    for (int r : triangle.speakers)
+                        if (speakers[(size_t) r].channel >= 0
+                            && std::find (speaker.neighbours.begin(), speaker.neighbours.end(), r) == speaker.neighbours.end())
+                            speaker.neighbours.push_back (r);
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+void VbapPanner::computeGains (float azimuthDeg, float elevationDeg, float* gains) const noexcept
+{
+    std::fill (gains, gains + numOutputs, 0.0f);
+
+    if (triangles.empty())
+        return;
+
+    const auto centre = toDirection (azimuthDeg, elevationDeg);
+    accumulateGains (centre, gains);
+
+    if (spreadDeg > 0.0f)
+    {
+        // MDAP: average over a ring of directions around the source
+        const auto side = toDirection (azimuthDeg + 90.0f, 0.0f);
+        const Direction up { centre.y * side.z - centre.z * side.y,
+                             centre.z * side.x - centre.x * side.z,
+                             centre.x * side.y - centre.y * side.x };
+
+        const float cosSpread = std::cos (juce::degreesToRadians (spreadDeg));
+        const float sinSpread = std::sin (juce::degreesToRadians (spreadDeg));
+
+        for (int r = 0; r < numSpreadDirections; ++r)
+        {
+            const float angle = juce::MathConstants<float>::twoPi * static_cast<float> (r) / static_cast<float> (numSpreadDirections);
+            const float cs = std::cos (angle) * sinSpread;
+            const float sn = std::sin (angle) * sinSpread;
+
+            const Direction direction { centre.x * cosSpread + side.x * cs + up.x * sn,
+                                        centre.y * cosSpread + side.y * cs + up.y * sn,
+                                        centre.z * cosSpread + side.z * cs + up.z * sn };
+            accumulateGains (direction, gains);
+        }
+    }
+
+    float power = 0.0f;
+    for (int ch = 0; ch < numOutputs; ++ch)
+        power += gains[ch] * gains[ch];
+
+    if (power > 1.0e-12f)
+        juce::FloatVectorOperations::multiply (gains, 1.0f / std::sqrt (power), numOutputs);
+}
+
+void VbapPanner::accumulateGains (const Direction& p, float* gains) const noexcept
+{
+    const Triangle* best = nullptr;
+    std::array<float, 3> bestGains {};
+    float bestMinimum = -std::numeric_limits<float>::max();
+
+    for (const auto& triangle : triangles)
+    {
+        const auto& inv = triangle.inverse;
+        const std::array<float, 3> g { inv[0] * p.x + inv[1] * p.y + inv[2] * p.z,
+                                       inv[3] * p.x + inv[4] * p.y + inv[5] * p.z,
+                                       inv[6] * p.x + inv[7] * p.y + inv[8] * p.z };
+        const float minimum = juce::jmin (g[0], g[1], g[2]);
+
+        // The enclosing triangle has no negative gain; otherwise keep the closest
+        if (minimum > bestMinimum)
+        {
+            best = &triangle;
+            bestGains = g;
+            bestMinimum = minimum;
+
+            if (minimum >= -hullTolerance)
+                break;
+        }
+    }
+
+    if (best == nullptr)
+        return;
+
+    float power = 0.0f;
+    for (auto& g : bestGains)
+    {
+        g = juce::jmax (0.0f, g);
+        power += g * g;
+    }
+
+    if (power <= 1.0e-12f)
+        return;
+
+    const float norm = 1.0f / std::sqrt (power);
+
+    for (size_t v = 0; v < 3; ++v)
+    {
+        const auto& speaker = speakers[(size_t) best->speakers[v]];
+        const float g = bestGains[v] * norm;
+
+        if (speaker.channel >= 0)
+        {
+            gains[speaker.channel] += g;
+        }
+        else if (! speaker.neighbours.empty())
+        {
+            // Split the virtual speaker's energy evenly between its neighbours
+            const float share = g / std::sqrt (static_cast<float> (speaker.neighbours.size()));
+            for (int r : speaker.neighbours)
+                gains[speakers[(size_t) r].channel] += share;
+        }
+    }
+}
+
+//==============================================================================
+void VbapPanner::applyGains (const float* source, juce::AudioBuffer<float>& output,
+                             const float* startGains, const float* endGains,
+                             int numChannels, int numSamples) noexcept
+{
+    numChannels = juce::jmin (numChannels, output.getNumChannels());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float start = startGains[ch];
+        const float end   = endGains[ch];
+
+        if (start == 0.0f && end == 0.0f)
+            continue;
+
+        if (start == end)
+            juce::FloatVectorOperations::addWithMultiply (output.getWritePointer (ch), source, end, numSamples);
+        else
+            output.addFromWithRamp (ch, 0, source, numSamples, start, end);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+    Vector-base amplitude panning for loudspeaker layouts (5.1, 7.1, 7.1.4)
+    The speaker triangulation (convex hull of the speaker directions plus
+    virtual top/bottom speakers for layouts without height) and the inverse
+    base matrices are built once at prepare. Per-block work is only a search
+    over the precomputed triangles; an optional MDAP spread averages the gains
+    of a small ring of directions around the source.
+*/
+class VbapPanner
+{
+public:
+    //==============================================================================
+    static constexpr int maxOutputs = 16;
+
+    /** True for the speaker layouts this panner knows how to place. */
+    static bool isSupportedLayout (const juce::AudioChannelSet& layout);
+
+    VbapPanner() = default;
+    ~VbapPanner() = default;
+
+    /** Maps the layout's channel types to directions and triangulates them.
+        Allocates - call from prepareToPlay only. */
+    void prepare (const juce::AudioChannelSet& layout);
+
+    int getNumOutputs() const noexcept { return numOutputs; }
+
+    /** Power-normalised gains for a direction in SOFAR convention (azimuth
+        0° = front, 90° = right). 'gains' must hold getNumOutputs() values;
+        LFE and unknown channels always receive 0. */
+    void computeGains (float azimuthDeg, float elevationDeg, float* gains) const noexcept;
+
+    /** Equal-power gain for a diffuse (non-directional) signal per main speaker. */
+    float getDiffuseGain() const noexcept { return diffuseGain; }
+    bool isMainSpeaker (int channel) const noexcept { return juce::isPositiveAndBelow (channel, numOutputs) && mainSpeaker[(size_t) channel]; }
+
+    /** MDAP spread in degrees (0 = plain VBAP). */
+    void setSpread (float degrees) noexcept { spreadDeg = juce::jlimit (0.0f, 90.0f, degrees); }
+
+    /** Gain-matrix kernel: output[ch] += source * gain[ch], ramped from startGains
+        to endGains over the block. Channels with constant gain use a single
+        vectorised multiply-add; silent channels are skipped. */
+    static void applyGains (const float* source, juce::AudioBuffer<float>& output,
+                            const float* startGains, const float* endGains,
+                            int numChannels, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    struct Direction
+    {
+        float x = 0.0f, y = 1.0f, z = 0.0f;
+    };
+
+    struct Speaker
+    {
+        Direction direction;
+        int channel = -1;                // output channel, -1 for virtual speakers
+        std::vector<int> neighbours;     // real speakers sharing a triangle (virtual only)
+    };
+
+    struct Triangle
+    {
+        std::array<int, 3> speakers {};
+        std::array<float, 9> inverse {}; // row-major inverse of [s0 s1 s2]
+    };
+
+    static Direction toDirection (float azimuthDeg, float elevationDeg) noexcept;
+    static bool getSpeakerDirection (juce::AudioChannelSet::ChannelType type, float& azimuthDeg, float& elevationDeg) noexcept;
+
+    void triangulate();
+    void accumulateGains (const Direction& direction, float* gains) const noexcept;
+
+    //==============================================================================
+    int numOutputs = 0;
+    float spreadDeg = 0.0f;
+    float diffuseGain = 0.0f;
+
+    std::vector<Speaker>  speakers;
+    std::vector<Triangle> triangles;
+    std::array<bool, maxOutputs> mainSpeaker {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VbapPanner)
+};